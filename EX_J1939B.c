@@ -98,9 +98,10 @@ void tick_timer_isr(void)
 #define J1939_TICK_TYPE                TICK_TYPE
 
 #if defined(__PCM__)
-//Limit the number of J1939 Receive buffer to 4 because of limited resources
-//of PIC16F876A.
+//Limit the number of J1939 Receive buffer to 4 and remove the J1939 address
+//map because of limited resources of PIC16F876A.
 #define J1939_RECEIVE_BUFFERS 4
+#define J1939_ADDRESS_MAP_ENTRIES 0
 #endif
 
 //Include the J1939 driver
@@ -123,14 +124,14 @@ void InitJ1939Address(void)
 //Function used to initialize this unit's J1939 Name
 void InitJ1939Name(void)
 {
-   g_J1939Name[0] = 1;
-   g_J1939Name[1] = 0;
-   g_J1939Name[2] = 0;
-   g_J1939Name[3] = 0;
-   g_J1939Name[4] = 0;
-   g_J1939Name[5] = 0;
-   g_J1939Name[6] = 0;
-   g_J1939Name[7] = 128;
+   J1939_NAME_FIELDS Fields;
+   
+   memset(&Fields,0,sizeof(J1939_NAME_FIELDS));
+   
+   Fields.IdentityNumber = 1;
+   Fields.ArbitraryAddressCapable = TRUE;
+   
+   J1939BuildName(&Fields,g_J1939Name);
 } 
 
 //J1939 Task function for this example
@@ -0,0 +1,196 @@
+////////////////////////////////////////////////////////////////////////////////
+////                             EX_J1939HOST.c                             ////
+////                                                                        ////
+//// Example of CCS's J1939 driver built with GCC or Clang on a PC, using   ////
+//// the host CAN driver (can-host.c).  Lets the J1939 driver be run,       ////
+//// profiled and checked with perf, gdb and the sanitizers away from the   ////
+//// target.                                                                ////
+////                                                                        ////
+//// Like EX_J1939B.c this example sends a message once every 250 ms        ////
+//// commanding Node A to toggle it's LED.  With the loopback backend Node  ////
+//// A is a second loopback port in this program that prints what it       ////
+//// receives and answers Address Claim requests.  With the SocketCAN       ////
+//// backend the messages go out on a CAN interface.                        ////
+////                                                                        ////
+//// Loopback backend:                                                      ////
+////    g++ -x c++ -O2 -g EX_J1939HOST.c -o ex_j1939host                    ////
+////    ./ex_j1939host                                                      ////
+////                                                                        ////
+//// SocketCAN backend:                                                     ////
+////    g++ -x c++ -O2 -g -DCAN_HOST_SOCKETCAN=1 EX_J1939HOST.c             ////
+////        -o ex_j1939host                                                 ////
+////    ./ex_j1939host vcan0                                                ////
+////                                                                        ////
+//// Add -fsanitize=address,undefined to check the driver, clang++ works    ////
+//// the same way.  It must be compiled as C++ because the driver uses      ////
+//// reference parameters.                                                  ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "can-host.h"
+
+void InitJ1939Address(void);
+void InitJ1939Name(void);
+
+//////////////////////////////////////////////////////////////////////////////// Tick Timer
+
+#define TICKS_PER_SECOND 1000
+
+typedef uint32_t TICK_TYPE;
+
+TICK_TYPE GetTick(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC,&ts);
+
+   return((TICK_TYPE)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000));
+}
+
+TICK_TYPE GetTickDifference(TICK_TYPE current,TICK_TYPE previous)
+{
+   return(current - previous);
+}
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Settings
+
+//Following Macros used to initialize unit's J1939 Address and Name - Required
+#define J1939InitAddress()    InitJ1939Address()
+#define J1939InitName()       InitJ1939Name()
+
+//Following define selects the host CAN driver, can-host.c
+#define USE_HOST_CAN   TRUE
+
+//Following defines/macros used to associate your tick timer to J1939 tick timer
+// defines/macro's - Required
+#define J1939GetTick()                 GetTick()
+#define J1939GetTickDifference(a,b)    GetTickDifference(a,b)
+#define J1939_TICKS_PER_SECOND         TICKS_PER_SECOND
+#define J1939_TICK_TYPE                TICK_TYPE
+
+//Include the J1939 driver
+#include "j1939.c"
+
+//Defines for J1939 Commands used in this example
+#define LED_ON       50
+#define LED_OFF      51
+#define LED_TOGGLE   52
+
+//Define for other Node's J1939 address used in this example
+#define OTHER_NODE_ADDRESS    128
+
+//Function used to initialize this unit's J1939 Address
+void InitJ1939Address(void)
+{
+   g_MyJ1939Address = 129;
+}
+
+//Function used to initialize this unit's J1939 Name
+void InitJ1939Name(void)
+{
+   J1939_NAME_FIELDS Fields;
+
+   memset(&Fields,0,sizeof(J1939_NAME_FIELDS));
+
+   Fields.IdentityNumber = 1;
+   Fields.ArbitraryAddressCapable = TRUE;
+
+   J1939BuildName(&Fields,g_J1939Name);
+}
+
+//J1939 Task function for this example
+void J1939Task(void)
+{
+   uint8_t Data[8];
+   uint8_t Length;
+   J1939_PDU_STRUCT Message;
+
+   TICK_TYPE CurrentTick;
+   static TICK_TYPE PreviousTick;
+
+   CurrentTick = GetTick();
+
+   J1939ReceiveTask();  //J1939ReceiveTask() needs to be called often
+   J1939XmitTask();     //J1939XmitTask() needs to be called often
+
+   if(J1939Kbhit())  //Checks for new message in J1939 Receive buffer
+   {
+      J1939GetMessage(Message,Data,Length);  //Gets J1939 Message from receive buffer
+
+      printf("rx PF %u PS %u SA %u len %u\n",Message.PDUFormat,Message.DestinationAddress,Message.SourceAddress,Length);
+   }
+
+   if(GetTickDifference(CurrentTick,PreviousTick) >= (TICK_TYPE)TICKS_PER_SECOND/4)
+   {
+      //send message to other unit once every 250ms to toggle pin
+      Message.SourceAddress = g_MyJ1939Address;          //set PDU Source Address, this units address (g_MyJ1939Address)
+      Message.DestinationAddress = OTHER_NODE_ADDRESS;   //set PDU Destination Address, address of other unit
+      Message.PDUFormat = LED_TOGGLE;                    //set PDU Formate, LED_TOGGLE command
+      Message.DataPage = 0;                              //set PDU Data Page can be either 0 or 1, this message uses 0
+      Message.ExtendedDataPage = 0;                      //set PDU Extended Data Page, must be zero for J1939 Messages
+      Message.Priority = J1939_CONTROL_PRIORITY;         //set Priority, can be 0 to 7 (0 highest priority) Control default is 3
+
+      //Load PGN of Message (refer to J1939 documentation for correct format)
+      Data[0] = Message.SourceAddress;
+      Data[1] = Message.PDUFormat;
+      Data[2] = 0;
+
+      J1939PutMessage(Message,Data,3);    //loads J1939 Message into Xmit buffer
+
+      PreviousTick =  CurrentTick;
+   }
+}
+
+//Node A on the loopback bus, prints each frame it receives
+void NodeATask(can_host_loopback *Port)
+{
+   can_host_frame Frame;
+   uint8_t i;
+
+   while(can_host_loopback_get(Port,&Frame))
+   {
+      printf("Node A: %08X [%u]",Frame.id,Frame.len);
+      for(i=0;i<Frame.len;i++)
+         printf(" %02X",Frame.data[i]);
+      printf("\n");
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   static can_host_loopback Node, NodeA;
+  #if CAN_HOST_SOCKETCAN == TRUE
+   static can_host_socketcan Socket;
+
+   if(argc > 1)
+   {
+      Socket.interface = argv[1];
+      can_host_set_ops(&can_host_socketcan_ops,&Socket);
+   }
+   else
+  #endif
+   {
+     #if CAN_HOST_SOCKETCAN != TRUE
+      (void)argc;    //only used to pick a SocketCAN interface
+      (void)argv;
+     #endif
+      can_host_loopback_connect(&Node,&NodeA);
+      can_host_set_ops(&can_host_loopback_ops,&Node);
+   }
+
+   J1939Init();  //Initialize J1939 Driver must be called before any other J1939 function is used
+
+   while(TRUE)
+   {
+      J1939Task();
+      NodeATask(&NodeA);
+      usleep(1000);
+   }
+
+   return(0);
+}
@@ -0,0 +1,421 @@
+////////////////////////////////////////////////////////////////////////////////
+////                             EX_J1939_SPN.c                             ////
+////                                                                        ////
+//// PGN and SPN decoders used by EX_J1939.c.  Kept apart from the example  ////
+//// so the host benchmark (j1939-bench.cpp) can time the same decoders.    ////
+////                                                                        ////
+//// Each signal is a row of g_SpnTable[], decoded by one bit field         ////
+//// extractor, SpnRaw(), and scaled in fixed point by SpnScale().  The     ////
+//// table is generated from EX_J1939_SPN.csv by j1939-gen.cpp:             ////
+////    ./j1939-gen -o EX_J1939_SPN_TABLE.h EX_J1939_SPN.csv                ////
+////                                                                        ////
+//// Needs the CCS int8 and int16 types, j1939-bench.cpp defines them for   ////
+//// the host.                                                              ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__SSE2__)
+#include <emmintrin.h>          //host build, SpnFrameFlags()
+#endif
+
+//#####################################    IMPLEMENTACIN DE LAS FUNCIONES PARA SPN Y PGN     ###########################################
+//PGN_ y SPN_, SPN_SLOT_ y g_SpnTable[] estan en EX_J1939_SPN_TABLE.h
+
+// TABLA DE SPN
+
+//Set to TRUE to keep each row's float resolution and offset and add
+//SpnDecodeFloat(), the float decoder the fixed point one is checked against
+//on the host (j1939-bench.cpp -verify).  Leave FALSE on the PIC so the float
+//library isn't linked.
+#ifndef SPN_KEEP_FLOAT
+#define SPN_KEEP_FLOAT     FALSE
+#endif
+
+//SPN descriptor, one row of g_SpnTable[] per signal.  Bits are numbered from
+//bit 0 of data byte 0 and fields longer than a byte are little endian, the
+//way J1939-71 sends them.  Decoded value = raw * resolution + offset, Min and
+//Max are the operational range from J1939-71 in the same units.  A value
+//older than Timeout ticks is stale, SPN_ROW() sets it to 3 times the rate the
+//PGN is sent at.
+//
+//The scaling is fixed point, value = (raw - OffsetRaw) * Mult / 2^Shift, with
+//Mult and OffsetRaw worked out from the resolution and offset by SPN_ROW().
+typedef struct _SPN_STRUCT {
+   uint16_t PGN;
+   uint16_t SPN;
+   uint8_t  StartBit;         //first (least significant) bit, 0 to 63
+   uint8_t  Length;           //bits, 1 to 32, 32 bit fields must start on a byte
+   uint16_t Mult;             //resolution * 2^Shift, rounded up
+   uint8_t  Shift;            //0 to 47
+   uint32_t OffsetRaw;        //-offset / resolution, in raw counts
+   int16_t  Min;
+   int16_t  Max;
+   uint16_t Timeout;          //ticks
+   uint8_t  TopByte;          //data byte holding the field's top 8 bits, SPN_TOP_NONE if it has none
+  #if SPN_KEEP_FLOAT == TRUE
+   float    Resolution;       //units per bit
+   float    Offset;           //units
+  #endif
+} SPN_STRUCT;
+
+//Compile time scaling factors.  The offset must be 0 or negative and a whole
+//number of resolutions, as J1939-71 offsets are.  Choose the shift as the
+//largest that keeps resolution * 2^shift at or below 65535, or for a power of
+//2 resolution the smallest that makes it a whole number.
+//
+//Values are raw * resolution + offset truncated toward zero, the same as
+//casting the float result.  For fields up to 16 bits this matches the float
+//code for every raw value.  Fields over 16 bits keep a looser rule, because
+//the multiplier is rounded up: a value is 1 further from zero when it is
+//within (Mult / 2^Shift - resolution) * 2^Length of the next whole number.
+//For latitude and longitude, 0.0000001 deg/bit, that is 0.0033 deg.  A float
+//holds only 24 bits of the raw value, so the float code doesn't do better.
+//j1939-bench.cpp -verify checks every row keeps to its rule.
+#define SPN_POW2(s)                 ((float)((uint32_t)1 << ((s) / 2)) * (float)((uint32_t)1 << ((s) - (s) / 2)))
+#define SPN_MULT(res,s)             ((uint16_t)((res) * SPN_POW2(s)) + (((res) * SPN_POW2(s)) > (uint16_t)((res) * SPN_POW2(s))))
+#define SPN_OFFSET_RAW(res,offset)  ((uint32_t)(-(offset) / (res) + 0.5))
+#define SPN_TIMEOUT(rate)           ((uint16_t)((uint32_t)(rate) * 3 * J1939_TICKS_PER_SECOND / 1000))
+
+//Fields of 8 bits or more ending on a byte have their top 8 bits in one data
+//byte, their status comes from SpnFrameFlags().  Others use SpnClassify().
+#define SPN_TOP_NONE                0xFF
+#define SPN_TOP_BYTE(bit,len)       ((((len) >= 8) && ((((bit) + (len)) & 7) == 0)) ? (((bit) + (len)) / 8 - 1) : SPN_TOP_NONE)
+
+#if SPN_KEEP_FLOAT == TRUE
+ #define SPN_ROW(pgn,spn,bit,len,res,s,offset,min,max,rate)   {pgn,spn,bit,len,SPN_MULT(res,s),s,SPN_OFFSET_RAW(res,offset),min,max,SPN_TIMEOUT(rate),SPN_TOP_BYTE(bit,len),res,offset}
+#else
+ #define SPN_ROW(pgn,spn,bit,len,res,s,offset,min,max,rate)   {pgn,spn,bit,len,SPN_MULT(res,s),s,SPN_OFFSET_RAW(res,offset),min,max,SPN_TIMEOUT(rate),SPN_TOP_BYTE(bit,len)}
+#endif
+
+#define SPN_NOT_FOUND         0xFF
+
+//Generated by j1939-gen.cpp from EX_J1939_SPN.csv, a new signal is one more
+//line of the CSV.  Rows are sorted by PGN, SpnDecodePGN() and SpnStorePGN()
+//rely on it.
+#include "EX_J1939_SPN_TABLE.h"
+
+#define SPN_TABLE_ENTRIES     (sizeof(g_SpnTable) / sizeof(SPN_STRUCT))
+
+//Returns the first g_SpnTable[] row of a PGN, or SPN_NOT_FOUND.  One lookup
+//in the generated perfect hash, whatever the size of the table.
+uint8_t SpnFindPGN(uint16_t pgn)
+{
+   uint8_t i;
+   
+   i = g_SpnPgnHash[SPN_PGN_HASH(pgn)];
+   
+   if((i != SPN_NOT_FOUND) && (g_SpnTable[i].PGN == pgn))
+      return(i);
+      
+   return(SPN_NOT_FOUND);
+}
+
+//Returns the g_SpnTable[] row of a PGN's SPN, or SPN_NOT_FOUND
+uint8_t SpnFind(uint16_t pgn, uint16_t spn)
+{
+   uint8_t i;
+   
+   i = SpnFindPGN(pgn);
+   
+   if(i != SPN_NOT_FOUND)
+   {
+      for(;(i < SPN_TABLE_ENTRIES) && (g_SpnTable[i].PGN == pgn);i++)
+      {
+         if(g_SpnTable[i].SPN == spn)
+            return(i);
+      }
+   }
+   
+   return(SPN_NOT_FOUND);
+}
+
+//Returns the raw value of a Length bit field starting at StartBit
+uint32_t SpnRaw(uint8_t Bytes[], uint8_t StartBit, uint8_t Length)
+{
+   uint32_t Raw = 0;
+   uint8_t First, Count;
+   
+   First = StartBit >> 3;
+   Count = ((StartBit & 7) + Length + 7) >> 3;     //bytes the field touches
+   
+   while(Count)
+   {
+      Count--;
+      Raw = (Raw << 8) | Bytes[First + Count];
+   }
+   
+   Raw >>= (StartBit & 7);
+   
+   if(Length < 32)
+      Raw &= ((uint32_t)1 << Length) - 1;
+      
+   return(Raw);
+}
+
+//Returns Raw * Mult / 2^Shift rounded down.  Raw is multiplied 16 bits at a
+//time so nothing overflows, for Raw up to 32 bits and Shift up to 47.
+uint32_t SpnScale(uint32_t Raw, uint16_t Mult, uint8_t Shift)
+{
+   uint32_t High = 0, Low;
+   
+   Low = (Raw & 0xFFFF) * Mult;
+   
+   if(Raw > 0xFFFF)
+      High = (Raw >> 16) * Mult;
+      
+   if(Shift >= 16)
+      return((High + (Low >> 16)) >> (Shift - 16));
+      
+   return((High << (16 - Shift)) + (Low >> Shift));
+}
+
+//Scales a raw value of row Index of g_SpnTable[]
+int16_t SpnValue(uint8_t Index, uint32_t Raw)
+{
+   if(Raw >= g_SpnTable[Index].OffsetRaw)
+      return((int16_t)SpnScale(Raw - g_SpnTable[Index].OffsetRaw,g_SpnTable[Index].Mult,g_SpnTable[Index].Shift));
+   else
+      return(-(int16_t)SpnScale(g_SpnTable[Index].OffsetRaw - Raw,g_SpnTable[Index].Mult,g_SpnTable[Index].Shift));
+}
+
+//Decodes row Index of g_SpnTable[] from a message's data
+int16_t SpnDecode(uint8_t Index, uint8_t Bytes[])
+{
+   return(SpnValue(Index,SpnRaw(Bytes,g_SpnTable[Index].StartBit,g_SpnTable[Index].Length)));
+}
+
+#if SPN_KEEP_FLOAT == TRUE
+//Decodes row Index of g_SpnTable[] in float, the way the decoders did before
+//the table was fixed point
+int16_t SpnDecodeFloat(uint8_t Index, uint8_t Bytes[])
+{
+   return((int16_t)(SpnRaw(Bytes,g_SpnTable[Index].StartBit,g_SpnTable[Index].Length) * g_SpnTable[Index].Resolution + g_SpnTable[Index].Offset));
+}
+#endif
+
+//Decodes every SPN of PGN pgn from one message's data, each into Values[] at
+//its g_SpnTable[] row.  Returns the number of SPNs decoded, 0 if the PGN
+//isn't in the table.
+uint8_t SpnDecodePGN(uint16_t pgn, uint8_t Bytes[], int16_t Values[])
+{
+   uint8_t i, Count = 0;
+   
+   J1939ProfileStart(J1939_PROFILE_DECODE);
+   
+   i = SpnFindPGN(pgn);
+   
+   if(i != SPN_NOT_FOUND)
+   {
+      for(;(i < SPN_TABLE_ENTRIES) && (g_SpnTable[i].PGN == pgn);i++)
+      {
+         Values[i] = SpnDecode(i,Bytes);
+         Count++;
+      }
+   }
+   
+   J1939ProfileStop(J1939_PROFILE_DECODE);
+   
+   return(Count);
+}
+
+// ALMACEN DE VALORES
+
+//SPN value status
+#define SPN_NO_DATA        0     //not received since start up
+#define SPN_VALID          1
+#define SPN_ERROR          2     //sender flagged an error, a reserved value or outside Min to Max
+#define SPN_NOT_AVAILABLE  3     //sender doesn't have the value
+#define SPN_STALE          4     //PGN not received for Timeout ticks, only returned by SpnRead() and SpnSnapshot()
+
+//SPN value store entry, the last value received for a slot
+typedef struct _SPN_VALUE_STRUCT {
+   int16_t Value;
+   uint8_t Status;
+   J1939_TICK_TYPE Tick;         //J1939GetTick() when received
+} SPN_VALUE_STRUCT;
+
+//SPN value store, one entry per slot.  g_SpnStoreSequence is odd while
+//SpnStorePGN() is changing the store and moves on each time it does, so
+//SpnRead() and SpnSnapshot() copy again if SpnStorePGN() ran from an interrupt
+//while they were copying.  Don't call them from an interrupt that can stop
+//SpnStorePGN() part way.
+SPN_VALUE_STRUCT g_SpnStore[SPN_SLOTS];
+volatile uint8_t g_SpnStoreSequence;
+
+//Returns SPN_VALID, SPN_ERROR or SPN_NOT_AVAILABLE for a Length bit raw value.
+//J1939-71 reserves the top of each field's range, for 8 bits and more by the
+//field's most significant byte: 0xFB to 0xFD reserved, 0xFE error and 0xFF
+//not available.  Fields of 2 to 7 bits use their top values the same way.
+uint8_t SpnClassify(uint32_t Raw, uint8_t Length)
+{
+   uint8_t Top, Max;
+   
+   if(Length >= 8)
+   {
+      Top = Raw >> (Length - 8);
+      
+      if(Top == 0xFF)
+         return(SPN_NOT_AVAILABLE);
+      if(Top > 0xFA)
+         return(SPN_ERROR);
+   }
+   else if(Length >= 2)
+   {
+      Top = Raw;
+      Max = (1 << Length) - 1;
+      
+      if(Top == Max)
+         return(SPN_NOT_AVAILABLE);
+      if((Top == Max - 1) || ((Length >= 4) && (Top > Max - 5)))
+         return(SPN_ERROR);
+   }
+   
+   return(SPN_VALID);
+}
+
+//Finds the data bytes J1939-71 reserves for the whole message at once, bit n
+//of Reserved is set when byte n is 0xFB or more and bit n of NotAvailable when
+//it's 0xFF.  The cost doesn't depend on how many SPNs the message has.  Works
+//on 4 bytes per 32 bit word, on the host 8 bytes with one SSE2 compare.
+void SpnFrameFlags(uint8_t Bytes[], uint8_t &Reserved, uint8_t &NotAvailable)
+{
+  #if defined(__SSE2__)
+   __m128i Data;
+   
+   Data = _mm_loadl_epi64((const __m128i *)Bytes);
+   Reserved = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(Data,_mm_set1_epi8((char)0xFB)),Data));
+   NotAvailable = _mm_movemask_epi8(_mm_cmpeq_epi8(Data,_mm_set1_epi8((char)0xFF)));
+  #else
+   uint32_t Word, Low7, Flags;
+   uint8_t i;
+   
+   Reserved = 0;
+   NotAvailable = 0;
+   
+   for(i=0;i<8;i+=4)
+   {
+      Word = ((uint32_t)Bytes[i + 3] << 24) | ((uint32_t)Bytes[i + 2] << 16) | ((uint16_t)Bytes[i + 1] << 8) | Bytes[i];
+      Low7 = Word & 0x7F7F7F7F;
+      
+      //bit 7 of a byte is set if bit 7 was set and the low 7 bits carry when 5
+      //(0xFB or more) or 1 (0xFF) is added, no byte can carry into the next
+      Flags = ((Low7 + 0x05050505) & Word & 0x80808080) >> 7;
+      Reserved |= (uint8_t)((Flags | (Flags >> 7) | (Flags >> 14) | (Flags >> 21)) & 0x0F) << i;
+      
+      Flags = ((Low7 + 0x01010101) & Word & 0x80808080) >> 7;
+      NotAvailable |= (uint8_t)((Flags | (Flags >> 7) | (Flags >> 14) | (Flags >> 21)) & 0x0F) << i;
+   }
+  #endif
+}
+
+//Decodes every SPN of PGN pgn from one message's data into g_SpnStore[], with
+//its status and the tick it was received.  Can be called from an interrupt.
+//Returns the number of SPNs stored, 0 if the PGN isn't in the table.
+uint8_t SpnStorePGN(uint16_t pgn, uint8_t Bytes[])
+{
+   uint8_t i, Count = 0, Status, Top, Reserved, NotAvailable;
+   uint32_t Raw;
+   J1939_TICK_TYPE Tick;
+   
+   J1939ProfileStart(J1939_PROFILE_DECODE);
+   
+   i = SpnFindPGN(pgn);
+   
+   if(i != SPN_NOT_FOUND)
+   {
+      Tick = J1939GetTick();
+      SpnFrameFlags(Bytes,Reserved,NotAvailable);
+      g_SpnStoreSequence++;
+      
+      for(;(i < SPN_TABLE_ENTRIES) && (g_SpnTable[i].PGN == pgn);i++)
+      {
+         Raw = SpnRaw(Bytes,g_SpnTable[i].StartBit,g_SpnTable[i].Length);
+         Top = g_SpnTable[i].TopByte;
+         
+         if(Top == SPN_TOP_NONE)
+            Status = SpnClassify(Raw,g_SpnTable[i].Length);
+         else if((NotAvailable >> Top) & 1)
+            Status = SPN_NOT_AVAILABLE;
+         else if((Reserved >> Top) & 1)
+            Status = SPN_ERROR;
+         else
+            Status = SPN_VALID;
+         g_SpnStore[i].Value = SpnValue(i,Raw);
+         
+         if((Status == SPN_VALID) && ((g_SpnStore[i].Value < g_SpnTable[i].Min) || (g_SpnStore[i].Value > g_SpnTable[i].Max)))
+            Status = SPN_ERROR;
+            
+         g_SpnStore[i].Status = Status;
+         g_SpnStore[i].Tick = Tick;
+         Count++;
+      }
+      
+      g_SpnStoreSequence++;
+   }
+   
+   J1939ProfileStop(J1939_PROFILE_DECODE);
+   
+   return(Count);
+}
+
+//Returns the status of a store entry, SPN_STALE if it's older than its slot's
+//Timeout
+uint8_t SpnEntryStatus(uint8_t Slot, SPN_VALUE_STRUCT *Entry)
+{
+   if((Entry->Status != SPN_NO_DATA) && (J1939GetTickDifference(J1939GetTick(),Entry->Tick) > g_SpnTable[Slot].Timeout))
+      return(SPN_STALE);
+      
+   return(Entry->Status);
+}
+
+//Reads one slot of the store into Value, returns its status
+uint8_t SpnRead(uint8_t Slot, int16_t &Value)
+{
+   SPN_VALUE_STRUCT Entry;
+   uint8_t Sequence;
+   
+   do
+   {
+      Sequence = g_SpnStoreSequence;
+      Entry = g_SpnStore[Slot];
+   } while((Sequence & 1) || (Sequence != g_SpnStoreSequence));
+   
+   Value = Entry.Value;
+   
+   return(SpnEntryStatus(Slot,&Entry));
+}
+
+//Copies the whole store into Copy[SPN_SLOTS] as it was after one
+//SpnStorePGN(), with stale entries marked SPN_STALE
+void SpnSnapshot(SPN_VALUE_STRUCT *Copy)
+{
+   uint8_t Sequence, i;
+   
+   do
+   {
+      Sequence = g_SpnStoreSequence;
+      memcpy(Copy,g_SpnStore,sizeof(g_SpnStore));
+   } while((Sequence & 1) || (Sequence != g_SpnStoreSequence));
+   
+   for(i=0;i<SPN_SLOTS;i++)
+      Copy[i].Status = SpnEntryStatus(i,&Copy[i]);
+}
+
+//Decodes SPN spn of PGN pgn into dato, dato is 0 if the table doesn't have it
+void lecturaDelParametro(int16 pgn, int spn, int8 Bytes[], int16* dato)
+{  
+   uint8_t Index;
+   
+   J1939ProfileStart(J1939_PROFILE_DECODE);
+   
+   Index = SpnFind(pgn,spn);
+   
+   if(Index == SPN_NOT_FOUND)
+      *dato = 0;
+   else
+      *dato = SpnDecode(Index,Bytes);
+   
+   J1939ProfileStop(J1939_PROFILE_DECODE);
+}
+
+// FIN DEL BLOQUE DE LAS FUNCIONES SPN Y PGN
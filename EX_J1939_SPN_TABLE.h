@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+////                          EX_J1939_SPN_TABLE.h                          ////
+////                                                                        ////
+//// SPN table for EX_J1939_SPN.c, generated by j1939-gen.cpp.  Change the  ////
+//// source and generate it again instead of editing it.                    ////
+////                                                                        ////
+////    EX_J1939_SPN.csv                                                    ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+//PGNs
+#define PGN_ELECTRONIC_ENGINE_CONTROLLER_1  0xF004      //61444
+#define PGN_ENGINE_TEMPERATURE              0xFEEE      //65262
+#define PGN_FUEL_ECONOMY                    0xFEF2      //65266
+#define PGN_VEHICLE_POSITION                0xFEF3      //65267
+#define PGN_DASH_DISPLAY                    0xFEFC      //65276
+
+//SPNs
+#define SPN_ENGINE_SPEED                190
+#define SPN_ENGINE_COOLANT_TEMPERATURE  110
+#define SPN_ENGINE_FUEL_TEMPERATURE_1   174
+#define SPN_ENGINE_OIL_TEMPERATURE_1    175
+#define SPN_ENGINE_FUEL_RATE            183
+#define SPN_ENGINE_THROTTLE_POSITION    51
+#define SPN_LATITUDE                    584
+#define SPN_LONGITUDE                   585
+#define SPN_FUEL_LEVEL_1                96
+
+//Slot of each signal in g_SpnTable[] and g_SpnStore[]
+enum {
+   SPN_SLOT_ENGINE_SPEED,
+   SPN_SLOT_ENGINE_COOLANT_TEMPERATURE,
+   SPN_SLOT_ENGINE_FUEL_TEMPERATURE_1,
+   SPN_SLOT_ENGINE_OIL_TEMPERATURE_1,
+   SPN_SLOT_ENGINE_FUEL_RATE,
+   SPN_SLOT_ENGINE_THROTTLE_POSITION,
+   SPN_SLOT_LATITUDE,
+   SPN_SLOT_LONGITUDE,
+   SPN_SLOT_FUEL_LEVEL_1,
+   SPN_SLOTS
+};
+
+//Decoded signals, sorted by PGN.  Rate is the PGN's transmission rate in ms.
+const SPN_STRUCT g_SpnTable[] = {
+   SPN_ROW(PGN_ELECTRONIC_ENGINE_CONTROLLER_1, SPN_ENGINE_SPEED,               24, 16,      0.125,  3,      0,      0,   8031,    50),   //rpm
+   SPN_ROW(PGN_ENGINE_TEMPERATURE,             SPN_ENGINE_COOLANT_TEMPERATURE,  0,  8,          1,  0,    -40,    -40,    210,  1000),   //deg C
+   SPN_ROW(PGN_ENGINE_TEMPERATURE,             SPN_ENGINE_FUEL_TEMPERATURE_1,   8,  8,          1,  0,    -40,    -40,    210,  1000),   //deg C
+   SPN_ROW(PGN_ENGINE_TEMPERATURE,             SPN_ENGINE_OIL_TEMPERATURE_1,   16, 16,    0.03125,  5,   -273,   -273,   1734,  1000),   //deg C
+   SPN_ROW(PGN_FUEL_ECONOMY,                   SPN_ENGINE_FUEL_RATE,            0, 16,       0.05, 20,      0,      0,   3212,   100),   //L/h
+   SPN_ROW(PGN_FUEL_ECONOMY,                   SPN_ENGINE_THROTTLE_POSITION,   48,  8,        0.4, 17,      0,      0,    100,   100),   //%
+   SPN_ROW(PGN_VEHICLE_POSITION,               SPN_LATITUDE,                    0, 32,  0.0000001, 39,   -210,   -210,    211,  5000),   //deg
+   SPN_ROW(PGN_VEHICLE_POSITION,               SPN_LONGITUDE,                  32, 32,  0.0000001, 39,   -210,   -210,    211,  5000),   //deg
+   SPN_ROW(PGN_DASH_DISPLAY,                   SPN_FUEL_LEVEL_1,                8,  8,        0.4, 17,      0,      0,    100,  1000),   //%
+};
+
+//PGNs decoded, for requesting them or setting up CAN filters
+#define SPN_PGNS  5
+
+const uint16_t g_SpnPgnList[SPN_PGNS] = {
+   PGN_ELECTRONIC_ENGINE_CONTROLLER_1,
+   PGN_ENGINE_TEMPERATURE,
+   PGN_FUEL_ECONOMY,
+   PGN_VEHICLE_POSITION,
+   PGN_DASH_DISPLAY,
+};
+
+//Perfect hash from PGN to its first row of g_SpnTable[], SPN_NOT_FOUND if
+//no PGN hashes there.  The row's PGN still has to be compared.
+#define SPN_PGN_HASH_BITS   3
+#define SPN_PGN_HASH_MULT   21
+#define SPN_PGN_HASH(pgn)   ((uint8_t)((uint8_t)(pgn) * SPN_PGN_HASH_MULT + (uint8_t)((pgn) >> 8)) >> (8 - SPN_PGN_HASH_BITS))
+
+const uint8_t g_SpnPgnHash[1 << SPN_PGN_HASH_BITS] = {
+   SPN_NOT_FOUND, SPN_NOT_FOUND, 0, SPN_NOT_FOUND, 1, 8, 4, 6
+};
@@ -0,0 +1,793 @@
+/////////////////////////////////////////////////////////////////////////
+////                          can-host.c                             ////
+//// CAN Library routines for building the J1939 driver on a PC with ////
+//// GCC or Clang.  Gives j1939.c the same functions as the MCP2515  ////
+//// driver, over a backend selected with can_host_set_ops().        ////
+////                                                                 ////
+//// This library provides the following functions:                  ////
+////  (for more information on these functions see the comment       ////
+////   header above each function)                                   ////
+////                                                                 ////
+////    can_host_set_ops - Selects the backend, default is an        ////
+////                       unconnected loopback port                 ////
+////                                                                 ////
+////    can_host_loopback_connect - Connects two loopback ports      ////
+////                                                                 ////
+////    can_host_loopback_put - Puts a frame in a loopback port's    ////
+////                            receive queue                        ////
+////                                                                 ////
+////    can_host_loopback_get - Gets a frame from a loopback port's  ////
+////                            receive queue                        ////
+////                                                                 ////
+////    can_init - Sets masks to accept all and starts the backend   ////
+////                                                                 ////
+////    can_set_baud - Does nothing, baud rate is set by backend     ////
+////                                                                 ////
+////    can_set_baud_rate - Changes the baud rate, if the backend    ////
+////                        has one                                  ////
+////                                                                 ////
+////    can_set_mode - Sets the CAN mode                             ////
+////                                                                 ////
+////    can_set_id - Sets a mask or filter                           ////
+////                                                                 ////
+////    can_get_id - Gets a mask or filter                           ////
+////                                                                 ////
+////    can_putd - Sends a message with specified ID                 ////
+////                                                                 ////
+////    can_getd - Returns next message that passes the filters      ////
+////                                                                 ////
+////    can_kbhit - Returns true if a message is waiting             ////
+////                                                                 ////
+////    can_tbe - Returns true if the backend can send a message     ////
+////                                                                 ////
+////    can_abort - Does nothing, messages are sent at once          ////
+////                                                                 ////
+////    can_host_irxif - Invalid message flag, CAN_INT_IRXIF         ////
+////                                                                 ////
+//// Backends:                                                       ////
+////                                                                 ////
+////    can_host_loopback_ops - in process, context is a             ////
+////                            can_host_loopback                    ////
+////                                                                 ////
+////    can_host_socketcan_ops - Linux SocketCAN, context is a       ////
+////                             can_host_socketcan, needs           ////
+////                             CAN_HOST_SOCKETCAN defined TRUE     ////
+////                                                                 ////
+//// j1939.c includes this file when USE_HOST_CAN is TRUE, see       ////
+//// EX_J1939HOST.c for how to build it.                             ////
+////                                                                 ////
+/////////////////////////////////////////////////////////////////////////
+
+#include "can-host.h"
+
+#if CAN_HOST_SOCKETCAN == TRUE
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#endif
+
+const can_host_ops * can_host_current_ops;
+void * can_host_context;
+
+can_host_loopback can_host_default_port;     //used if can_host_set_ops() isn't called
+
+CAN_OP_MODE can_host_mode=CAN_OP_CONFIG;
+uint32_t can_host_id[8];                     //masks and filters, indexed by RX0MASK..RX1FILTER5
+int1 can_host_id_ext[8];
+
+can_host_frame can_host_pending;             //frame can_kbhit() found that passed the filters
+int1 can_host_pending_valid;
+uint8_t can_host_pending_filter;
+
+int1 can_host_invalid;                       //CAN_INT_IRXIF, set from the backend's rx_invalid
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_set_ops()
+//
+// Selects the backend used by the other functions, must be called
+// before can_init() (J1939Init()).
+//
+//    Parameters:
+//       ops - backend functions, can_host_loopback_ops or
+//             can_host_socketcan_ops
+//       context - backend's port, passed to each backend function
+//
+//    Returns:
+//       Nothing
+//
+////////////////////////////////////////////////////////////////////////
+void can_host_set_ops(const can_host_ops * ops, void * context)
+{
+   can_host_current_ops=ops;
+   can_host_context=context;
+   can_host_pending_valid=FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_filter_changed()
+//
+// Passes a filter and its mask to the backend's set_filter function.
+//
+//    Parameters:
+//       addr - RX0FILTER0 to RX1FILTER5
+//
+//    Returns:
+//       Nothing
+//
+////////////////////////////////////////////////////////////////////////
+void can_host_filter_changed(uint8_t addr)
+{
+   uint8_t mask;
+
+   if(can_host_current_ops->set_filter == NULL)
+      return;
+
+   if(addr <= RX0FILTER1)
+      mask=RX0MASK;
+   else
+      mask=RX1MASK;
+
+   can_host_current_ops->set_filter(can_host_context,addr-RX0FILTER0,can_host_id[mask],can_host_id[addr],can_host_id_ext[addr]);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_accept()
+//
+// Checks a frame against the filters the way the MCP2515 does, buffer 0
+// (filters 0 and 1) first.
+//
+//    Parameters:
+//       frame - frame to check
+//
+//    Returns:
+//       Filter that accepted the frame, 0 to 5, or 0xFF if none did
+//
+////////////////////////////////////////////////////////////////////////
+uint8_t can_host_accept(can_host_frame * frame)
+{
+   uint8_t addr, mask;
+
+   for(addr=RX0FILTER0;addr<=RX1FILTER5;addr++)
+   {
+      if(addr <= RX0FILTER1)
+         mask=RX0MASK;
+      else
+         mask=RX1MASK;
+
+      if((frame->ext == can_host_id_ext[addr]) && (((frame->id ^ can_host_id[addr]) & can_host_id[mask]) == 0))
+         return(addr-RX0FILTER0);
+   }
+
+   return(0xFF);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_init()
+//
+// Starts the backend, sets the masks so all IDs are received and puts
+// the driver in CAN_INIT_OP_MODE, normal mode unless J1939_USE_AUTO_BAUD
+// wants listen only.  Uses an unconnected loopback port if
+// can_host_set_ops() wasn't called.
+//
+////////////////////////////////////////////////////////////////////////
+void can_init(void)
+{
+   uint8_t addr;
+
+   if(can_host_current_ops == NULL)
+      can_host_set_ops(&can_host_loopback_ops,&can_host_default_port);
+
+   can_set_mode(CAN_OP_CONFIG);
+
+   can_host_current_ops->init(can_host_context);
+
+   for(addr=RX0MASK;addr<=RX1FILTER5;addr++)
+      can_set_id(addr,CAN_MASK_ACCEPT_ALL,CAN_USE_EXTENDED_ID);
+
+   can_host_invalid=FALSE;
+
+   can_set_mode(CAN_INIT_OP_MODE);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_set_baud()
+//
+// Does nothing, the baud rate of a SocketCAN interface is set with
+// "ip link set can0 type can bitrate 250000" and a loopback port has
+// none.
+//
+////////////////////////////////////////////////////////////////////////
+void can_set_baud(void)
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_set_baud_rate()
+//
+// Changes the baud rate at run time with the backend's set_baud, does
+// nothing if it has none.  Like the PIC18 the driver is put in config
+// mode while it changes and then put back in the mode it was in.
+//
+//    Parameters:
+//       baud - CAN_BAUD_1000K, CAN_BAUD_500K, CAN_BAUD_250K, CAN_BAUD_200K
+//              or CAN_BAUD_125K
+//
+//    Returns:
+//       Nothing
+//
+////////////////////////////////////////////////////////////////////////
+void can_set_baud_rate(CAN_BAUD_RATE baud)
+{
+   CAN_OP_MODE mode;
+
+   if(can_host_current_ops->set_baud == NULL)
+      return;
+
+   mode=can_host_mode;
+   can_set_mode(CAN_OP_CONFIG);
+
+   can_host_current_ops->set_baud(can_host_context,baud);
+
+   can_set_mode(mode);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_set_mode()
+//
+// Sets the CAN mode.  Frames are only sent in normal mode and only
+// received in normal, listen and loopback modes.
+//
+//    Parameters:
+//       mode - CAN_OP_CONFIG, CAN_OP_LISTEN, CAN_OP_LOOPBACK,
+//              CAN_OP_DISABLE or CAN_OP_NORMAL
+//
+//    Returns:
+//       Nothing
+//
+////////////////////////////////////////////////////////////////////////
+void can_set_mode(CAN_OP_MODE mode)
+{
+   can_host_mode=mode;
+
+   if(can_host_current_ops->set_mode != NULL)
+      can_host_current_ops->set_mode(can_host_context,mode);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_set_id()
+//
+// Sets a mask or filter, a mask passes all its filters to the backend
+// again.
+//
+//    Parameters:
+//       addr - RX0MASK, RX1MASK or RX0FILTER0 to RX1FILTER5
+//       id - mask or filter value
+//       ext - TRUE for 29-bit ID
+//
+//    Returns:
+//       Nothing
+//
+////////////////////////////////////////////////////////////////////////
+void can_set_id(uint8_t addr, uint32_t id, int1 ext)
+{
+   uint8_t filter;
+
+   if(addr > RX1FILTER5)
+      return;
+
+   can_host_id[addr]=id;
+   can_host_id_ext[addr]=ext;
+   can_host_pending_valid=FALSE;    //check it again against new filters
+
+   if(addr == RX0MASK)
+   {
+      can_host_filter_changed(RX0FILTER0);
+      can_host_filter_changed(RX0FILTER1);
+   }
+   else if(addr == RX1MASK)
+   {
+      for(filter=RX1FILTER2;filter<=RX1FILTER5;filter++)
+         can_host_filter_changed(filter);
+   }
+   else
+      can_host_filter_changed(addr);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_get_id()
+//
+// Returns a mask or filter.
+//
+//    Parameters:
+//       addr - RX0MASK, RX1MASK or RX0FILTER0 to RX1FILTER5
+//
+//    Returns:
+//       mask or filter value
+//
+////////////////////////////////////////////////////////////////////////
+uint32_t can_get_id(uint8_t addr)
+{
+   if(addr > RX1FILTER5)
+      return(0);
+
+   return(can_host_id[addr]);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_putd()
+//
+// Sends a message through the backend.
+//
+//    Parameters:
+//       id - ID to send
+//       data - pointer to data to send
+//       len - length of data to send, more than 8 is sent as 8
+//       priority - not used, the backend sends messages in order
+//       ext - TRUE for 29-bit ID
+//       rtr - TRUE for remote transmission request
+//
+//    Returns:
+//       TRUE if the message was sent, FALSE if not in normal mode or
+//       the backend had no room
+//
+////////////////////////////////////////////////////////////////////////
+int1 can_putd(uint32_t id, uint8_t * data, uint8_t len, uint8_t priority, int1 ext, int1 rtr)
+{
+   can_host_frame frame;
+
+   (void)priority;
+
+   if(can_host_mode != CAN_OP_NORMAL)
+      return(FALSE);
+
+   if(len > 8)
+      len=8;
+
+   frame.id=id;
+   frame.len=len;
+   frame.ext=ext;
+   frame.rtr=rtr;
+   memset(frame.data,0,8);
+   if(!rtr)
+      memcpy(frame.data,data,len);
+
+   return(can_host_current_ops->putd(can_host_context,&frame));
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_kbhit()
+//
+// Looks for a message that passes the filters, messages that don't are
+// thrown away.  The message found is kept for can_getd().
+//
+//    Returns:
+//       TRUE if a message is waiting
+//
+////////////////////////////////////////////////////////////////////////
+int1 can_kbhit(void)
+{
+   uint8_t filter;
+
+   if(can_host_pending_valid)
+      return(TRUE);
+
+   if((can_host_mode != CAN_OP_NORMAL) && (can_host_mode != CAN_OP_LISTEN) && (can_host_mode != CAN_OP_LOOPBACK))
+      return(FALSE);
+
+   while(can_host_current_ops->getd(can_host_context,&can_host_pending))
+   {
+      filter=can_host_accept(&can_host_pending);
+
+      if(filter != 0xFF)
+      {
+         can_host_pending_filter=filter;
+         can_host_pending_valid=TRUE;
+         return(TRUE);
+      }
+   }
+
+   return(FALSE);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_getd()
+//
+// Gets the next message that passes the filters.
+//
+//    Parameters:
+//       id - ID of message
+//       data - pointer to 8 bytes for the data
+//       len - length of data
+//       stat - buffer is 0 for filters 0 and 1, 1 for the others,
+//              filthit is the filter
+//
+//    Returns:
+//       TRUE if a message was returned, FALSE if none is waiting
+//
+////////////////////////////////////////////////////////////////////////
+int1 can_getd(uint32_t & id, uint8_t * data, uint8_t & len, struct rx_stat & stat)
+{
+   if(!can_kbhit())
+      return(FALSE);
+
+   id=can_host_pending.id;
+   len=(can_host_pending.len > 8) ? 8 : can_host_pending.len;
+   memcpy(data,can_host_pending.data,8);
+
+   stat.err_ovfl=FALSE;
+   stat.filthit=can_host_pending_filter;
+   stat.buffer=(can_host_pending_filter < 2) ? 0 : 1;
+   stat.rtr=can_host_pending.rtr;
+   stat.ext=can_host_pending.ext;
+   stat.inv=CAN_INT_IRXIF;
+   CAN_INT_IRXIF=FALSE;
+
+   can_host_pending_valid=FALSE;
+
+   return(TRUE);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_tbe()
+//
+//    Returns:
+//       TRUE if in normal mode and the backend can send a message
+//
+////////////////////////////////////////////////////////////////////////
+int1 can_tbe(void)
+{
+   if(can_host_mode != CAN_OP_NORMAL)
+      return(FALSE);
+
+   return(can_host_current_ops->tbe(can_host_context));
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_abort()
+//
+// Does nothing, the backends send each message when can_putd() is
+// called.
+//
+////////////////////////////////////////////////////////////////////////
+void can_abort(void)
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_irxif()
+//
+// The invalid message flag CAN_INT_IRXIF stands for.  Asks the backend's
+// rx_invalid each time it's read, once set it stays set until cleared.
+//
+//    Returns:
+//       the flag, TRUE if a frame with an error was seen
+//
+////////////////////////////////////////////////////////////////////////
+int1 & can_host_irxif(void)
+{
+   if((can_host_current_ops != NULL) && (can_host_current_ops->rx_invalid != NULL) && can_host_current_ops->rx_invalid(can_host_context))
+      can_host_invalid=TRUE;
+
+   return(can_host_invalid);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///////////////////////////  Loopback backend  /////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_loopback_connect()
+//
+// Connects two loopback ports, like a CAN bus with two nodes.  Frames
+// sent on one are received on the other.
+//
+////////////////////////////////////////////////////////////////////////
+void can_host_loopback_connect(can_host_loopback * a, can_host_loopback * b)
+{
+   a->peer=b;
+   b->peer=a;
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_loopback_put()
+//
+// Puts a frame in a port's receive queue.
+//
+//    Returns:
+//       TRUE if the frame was queued, FALSE if the queue was full
+//
+////////////////////////////////////////////////////////////////////////
+int1 can_host_loopback_put(can_host_loopback * port, can_host_frame * frame)
+{
+   if(port->count >= CAN_HOST_LOOPBACK_FRAMES)
+   {
+      port->dropped++;
+      return(FALSE);
+   }
+
+   port->rx[port->next_in]=*frame;
+
+   if(++port->next_in >= CAN_HOST_LOOPBACK_FRAMES)
+      port->next_in=0;
+
+   port->count++;
+
+   return(TRUE);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_loopback_get()
+//
+// Gets the oldest frame from a port's receive queue.
+//
+//    Returns:
+//       TRUE if a frame was returned, FALSE if the queue was empty
+//
+////////////////////////////////////////////////////////////////////////
+int1 can_host_loopback_get(can_host_loopback * port, can_host_frame * frame)
+{
+   if(port->count == 0)
+      return(FALSE);
+
+   *frame=port->rx[port->next_out];
+
+   if(++port->next_out >= CAN_HOST_LOOPBACK_FRAMES)
+      port->next_out=0;
+
+   port->count--;
+
+   return(TRUE);
+}
+
+int1 can_host_loopback_init(void * context)
+{
+   can_host_loopback * port=(can_host_loopback *)context;
+
+   port->next_in=0;
+   port->next_out=0;
+   port->count=0;
+
+   return(TRUE);
+}
+
+int1 can_host_loopback_getd(void * context, can_host_frame * frame)
+{
+   return(can_host_loopback_get((can_host_loopback *)context,frame));
+}
+
+int1 can_host_loopback_putd(void * context, can_host_frame * frame)
+{
+   can_host_loopback * port=(can_host_loopback *)context;
+
+   if(port->peer != NULL)
+      return(can_host_loopback_put(port->peer,frame));
+
+   return(can_host_loopback_put(port,frame));
+}
+
+int1 can_host_loopback_kbhit(void * context)
+{
+   return(((can_host_loopback *)context)->count != 0);
+}
+
+int1 can_host_loopback_tbe(void * context)
+{
+   can_host_loopback * port=(can_host_loopback *)context;
+
+   if(port->peer != NULL)
+      port=port->peer;
+
+   return(port->count < CAN_HOST_LOOPBACK_FRAMES);
+}
+
+const can_host_ops can_host_loopback_ops={
+   can_host_loopback_init,
+   can_host_loopback_getd,
+   can_host_loopback_putd,
+   can_host_loopback_kbhit,
+   can_host_loopback_tbe,
+   NULL,
+   NULL,
+   NULL,
+   NULL
+};
+
+#if CAN_HOST_SOCKETCAN == TRUE
+////////////////////////////////////////////////////////////////////////////////
+///////////////////////////  SocketCAN backend  ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_socketcan_init()
+//
+// Opens a non-blocking raw CAN socket on port->interface.
+//
+//    Returns:
+//       TRUE if the socket was opened, FALSE if not
+//
+////////////////////////////////////////////////////////////////////////
+int1 can_host_socketcan_init(void * context)
+{
+   can_host_socketcan * port=(can_host_socketcan *)context;
+   struct ifreq ifr;
+   struct sockaddr_can addr;
+
+   port->socket=socket(PF_CAN,SOCK_RAW,CAN_RAW);
+   if(port->socket < 0)
+      return(FALSE);
+
+   memset(&ifr,0,sizeof(ifr));
+   strncpy(ifr.ifr_name,port->interface,IFNAMSIZ-1);
+   if(ioctl(port->socket,SIOCGIFINDEX,&ifr) < 0)
+   {
+      close(port->socket);
+      port->socket=-1;
+      return(FALSE);
+   }
+
+   memset(&addr,0,sizeof(addr));
+   addr.can_family=AF_CAN;
+   addr.can_ifindex=ifr.ifr_ifindex;
+   if(bind(port->socket,(struct sockaddr *)&addr,sizeof(addr)) < 0)
+   {
+      close(port->socket);
+      port->socket=-1;
+      return(FALSE);
+   }
+
+   fcntl(port->socket,F_SETFL,fcntl(port->socket,F_GETFL) | O_NONBLOCK);
+
+   return(TRUE);
+}
+
+int1 can_host_socketcan_getd(void * context, can_host_frame * frame)
+{
+   can_host_socketcan * port=(can_host_socketcan *)context;
+   struct can_frame cf;
+
+   if(port->socket < 0)
+      return(FALSE);
+
+   while(read(port->socket,&cf,sizeof(cf)) == sizeof(cf))
+   {
+      if(cf.can_id & CAN_ERR_FLAG)
+         continue;
+
+      frame->ext=((cf.can_id & CAN_EFF_FLAG) != 0);
+      frame->rtr=((cf.can_id & CAN_RTR_FLAG) != 0);
+      frame->id=cf.can_id & (frame->ext ? CAN_EFF_MASK : CAN_SFF_MASK);
+      frame->len=(cf.can_dlc > 8) ? 8 : cf.can_dlc;
+      memcpy(frame->data,cf.data,8);
+
+      return(TRUE);
+   }
+
+   return(FALSE);
+}
+
+int1 can_host_socketcan_putd(void * context, can_host_frame * frame)
+{
+   can_host_socketcan * port=(can_host_socketcan *)context;
+   struct can_frame cf;
+
+   if(port->socket < 0)
+      return(FALSE);
+
+   memset(&cf,0,sizeof(cf));
+   cf.can_id=frame->id;
+   if(frame->ext)
+      cf.can_id|=CAN_EFF_FLAG;
+   if(frame->rtr)
+      cf.can_id|=CAN_RTR_FLAG;
+   cf.can_dlc=frame->len;
+   memcpy(cf.data,frame->data,8);
+
+   return(write(port->socket,&cf,sizeof(cf)) == sizeof(cf));
+}
+
+int1 can_host_socketcan_kbhit(void * context)
+{
+   can_host_socketcan * port=(can_host_socketcan *)context;
+   struct pollfd pfd;
+
+   if(port->socket < 0)
+      return(FALSE);
+
+   pfd.fd=port->socket;
+   pfd.events=POLLIN;
+
+   return(poll(&pfd,1,0) > 0);
+}
+
+int1 can_host_socketcan_tbe(void * context)
+{
+   can_host_socketcan * port=(can_host_socketcan *)context;
+   struct pollfd pfd;
+
+   if(port->socket < 0)
+      return(FALSE);
+
+   pfd.fd=port->socket;
+   pfd.events=POLLOUT;
+
+   return(poll(&pfd,1,0) > 0);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// can_host_socketcan_set_filter()
+//
+// Loads the filters into the kernel, so frames J1939 doesn't want are
+// never copied to the process.
+//
+////////////////////////////////////////////////////////////////////////
+void can_host_socketcan_set_filter(void * context, uint8_t filter, uint32_t mask, uint32_t id, int1 ext)
+{
+   can_host_socketcan * port=(can_host_socketcan *)context;
+   struct can_filter rfilter[6];
+   uint8_t i;
+
+   if(filter >= 6)
+      return;
+
+   port->filter_id[filter]=id;
+   port->filter_mask[filter]=mask;
+   port->filter_ext[filter]=ext;
+
+   if(port->socket < 0)
+      return;
+
+   for(i=0;i<6;i++)
+   {
+      if(port->filter_ext[i])
+      {
+         rfilter[i].can_id=(port->filter_id[i] & CAN_EFF_MASK) | CAN_EFF_FLAG;
+         rfilter[i].can_mask=(port->filter_mask[i] & CAN_EFF_MASK) | CAN_EFF_FLAG;
+      }
+      else
+      {
+         rfilter[i].can_id=port->filter_id[i] & CAN_SFF_MASK;
+         rfilter[i].can_mask=(port->filter_mask[i] & CAN_SFF_MASK) | CAN_EFF_FLAG;
+      }
+   }
+
+   setsockopt(port->socket,SOL_CAN_RAW,CAN_RAW_FILTER,rfilter,sizeof(rfilter));
+}
+
+const can_host_ops can_host_socketcan_ops={
+   can_host_socketcan_init,
+   can_host_socketcan_getd,
+   can_host_socketcan_putd,
+   can_host_socketcan_kbhit,
+   can_host_socketcan_tbe,
+   can_host_socketcan_set_filter,
+   NULL,
+   NULL,
+   NULL
+};
+#endif
@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////////////////////////
+////                          can-host.h                             ////
+////                                                                 ////
+//// Prototypes, definitions, defines and macros used for and with   ////
+//// the host CAN driver, used to build the J1939 driver with GCC or ////
+//// Clang on a PC.                                                  ////
+////                                                                 ////
+//// Also defines the CCS built in types and constants the J1939     ////
+//// driver uses, so j1939.c compiles as C++ (it uses reference      ////
+//// parameters).                                                    ////
+////                                                                 ////
+//// (see can-host.c)                                                ////
+////                                                                 ////
+/////////////////////////////////////////////////////////////////////////
+
+#ifndef __CAN_HOST_LIB_DEFINES__
+#define __CAN_HOST_LIB_DEFINES__
+
+#include <stdint.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////  CCS built ins //////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(__PCB__) && !defined(__PCM__) && !defined(__PCH__) && !defined(__PCD__)
+typedef uint8_t int1;
+
+#ifndef TRUE
+ #define TRUE   1
+#endif
+
+#ifndef FALSE
+ #define FALSE  0
+#endif
+#endif
+
+#ifndef CAN_USE_EXTENDED_ID
+ #define CAN_USE_EXTENDED_ID   TRUE
+#endif
+
+//number of frames each loopback port can hold waiting to be read
+#ifndef CAN_HOST_LOOPBACK_FRAMES
+ #define CAN_HOST_LOOPBACK_FRAMES 64
+#endif
+
+//set to TRUE to build the SocketCAN backend, Linux only
+#ifndef CAN_HOST_SOCKETCAN
+ #define CAN_HOST_SOCKETCAN FALSE
+#endif
+
+#ifndef CAN_INIT_OP_MODE
+ #define CAN_INIT_OP_MODE CAN_OP_NORMAL   //mode can_init() leaves the driver in
+#endif
+
+#define CAN_MASK_ACCEPT_ALL   0x00000000
+
+////////////////////////////////////////////////////////////////////////////////
+///////////////////////////  Masks and Filters  ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+//same masks and filters as the MCP2515, mask 0 goes with filters 0 and 1 and
+//mask 1 with filters 2 to 5.  They index can_host_id[] instead of being
+//register addresses.
+#define RX0MASK      0
+#define RX1MASK      1
+#define RX0FILTER0   2
+#define RX0FILTER1   3
+#define RX1FILTER2   4
+#define RX1FILTER3   5
+#define RX1FILTER4   6
+#define RX1FILTER5   7
+
+enum CAN_OP_MODE {   CAN_OP_CONFIG=4,
+                     CAN_OP_LISTEN=3,
+                     CAN_OP_LOOPBACK=2,
+                     CAN_OP_DISABLE=1,
+                     CAN_OP_NORMAL=0 };
+
+enum CAN_BAUD_RATE { CAN_BAUD_1000K=0,
+                     CAN_BAUD_500K=1,
+                     CAN_BAUD_250K=2,
+                     CAN_BAUD_200K=3,
+                     CAN_BAUD_125K=4 };
+
+struct rx_stat {
+   int1 err_ovfl;      // buffer overflow
+   uint8_t filthit;    // filter that allowed the frame into the buffer
+   uint8_t buffer;     // receive buffer
+   int1 rtr;           // rtr requested
+   int1 ext;           // extended id
+   int1 inv;           // invalid id?
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////  Backends  /////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _can_host_frame {
+   uint32_t id;
+   uint8_t data[8];
+   uint8_t len;
+   int1 ext;
+   int1 rtr;
+} can_host_frame;
+
+//Backend functions, context is the pointer given to can_host_set_ops().
+//getd and putd return FALSE when there is no frame or no room.  set_filter
+//and set_mode may be NULL, frames are always filtered by can_getd() as well.
+//set_baud and rx_invalid may be NULL, they are only used by J1939AutoBaud().
+//rx_invalid returns TRUE if a frame with an error was seen since it was last
+//called, like the PIC18 IRXIF flag.
+typedef struct _can_host_ops {
+   int1 (*init)(void * context);
+   int1 (*getd)(void * context, can_host_frame * frame);
+   int1 (*putd)(void * context, can_host_frame * frame);
+   int1 (*kbhit)(void * context);
+   int1 (*tbe)(void * context);
+   void (*set_filter)(void * context, uint8_t filter, uint32_t mask, uint32_t id, int1 ext);
+   void (*set_mode)(void * context, CAN_OP_MODE mode);
+   void (*set_baud)(void * context, CAN_BAUD_RATE baud);
+   int1 (*rx_invalid)(void * context);
+} can_host_ops;
+
+//In process loopback port.  Frames sent on a port go into the receive queue
+//of the port it's connected to, or its own if it isn't connected.
+typedef struct _can_host_loopback {
+   can_host_frame rx[CAN_HOST_LOOPBACK_FRAMES];
+   uint16_t next_in;
+   uint16_t next_out;
+   uint16_t count;
+   uint32_t dropped;                   //frames lost because rx was full
+   struct _can_host_loopback * peer;
+} can_host_loopback;
+
+extern const can_host_ops can_host_loopback_ops;
+
+#if CAN_HOST_SOCKETCAN == TRUE
+//SocketCAN port, set interface before can_init(), for example "can0" or
+//"vcan0".  The baud rate is set on the interface with ip link.
+typedef struct _can_host_socketcan {
+   const char * interface;
+   int socket;
+   uint32_t filter_id[6];              //filters 0 to 5 and the mask that goes with each
+   uint32_t filter_mask[6];
+   int1 filter_ext[6];
+} can_host_socketcan;
+
+extern const can_host_ops can_host_socketcan_ops;
+#endif
+
+void  can_host_set_ops(const can_host_ops * ops, void * context);
+void  can_host_loopback_connect(can_host_loopback * a, can_host_loopback * b);
+int1  can_host_loopback_put(can_host_loopback * port, can_host_frame * frame);
+int1  can_host_loopback_get(can_host_loopback * port, can_host_frame * frame);
+
+void  can_init(void);
+void  can_set_baud(void);
+void  can_set_baud_rate(CAN_BAUD_RATE baud);
+void  can_set_mode(CAN_OP_MODE mode);
+void  can_set_id(uint8_t addr, uint32_t id, int1 ext);
+uint32_t can_get_id(uint8_t addr);
+int1  can_putd(uint32_t id, uint8_t * data, uint8_t len, uint8_t priority, int1 ext, int1 rtr);
+int1  can_getd(uint32_t & id, uint8_t * data, uint8_t & len, struct rx_stat & stat);
+int1  can_kbhit(void);
+int1  can_tbe(void);
+void  can_abort(void);
+int1 & can_host_irxif(void);
+
+//invalid message flag, read and cleared like the PIC18's
+#define CAN_INT_IRXIF   can_host_irxif()
+
+#endif
@@ -0,0 +1,903 @@
+////////////////////////////////////////////////////////////////////////////////
+////                             j1939-bench.cpp                            ////
+////                                                                        ////
+//// Benchmarks the J1939 driver's hot paths on a PC, using the host CAN    ////
+//// driver (can-host.c) with a backend that hands out frames from memory.  ////
+////                                                                        ////
+////    receive - J1939ReceiveTask() then J1939GetMessage() per frame       ////
+////    transmit - J1939PutMessage() then J1939XmitTask() per frame         ////
+////    address_claim - J1939HandleAddressClaim() per Address Claimed from  ////
+////                    other units, some contending for this unit's        ////
+////                    address                                             ////
+////    decode - lecturaDelParametro() from EX_J1939_SPN.c per SPN          ////
+////    decode_frame - SpnDecodePGN(), all SPNs of a frame in one pass      ////
+////    store_frame - SpnStorePGN(), the same into the SPN value store      ////
+////    scale - SpnDecode(), the fixed point bit extract and scaling of     ////
+////            lecturaDelParametro() without the table search              ////
+////    scale_float - SpnDecodeFloat(), the same scaled in float            ////
+////                                                                        ////
+//// The traffic is a synthetic engine mix, or a candump log (-file) with   ////
+//// lines like "(1600000000.000000) can0 18FEF200#0102030405060708".       ////
+////                                                                        ////
+//// Each benchmark runs for -time ms, -repeat times, and the fastest run   ////
+//// is reported as ns and items per second.  Memory allocations made       ////
+//// during the runs are counted (glibc, not under ASan), the driver should ////
+//// make none.                                                             ////
+//// -csv prints one line per benchmark so runs can be compared by a        ////
+//// script.                                                                ////
+//// -verify checks the fixed point SPN scaling against the float decoder,  ////
+//// the SPN status against SpnClassify() and Name arbitration against a    ////
+//// field by field compare, instead.  It exits 1 if a status or a Name     ////
+//// pair is wrong, or a field breaks its rounding rule (fields of up to 16 ////
+//// bits must match the float decoder exactly).                            ////
+////                                                                        ////
+//// Build:                                                                 ////
+////    g++ -x c++ -O2 j1939-bench.cpp -o j1939-bench                       ////
+////                                                                        ////
+//// Run:                                                                   ////
+////    ./j1939-bench                                                       ////
+////    ./j1939-bench -file truck.log -time 500 -repeat 5 -csv              ////
+////    ./j1939-bench -verify                                               ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "can-host.h"
+
+void InitJ1939Address(void);
+void InitJ1939Name(void);
+
+#define BENCH_MAX_FRAMES   4096     //most frames read from -file
+#define BENCH_BATCH        8        //frames handled per call of the receive and transmit tasks
+
+//////////////////////////////////////////////////////////////////////////////// Allocation counter
+
+uint32_t g_BenchAllocations;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)      //ASan has its own malloc
+extern "C" void *__libc_malloc(size_t Size);
+extern "C" void *__libc_calloc(size_t Count, size_t Size);
+extern "C" void *__libc_realloc(void *Ptr, size_t Size);
+
+extern "C" void *malloc(size_t Size) throw()
+{
+   g_BenchAllocations++;
+   return(__libc_malloc(Size));
+}
+
+extern "C" void *calloc(size_t Count, size_t Size) throw()
+{
+   g_BenchAllocations++;
+   return(__libc_calloc(Count,Size));
+}
+
+extern "C" void *realloc(void *Ptr, size_t Size) throw()
+{
+   g_BenchAllocations++;
+   return(__libc_realloc(Ptr,Size));
+}
+
+#define BENCH_COUNTS_ALLOCATIONS TRUE
+#else
+#define BENCH_COUNTS_ALLOCATIONS FALSE
+#endif
+
+//////////////////////////////////////////////////////////////////////////////// Tick Timer
+
+//the driver's tick only moves when the benchmark moves it, so claim timing
+//doesn't depend on how fast the PC is
+uint32_t g_BenchTick;
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Settings
+
+//Following Macros used to initialize unit's J1939 Address and Name - Required
+#define J1939InitAddress()    InitJ1939Address()
+#define J1939InitName()       InitJ1939Name()
+
+//Following define selects the host CAN driver, can-host.c
+#define USE_HOST_CAN   TRUE
+
+//Following defines/macros used to associate the benchmark tick to J1939 tick
+#define J1939GetTick()                 g_BenchTick
+#define J1939GetTickDifference(a,b)    ((uint32_t)((a) - (b)))
+#define J1939_TICKS_PER_SECOND         1000
+#define J1939_TICK_TYPE                uint32_t
+
+//Include the J1939 driver
+#include "j1939.c"
+
+//CCS types used by EX_J1939's decoders
+typedef uint8_t int8;
+typedef uint16_t int16;
+
+#define SPN_KEEP_FLOAT  TRUE        //float decoder to check and time the fixed point one against
+
+#include "EX_J1939_SPN.c"
+
+#define MY_ADDRESS      0x80
+
+//Function used to initialize this unit's J1939 Address
+void InitJ1939Address(void)
+{
+   g_MyJ1939Address = MY_ADDRESS;
+}
+
+//Function used to initialize this unit's J1939 Name
+void InitJ1939Name(void)
+{
+   J1939_NAME_FIELDS Fields;
+
+   memset(&Fields,0,sizeof(J1939_NAME_FIELDS));
+
+   Fields.IdentityNumber = 1;
+   Fields.ArbitraryAddressCapable = TRUE;
+
+   J1939BuildName(&Fields,g_J1939Name);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Traffic
+
+can_host_frame g_BenchFrames[BENCH_MAX_FRAMES];
+uint16_t g_BenchFrameCount;
+
+//engine traffic, PGN and SPN decoded from each by the decode benchmark
+const struct {
+   uint32_t ID;
+   uint8_t Data[8];
+} g_BenchSynthetic[] = {
+   {0x0CF00400, {0xF0,0x7D,0x7D,0x40,0x1A,0x00,0xF0,0x7D}},    //EEC1
+   {0x18FEF200, {0x2C,0x01,0x00,0x00,0x00,0x00,0x3C,0xFF}},    //Fuel Economy
+   {0x18FEEE00, {0x6E,0x5A,0x20,0x4E,0xFF,0xFF,0xFF,0xFF}},    //Engine Temperature 1
+   {0x18FEFC17, {0xFF,0xC8,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF}},    //Dash Display
+   {0x0CF00400, {0xF0,0x7D,0x7E,0x48,0x1A,0x00,0xF0,0x7D}},    //EEC1
+   {0x18FEF100, {0xF3,0x10,0x2C,0xC0,0x00,0x00,0x00,0x00}},    //Cruise Control/Vehicle Speed
+   {0x18FEF300, {0x10,0x27,0x4D,0x1E,0x20,0x4E,0xBE,0x6C}},    //Vehicle Position
+   {0x18EA8017, {0xEE,0xFE,0x00,0xFF,0xFF,0xFF,0xFF,0xFF}},    //Request to this unit
+};
+
+//reads a candump log, returns number of frames read
+uint16_t BenchReadLog(const char *FileName)
+{
+   FILE *File;
+   char Line[256];
+   char *p, *End;
+   uint32_t ID;
+   uint8_t Length;
+   uint16_t Count = 0;
+
+   File = fopen(FileName,"r");
+   if(File == NULL)
+      return(0);
+
+   while((Count < BENCH_MAX_FRAMES) && fgets(Line,sizeof(Line),File))
+   {
+      p = strchr(Line,'#');
+      if((p == NULL) || (p - Line < 8))
+         continue;
+
+      ID = strtoul(p - 8,&End,16);
+      if((End != p) || (p[1] == 'R'))
+         continue;                           //only extended data frames
+
+      p++;
+      Length = 0;
+      while((Length < 8) && isxdigit((uint8_t)p[0]) && isxdigit((uint8_t)p[1]))
+      {
+         sscanf(p,"%2hhx",&g_BenchFrames[Count].data[Length++]);
+         p += 2;
+      }
+
+      g_BenchFrames[Count].id = ID & 0x1FFFFFFF;
+      g_BenchFrames[Count].len = Length;
+      g_BenchFrames[Count].ext = TRUE;
+      g_BenchFrames[Count].rtr = FALSE;
+      Count++;
+   }
+
+   fclose(File);
+
+   return(Count);
+}
+
+void BenchLoadSynthetic(void)
+{
+   uint16_t i;
+
+   g_BenchFrameCount = sizeof(g_BenchSynthetic) / sizeof(g_BenchSynthetic[0]);
+
+   for(i=0;i<g_BenchFrameCount;i++)
+   {
+      g_BenchFrames[i].id = g_BenchSynthetic[i].ID;
+      memcpy(g_BenchFrames[i].data,g_BenchSynthetic[i].Data,8);
+      g_BenchFrames[i].len = 8;
+      g_BenchFrames[i].ext = TRUE;
+      g_BenchFrames[i].rtr = FALSE;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////// Benchmark CAN backend
+
+uint16_t g_BenchNextFrame;
+uint16_t g_BenchRxLeft;          //frames can_getd() may still get this pass
+uint32_t g_BenchSent;
+
+int1 BenchCanInit(void *Context)
+{
+   (void)Context;
+   return(TRUE);
+}
+
+int1 BenchCanGetd(void *Context, can_host_frame *Frame)
+{
+   (void)Context;
+
+   if(g_BenchRxLeft == 0)
+      return(FALSE);
+
+   *Frame = g_BenchFrames[g_BenchNextFrame];
+   if(++g_BenchNextFrame >= g_BenchFrameCount)
+      g_BenchNextFrame = 0;
+   g_BenchRxLeft--;
+
+   return(TRUE);
+}
+
+int1 BenchCanPutd(void *Context, can_host_frame *Frame)
+{
+   (void)Context;
+   (void)Frame;
+
+   g_BenchSent++;
+
+   return(TRUE);
+}
+
+int1 BenchCanKbhit(void *Context)
+{
+   (void)Context;
+   return(g_BenchRxLeft != 0);
+}
+
+int1 BenchCanTbe(void *Context)
+{
+   (void)Context;
+   return(TRUE);
+}
+
+const can_host_ops BenchCanOps = {
+   BenchCanInit,
+   BenchCanGetd,
+   BenchCanPutd,
+   BenchCanKbhit,
+   BenchCanTbe,
+   NULL,
+   NULL,
+   NULL,
+   NULL
+};
+
+//////////////////////////////////////////////////////////////////////////////// Benchmarks
+
+volatile uint32_t g_BenchSink;      //results go here so the compiler keeps the work
+
+//Starts the driver and claims MY_ADDRESS
+void BenchStartDriver(void)
+{
+   g_BenchRxLeft = 0;
+   g_BenchTick = 0;
+
+   can_host_set_ops(&BenchCanOps,NULL);
+   J1939Init();
+
+   J1939XmitTask();                 //sends Address Claimed
+   g_BenchTick += J1939_TICKS_PER_SECOND;
+   J1939ReceiveTask();              //no contending claim so address is claimed
+}
+
+uint32_t BenchReceive(uint32_t Batches)
+{
+   J1939_PDU_STRUCT PDU;
+   uint8_t Data[8];
+   uint8_t Length;
+   uint32_t Frames = 0;
+
+   while(Batches--)
+   {
+      g_BenchRxLeft = BENCH_BATCH;
+      J1939ReceiveTask();
+
+      while(J1939Kbhit())
+      {
+         J1939GetMessage(PDU,Data,Length);
+         g_BenchSink += Data[0];
+      }
+
+      J1939XmitTask();              //sends answers to requests in the traffic
+      Frames += BENCH_BATCH;
+   }
+
+   return(Frames);
+}
+
+uint32_t BenchTransmit(uint32_t Batches)
+{
+   J1939_PDU_STRUCT PDU;
+   uint32_t Frames = 0;
+   uint8_t i;
+
+   while(Batches--)
+   {
+      for(i=0;i<BENCH_BATCH;i++)
+      {
+         J1939IDToPDU(g_BenchFrames[g_BenchNextFrame].id,&PDU);
+         PDU.SourceAddress = g_MyJ1939Address;
+         J1939PutMessage(PDU,g_BenchFrames[g_BenchNextFrame].data,g_BenchFrames[g_BenchNextFrame].len);
+
+         if(++g_BenchNextFrame >= g_BenchFrameCount)
+            g_BenchNextFrame = 0;
+      }
+
+      J1939XmitTask();
+      Frames += BENCH_BATCH;
+   }
+
+   return(Frames);
+}
+
+//Address Claimed from addresses 0x81 to 0x90, every 16th one contends for
+//this unit's address with a larger Name, so this unit keeps its address and
+//answers it
+uint32_t BenchAddressClaim(uint32_t Batches)
+{
+   J1939_PDU_STRUCT PDU;
+   uint8_t Name[8];
+   uint32_t Frames = 0;
+   uint8_t i;
+
+   PDU.Priority = J1939_CONTROL_PRIORITY;
+   PDU.ExtendedDataPage = 0;
+   PDU.DataPage = 0;
+   PDU.PDUFormat = J1939_PF_ADDR_CLAIMED;
+   PDU.DestinationAddress = J1939_GLOBAL_ADDRESS;
+
+   memset(Name,0xFF,8);
+
+   while(Batches--)
+   {
+      for(i=0;i<BENCH_BATCH;i++)
+      {
+         PDU.SourceAddress = ((Frames + i) & 0x0F) ? (MY_ADDRESS + ((Frames + i) & 0x0F)) : MY_ADDRESS;
+         Name[0] = (Frames + i) & 0x0F;
+         J1939HandleAddressClaim(PDU,Name);
+      }
+
+      J1939XmitTask();
+      Frames += BENCH_BATCH;
+   }
+
+   return(Frames);
+}
+
+//decodes every signal of each frame, returns number of signals decoded
+uint32_t BenchDecode(uint32_t Batches)
+{
+   int16 PGN, Value;
+   uint32_t Signals = 0;
+   uint8_t i, j;
+
+   while(Batches--)
+   {
+      for(i=0;i<BENCH_BATCH;i++)
+      {
+         PGN = (g_BenchFrames[g_BenchNextFrame].id >> 8) & 0xFFFF;
+
+         for(j=0;j<SPN_TABLE_ENTRIES;j++)
+         {
+            if(g_SpnTable[j].PGN == PGN)
+            {
+               lecturaDelParametro(PGN,g_SpnTable[j].SPN,g_BenchFrames[g_BenchNextFrame].data,&Value);
+               g_BenchSink += Value;
+               Signals++;
+            }
+         }
+
+         if(++g_BenchNextFrame >= g_BenchFrameCount)
+            g_BenchNextFrame = 0;
+      }
+   }
+
+   return(Signals);
+}
+
+//scales every signal of each frame with Decode, the table row is already
+//known so only the bit extract and scaling are timed
+uint32_t BenchScaleWith(uint32_t Batches, int16_t (*Decode)(uint8_t Index, uint8_t Bytes[]))
+{
+   uint16_t PGN;
+   uint32_t Signals = 0;
+   uint8_t i, j;
+
+   while(Batches--)
+   {
+      for(i=0;i<BENCH_BATCH;i++)
+      {
+         PGN = (g_BenchFrames[g_BenchNextFrame].id >> 8) & 0xFFFF;
+
+         for(j=0;j<SPN_TABLE_ENTRIES;j++)
+         {
+            if(g_SpnTable[j].PGN == PGN)
+            {
+               g_BenchSink += Decode(j,g_BenchFrames[g_BenchNextFrame].data);
+               Signals++;
+            }
+         }
+
+         if(++g_BenchNextFrame >= g_BenchFrameCount)
+            g_BenchNextFrame = 0;
+      }
+   }
+
+   return(Signals);
+}
+
+//decodes every signal of each frame in one pass with SpnDecodePGN(), returns
+//number of signals decoded
+uint32_t BenchDecodeFrame(uint32_t Batches)
+{
+   static int16_t Values[SPN_TABLE_ENTRIES];
+   uint32_t Signals = 0;
+   uint8_t i;
+
+   while(Batches--)
+   {
+      for(i=0;i<BENCH_BATCH;i++)
+      {
+         Signals += SpnDecodePGN((g_BenchFrames[g_BenchNextFrame].id >> 8) & 0xFFFF,g_BenchFrames[g_BenchNextFrame].data,Values);
+
+         if(++g_BenchNextFrame >= g_BenchFrameCount)
+            g_BenchNextFrame = 0;
+      }
+      g_BenchSink += Values[0];
+   }
+
+   return(Signals);
+}
+
+//decodes every signal of each frame into the SPN value store with
+//SpnStorePGN(), returns number of signals stored
+uint32_t BenchStoreFrame(uint32_t Batches)
+{
+   uint32_t Signals = 0;
+   uint8_t i;
+
+   while(Batches--)
+   {
+      for(i=0;i<BENCH_BATCH;i++)
+      {
+         Signals += SpnStorePGN((g_BenchFrames[g_BenchNextFrame].id >> 8) & 0xFFFF,g_BenchFrames[g_BenchNextFrame].data);
+
+         if(++g_BenchNextFrame >= g_BenchFrameCount)
+            g_BenchNextFrame = 0;
+      }
+   }
+
+   return(Signals);
+}
+
+uint32_t BenchScale(uint32_t Batches)
+{
+   return(BenchScaleWith(Batches,SpnDecode));
+}
+
+uint32_t BenchScaleFloat(uint32_t Batches)
+{
+   return(BenchScaleWith(Batches,SpnDecodeFloat));
+}
+
+//////////////////////////////////////////////////////////////////////////////// Verify
+
+uint32_t g_BenchRandom = 1;
+
+uint32_t BenchRandom(void)
+{
+   g_BenchRandom ^= g_BenchRandom << 13;
+   g_BenchRandom ^= g_BenchRandom >> 17;
+   g_BenchRandom ^= g_BenchRandom << 5;
+
+   return(g_BenchRandom);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//BenchVerifyStatus()
+// Checks SpnFrameFlags() byte by byte, and the status SpnStorePGN() gives
+// each row against SpnClassify() and the row's range, on random messages
+// with many bytes in the reserved range.
+//  Parameters: None
+//  Returns:    Number of messages with a wrong flag or status
+////////////////////////////////////////////////////////////////////////////////
+uint32_t BenchVerifyStatus(void)
+{
+   uint8_t Bytes[8], Reserved, NotAvailable, Status, i, j;
+   uint32_t Frame, Raw, Differ = 0;
+   int16_t Value;
+
+   for(Frame=0;Frame<0x10000;Frame++)
+   {
+      for(i=0;i<8;i++)
+         Bytes[i] = (BenchRandom() & 1) ? 0xF8 + (BenchRandom() & 7) : BenchRandom();
+
+      SpnFrameFlags(Bytes,Reserved,NotAvailable);
+
+      for(i=0;i<8;i++)
+      {
+         if((((Reserved >> i) & 1) != (Bytes[i] >= 0xFB)) || (((NotAvailable >> i) & 1) != (Bytes[i] == 0xFF)))
+         {
+            Differ++;
+            break;
+         }
+      }
+
+      i = Frame % SPN_TABLE_ENTRIES;
+      SpnStorePGN(g_SpnTable[i].PGN,Bytes);
+
+      for(j=SpnFindPGN(g_SpnTable[i].PGN);(j < SPN_TABLE_ENTRIES) && (g_SpnTable[j].PGN == g_SpnTable[i].PGN);j++)
+      {
+         Raw = SpnRaw(Bytes,g_SpnTable[j].StartBit,g_SpnTable[j].Length);
+         Status = SpnClassify(Raw,g_SpnTable[j].Length);
+         Value = SpnValue(j,Raw);
+         if((Status == SPN_VALID) && ((Value < g_SpnTable[j].Min) || (Value > g_SpnTable[j].Max)))
+            Status = SPN_ERROR;
+
+         if(g_SpnStore[j].Status != Status)
+         {
+            Differ++;
+            break;
+         }
+      }
+   }
+
+   return(Differ);
+}
+
+
+//Reference Name compare, field by field from the 8 bytes in J1939-81's order
+//of priority.  Returns <0 if Name a has priority, 0 if equal, >0 if b does.
+int BenchCompareNameFields(uint8_t *a, uint8_t *b)
+{
+   uint32_t Fields[2][10];
+   uint8_t *Name;
+   uint8_t n, f;
+
+   for(n=0;n<2;n++)
+   {
+      Name = n ? b : a;
+      Fields[n][0] = Name[7] >> 7;                                                      //Arbitrary Address Capable
+      Fields[n][1] = (Name[7] >> 4) & 0x07;                                             //Industry Group
+      Fields[n][2] = Name[7] & 0x0F;                                                    //Vehicle System Instance
+      Fields[n][3] = Name[6] >> 1;                                                      //Vehicle System
+      Fields[n][4] = Name[6] & 0x01;                                                    //reserved
+      Fields[n][5] = Name[5];                                                           //Function
+      Fields[n][6] = Name[4] >> 3;                                                      //Function Instance
+      Fields[n][7] = Name[4] & 0x07;                                                    //ECU Instance
+      Fields[n][8] = ((uint32_t)Name[3] << 3) | (Name[2] >> 5);                         //Manufacturer Code
+      Fields[n][9] = ((uint32_t)(Name[2] & 0x1F) << 16) | ((uint32_t)Name[1] << 8) | Name[0];  //Identity Number
+   }
+
+   for(f=0;f<10;f++)
+   {
+      if(Fields[0][f] != Fields[1][f])
+         return((Fields[0][f] < Fields[1][f]) ? -1 : 1);
+   }
+
+   return(0);
+}
+
+#define BENCH_NAMES     2048
+
+////////////////////////////////////////////////////////////////////////////////
+//BenchVerifyNames()
+// Checks Name arbitration, J1939CompareName() on packed Names, against
+// BenchCompareNameFields() for every pair of BENCH_NAMES random Names.  Half
+// are built by J1939BuildName() from random fields, which are checked to come
+// back out of the bytes, and half are random bytes.  Fields are drawn from a
+// few values so most pairs tie on the higher fields and are decided lower
+// down.
+//  Parameters: None
+//  Returns:    Number of Names built wrong plus pairs compared wrong
+////////////////////////////////////////////////////////////////////////////////
+uint32_t BenchVerifyNames(void)
+{
+   static uint8_t Names[BENCH_NAMES][8];
+   J1939_NAME_FIELDS Fields;
+   uint32_t Wrong = 0, i, j;
+   uint8_t b;
+
+   for(i=0;i<BENCH_NAMES;i++)
+   {
+      if(i & 1)
+      {
+         for(b=0;b<8;b++)
+            Names[i][b] = (BenchRandom() & 1) ? 0x5A + b : BenchRandom();     //common value so bytes tie
+         continue;
+      }
+
+      Fields.ArbitraryAddressCapable = BenchRandom() & 1;
+      Fields.IndustryGroup = BenchRandom() & 1;
+      Fields.VehicleSystemInstance = BenchRandom() & 3;
+      Fields.VehicleSystem = 0x7E + (BenchRandom() & 1);
+      Fields.Function = BenchRandom() & 3;
+      Fields.FunctionInstance = 0x1E + (BenchRandom() & 1);
+      Fields.EcuInstance = BenchRandom() & 7;
+      Fields.ManufacturerCode = 0x7FE + (BenchRandom() & 1);
+      Fields.IdentityNumber = (BenchRandom() & 1) ? 0x1FFFFF - (BenchRandom() & 3) : BenchRandom() & 3;
+
+      J1939BuildName(&Fields,Names[i]);
+
+      if(((Names[i][7] >> 7) != Fields.ArbitraryAddressCapable) || (((Names[i][7] >> 4) & 7) != Fields.IndustryGroup) ||
+         ((Names[i][7] & 0x0F) != Fields.VehicleSystemInstance) || ((Names[i][6] >> 1) != Fields.VehicleSystem) ||
+         (Names[i][6] & 1) || (Names[i][5] != Fields.Function) || ((Names[i][4] >> 3) != Fields.FunctionInstance) ||
+         ((Names[i][4] & 7) != Fields.EcuInstance) || ((((uint16_t)Names[i][3] << 3) | (Names[i][2] >> 5)) != Fields.ManufacturerCode) ||
+         ((((uint32_t)(Names[i][2] & 0x1F) << 16) | ((uint32_t)Names[i][1] << 8) | Names[i][0]) != Fields.IdentityNumber))
+         Wrong++;
+   }
+
+   for(i=0;i<BENCH_NAMES;i++)
+   {
+      J1939PackName(Names[i],&g_J1939PackedName);
+
+      for(j=0;j<BENCH_NAMES;j++)
+      {
+         if(J1939CompareName(Names[j]) != (BenchCompareNameFields(Names[i],Names[j]) <= 0))
+            Wrong++;
+      }
+   }
+
+   J1939PackName(g_J1939Name,&g_J1939PackedName);
+
+   return(Wrong);
+}
+
+
+//Checks a difference between the fixed point and float decoders of row Index
+//keeps to the rounding rule for fields over 16 bits (see EX_J1939_SPN.c), 1
+//further from zero and only within the row's rounding error of a whole number
+int1 BenchVerifyRule(uint8_t Index, uint64_t Raw, int Fixed, int Float)
+{
+   double Value, Error;
+
+   if(abs(Fixed) != abs(Float) + 1)
+      return(FALSE);
+
+   Value = Raw * (double)g_SpnTable[Index].Resolution + g_SpnTable[Index].Offset;
+   Error = (ldexp(g_SpnTable[Index].Mult,-g_SpnTable[Index].Shift) - g_SpnTable[Index].Resolution) * ldexp(1,g_SpnTable[Index].Length);
+
+   return(abs(Fixed) - fabs(Value) <= Error + 0.0001);   //float resolution isn't exact, allow for it
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//BenchVerify()
+// Checks the fixed point decoder, SpnDecode(), against the float one,
+// SpnDecodeFloat(), for each row of g_SpnTable[].  Fields up to 16 bits are
+// checked for every raw value and must match, wider fields for 65536 values
+// spread over their range and must keep to BenchVerifyRule().  Also checks the rows are sorted by PGN and there's a slot
+// for each, the not available and error status with BenchVerifyStatus()
+// and Name arbitration with BenchVerifyNames().
+//  Parameters: None
+//  Returns:    Number of rows out of order, that don't match or that break
+//              the rounding rule
+////////////////////////////////////////////////////////////////////////////////
+int BenchVerify(void)
+{
+   uint8_t Bytes[8];
+   uint64_t Raw, Values, Step, Field;
+   uint32_t Differ, Broken;
+   int Fixed, Float, Largest, Failed = 0;
+   uint8_t i, Bit;
+
+   if(SPN_SLOTS != SPN_TABLE_ENTRIES)
+   {
+      printf("%u slots for %u rows of g_SpnTable[]\n",SPN_SLOTS,(unsigned)SPN_TABLE_ENTRIES);
+      Failed++;
+   }
+
+   printf("%-6s %-5s %-4s %12s %10s %10s %10s\n","pgn","spn","bits","values","differ","largest","off rule");
+
+   for(i=0;i<SPN_TABLE_ENTRIES;i++)
+   {
+      if((i > 0) && (g_SpnTable[i].PGN < g_SpnTable[i - 1].PGN))
+      {
+         printf("row %u PGN %04X is out of order, g_SpnTable[] must be sorted by PGN\n",i,g_SpnTable[i].PGN);
+         Failed++;
+      }
+
+      Values = (uint64_t)1 << g_SpnTable[i].Length;
+      Step = (Values > 0x10000) ? (Values >> 16) : 1;
+      Differ = 0;
+      Broken = 0;
+      Largest = 0;
+
+      for(Raw=0;Raw<Values;Raw+=Step)
+      {
+         Field = Raw + ((Step > 1) ? Raw % Step : 0);     //don't only test multiples of Step
+         memset(Bytes,0,sizeof(Bytes));
+         for(Bit=0;Bit<g_SpnTable[i].Length;Bit++)
+         {
+            if((Field >> Bit) & 1)
+               Bytes[(g_SpnTable[i].StartBit + Bit) >> 3] |= 1 << ((g_SpnTable[i].StartBit + Bit) & 7);
+         }
+
+         Fixed = SpnDecode(i,Bytes);
+         Float = SpnDecodeFloat(i,Bytes);
+
+         if(Fixed != Float)
+         {
+            Differ++;
+            if(abs(Fixed - Float) > Largest)
+               Largest = abs(Fixed - Float);
+            if((g_SpnTable[i].Length <= 16) || !BenchVerifyRule(i,Field,Fixed,Float))
+               Broken++;
+         }
+      }
+
+      printf("%04X   %-5u %-4u %12llu %10u %10d %10u\n",g_SpnTable[i].PGN,g_SpnTable[i].SPN,g_SpnTable[i].Length,
+             (unsigned long long)(Values / Step),Differ,Largest,Broken);
+
+      if(Broken)
+         Failed++;
+   }
+
+   Differ = BenchVerifyStatus();
+   printf("status of 65536 random messages, %u wrong\n",Differ);
+   if(Differ)
+      Failed++;
+
+   Differ = BenchVerifyNames();
+   printf("Name arbitration, %u pairs of Names, %u wrong\n",BENCH_NAMES * BENCH_NAMES,Differ);
+   if(Differ)
+      Failed++;
+
+   return(Failed);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Run
+
+uint64_t BenchNow(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC,&ts);
+
+   return((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+typedef struct _BENCH_STRUCT {
+   const char *Name;
+   const char *Unit;
+   uint32_t (*Run)(uint32_t Batches);
+} BENCH_STRUCT;
+
+const BENCH_STRUCT g_Benchmarks[] = {
+   {"receive",       "frame",  BenchReceive},
+   {"transmit",      "frame",  BenchTransmit},
+   {"address_claim", "frame",  BenchAddressClaim},
+   {"decode",        "signal", BenchDecode},
+   {"decode_frame",  "signal", BenchDecodeFrame},
+   {"store_frame",   "signal", BenchStoreFrame},
+   {"scale",         "signal", BenchScale},
+   {"scale_float",   "signal", BenchScaleFloat},
+};
+
+int main(int argc, char *argv[])
+{
+   const char *FileName = NULL;
+   uint32_t TimeMs = 200, Repeat = 3, Batches, Items, Allocations, BestItems, r;
+   uint64_t Start, Elapsed, BestElapsed;
+   double NsPerItem;
+   int Csv = 0, i;
+
+   for(i=1;i<argc;i++)
+   {
+      if((i + 1 < argc) && !strcmp(argv[i],"-file"))
+         FileName = argv[++i];
+      else if((i + 1 < argc) && !strcmp(argv[i],"-time"))
+         TimeMs = strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-repeat"))
+         Repeat = strtoul(argv[++i],NULL,0);
+      else if(!strcmp(argv[i],"-csv"))
+         Csv = 1;
+      else if(!strcmp(argv[i],"-verify"))
+         return(BenchVerify() ? 1 : 0);
+      else
+      {
+         fprintf(stderr,"unknown option %s\n",argv[i]);
+         return(2);
+      }
+   }
+
+   if(FileName != NULL)
+   {
+      g_BenchFrameCount = BenchReadLog(FileName);
+      if(g_BenchFrameCount == 0)
+      {
+         fprintf(stderr,"no frames read from %s\n",FileName);
+         return(2);
+      }
+   }
+   else
+      BenchLoadSynthetic();
+
+   if(Repeat == 0)
+      Repeat = 1;
+
+   if(Csv)
+      printf("benchmark,traffic,unit,items,ns_per_item,items_per_s,allocations\n");
+   else
+      printf("%-14s %-10s %-7s %12s %12s %14s %12s\n","benchmark","traffic","unit","items","ns/item","items/s","allocations");
+
+   for(i=0;i<(int)(sizeof(g_Benchmarks)/sizeof(g_Benchmarks[0]));i++)
+   {
+      BenchStartDriver();
+      g_BenchNextFrame = 0;
+
+      //find the number of batches that takes about TimeMs
+      Batches = 1;
+      do
+      {
+         Batches *= 2;
+         Start = BenchNow();
+         g_Benchmarks[i].Run(Batches);
+         Elapsed = BenchNow() - Start;
+      } while((Elapsed < (uint64_t)TimeMs * 1000000 / 8) && (Batches < 0x10000000));
+      Batches = (uint32_t)((uint64_t)Batches * TimeMs * 1000000 / (Elapsed ? Elapsed : 1));
+      if(Batches == 0)
+         Batches = 1;
+
+      BestElapsed = ~0ULL;
+      BestItems = 0;
+      Allocations = 0;
+
+      for(r=0;r<Repeat;r++)
+      {
+         g_BenchAllocations = 0;
+         Start = BenchNow();
+         Items = g_Benchmarks[i].Run(Batches);
+         Elapsed = BenchNow() - Start;
+         Allocations += g_BenchAllocations;
+
+         if((uint64_t)Elapsed * BestItems < (uint64_t)BestElapsed * Items || (BestItems == 0))
+         {
+            BestElapsed = Elapsed;
+            BestItems = Items;
+         }
+      }
+
+      NsPerItem = BestItems ? (double)BestElapsed / BestItems : 0;
+
+      if(Csv)
+      {
+         printf("%s,%s,%s,%u,%.2f,%.0f,",g_Benchmarks[i].Name,FileName ? FileName : "synthetic",g_Benchmarks[i].Unit,
+                BestItems,NsPerItem,NsPerItem ? 1e9 / NsPerItem : 0);
+         if(BENCH_COUNTS_ALLOCATIONS)
+            printf("%u\n",Allocations);
+         else
+            printf("\n");
+      }
+      else
+      {
+         printf("%-14s %-10.10s %-7s %12u %12.2f %14.0f ",g_Benchmarks[i].Name,FileName ? FileName : "synthetic",g_Benchmarks[i].Unit,
+                BestItems,NsPerItem,NsPerItem ? 1e9 / NsPerItem : 0);
+         if(BENCH_COUNTS_ALLOCATIONS)
+            printf("%12u\n",Allocations);
+         else
+            printf("%12s\n","not counted");
+      }
+   }
+
+   return(0);
+}
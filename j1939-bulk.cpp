@@ -0,0 +1,823 @@
+////////////////////////////////////////////////////////////////////////////////
+////                             j1939-bulk.cpp                             ////
+////                                                                        ////
+//// Decodes long J1939 captures on a PC, every SPN of g_SpnTable[]         ////
+//// (EX_J1939_SPN.c) in every frame, into one array per SPN.  Status and   ////
+//// values are the same SpnStorePGN() gives, -verify checks it.            ////
+////                                                                        ////
+//// The capture is a binary frame log, memory mapped, of 16 byte records,  ////
+//// little endian:                                                         ////
+////    uint32 time    ms since the start of the capture                    ////
+////    uint32 id      29 bit CAN identifier                                ////
+////    uint8  data[8] frames shorter than 8 bytes padded with 0xFF         ////
+//// j1939-replay -bin writes one from a candump, ASC or TRC capture.       ////
+////                                                                        ////
+//// The log is decoded in chunks of -chunk frames, one thread per chunk.   ////
+//// Each chunk's frames are grouped by PGN, their payloads copied together ////
+//// so each SPN is decoded by one kernel over a contiguous array: shift,   ////
+//// mask, reserved value compares and fixed point scale, 8 frames at a     ////
+//// time with AVX2 when it's built with it, 4 with SSE2 (any x86-64        ////
+//// build), 1 at a time otherwise.                                         ////
+////                                                                        ////
+//// -o dir appends the columns, raw arrays in frame order for each PGN:    ////
+////    pgnFEEE.time    uint32 per frame of the PGN                         ////
+////    pgnFEEE.source  uint8 source address per frame of the PGN           ////
+////    spn110.value    int16 per frame of the SPN's PGN                    ////
+////    spn110.status   uint8 per frame, SPN_VALID, SPN_ERROR, ...          ////
+////                                                                        ////
+//// Build:                                                                 ////
+////    g++ -x c++ -O2 -march=native -pthread j1939-bulk.cpp -o j1939-bulk  ////
+////                                                                        ////
+//// Run:                                                                   ////
+////    ./j1939-replay -bin truck.bin truck.log                             ////
+////    ./j1939-bulk -o truck truck.bin                                     ////
+////    ./j1939-bulk -make 100000000 synthetic.bin                          ////
+////    ./j1939-bulk -threads 1 -verify synthetic.bin                       ////
+////                                                                        ////
+//// Options:                                                               ////
+////    -o dir  -threads N (default all cores)  -chunk frames               ////
+////    -verify compare every frame with SpnStorePGN()                      ////
+////    -make N write a synthetic log of N frames and exit                  ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifndef TRUE
+#define TRUE   1
+#define FALSE  0
+#endif
+
+#define BULK_CHUNK_FRAMES  (1 << 20)      //default frames per chunk
+#define BULK_MAX_THREADS   64
+
+//////////////////////////////////////////////////////////////////////////////// Decoders
+
+//what EX_J1939_SPN.c needs from the J1939 driver and CCS, the tick is only
+//used by the store -verify compares against
+#define J1939_TICK_TYPE                uint32_t
+#define J1939_TICKS_PER_SECOND         1000
+#define J1939GetTick()                 ((uint32_t)0)
+#define J1939GetTickDifference(a,b)    ((uint32_t)((a) - (b)))
+#define J1939ProfileStart(probe)
+#define J1939ProfileStop(probe)
+
+typedef uint8_t int8;
+typedef uint16_t int16;
+
+#include "EX_J1939_SPN.c"
+
+//////////////////////////////////////////////////////////////////////////////// Log
+
+typedef struct _BULK_FRAME {
+   uint32_t Time;          //ms
+   uint32_t ID;
+   uint8_t Data[8];
+} BULK_FRAME;
+
+#define BULK_NO_GROUP      0xFF
+
+//a PGN of the table, its rows are FirstRow to FirstRow + Rows - 1
+typedef struct _BULK_GROUP {
+   uint16_t PGN;
+   uint8_t FirstRow;
+   uint8_t Rows;
+} BULK_GROUP;
+
+BULK_GROUP g_BulkGroups[SPN_PGNS];
+
+//raw value limits of each row, from J1939-71's reserved ranges the same way
+//SpnClassify() and SpnFrameFlags() find them.  A field is SPN_NOT_AVAILABLE
+//from NotAvailableFrom up and SPN_ERROR from ErrorFrom up, 1 bit fields never.
+typedef struct _BULK_ROW {
+   uint64_t Mask;
+   uint64_t ErrorFrom;
+   uint64_t NotAvailableFrom;
+   uint8_t Group;
+} BULK_ROW;
+
+BULK_ROW g_BulkRows[SPN_SLOTS];
+
+#define BULK_NEVER   ((uint64_t)1 << 40)     //above any 32 bit raw value
+
+void BulkInit(void)
+{
+   uint8_t i, Group = 0, Length;
+   uint64_t Largest;
+
+   for(i=0;i<SPN_SLOTS;i++)
+   {
+      if((i > 0) && (g_SpnTable[i].PGN != g_SpnTable[i - 1].PGN))
+         Group++;
+
+      if((i == 0) || (g_SpnTable[i].PGN != g_SpnTable[i - 1].PGN))
+      {
+         g_BulkGroups[Group].PGN = g_SpnTable[i].PGN;
+         g_BulkGroups[Group].FirstRow = i;
+         g_BulkGroups[Group].Rows = 0;
+      }
+      g_BulkGroups[Group].Rows++;
+
+      Length = g_SpnTable[i].Length;
+      Largest = ((uint64_t)1 << Length) - 1;
+
+      g_BulkRows[i].Mask = Largest;
+      g_BulkRows[i].Group = Group;
+
+      if(Length >= 8)
+      {
+         g_BulkRows[i].ErrorFrom = (uint64_t)0xFB << (Length - 8);
+         g_BulkRows[i].NotAvailableFrom = (uint64_t)0xFF << (Length - 8);
+      }
+      else if(Length >= 2)
+      {
+         g_BulkRows[i].ErrorFrom = (Length >= 4) ? Largest - 4 : Largest - 1;
+         g_BulkRows[i].NotAvailableFrom = Largest;
+      }
+      else
+      {
+         g_BulkRows[i].ErrorFrom = BULK_NEVER;
+         g_BulkRows[i].NotAvailableFrom = BULK_NEVER;
+      }
+   }
+}
+
+//Returns the group of a frame's PGN, or BULK_NO_GROUP if the table doesn't
+//decode it
+uint8_t BulkGroup(uint32_t ID)
+{
+   uint8_t Pf, Row;
+
+   if(ID & 0x03000000)
+      return(BULK_NO_GROUP);       //data page or extended data page, table PGNs have neither
+
+   Pf = ID >> 16;
+   Row = SpnFindPGN(((uint16_t)Pf << 8) | ((Pf >= 240) ? (uint8_t)(ID >> 8) : 0));
+
+   return((Row == SPN_NOT_FOUND) ? BULK_NO_GROUP : g_BulkRows[Row].Group);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Kernels
+
+//Decodes row Row of g_SpnTable[] from Count payloads, each 8 data bytes
+//loaded little endian, into Values[] and Status[].  Same results as
+//SpnStorePGN(): value scaled as SpnValue() does, status from the reserved
+//ranges then Min and Max.
+void BulkDecodeRow(uint8_t Row, const uint64_t *Data, uint32_t Count, int16_t *Values, uint8_t *Status)
+{
+   const SPN_STRUCT *Spn = &g_SpnTable[Row];
+   const BULK_ROW *Limits = &g_BulkRows[Row];
+   uint64_t Raw, Scaled;
+   int64_t Difference;
+   int16_t Value;
+   uint32_t j = 0;
+
+  #if defined(__AVX2__)
+   const __m128i StartBit = _mm_cvtsi32_si128(Spn->StartBit);
+   const __m128i Shift = _mm_cvtsi32_si128(Spn->Shift);
+   const __m256i Mask = _mm256_set1_epi64x(Limits->Mask);
+   const __m256i ErrorBelow = _mm256_set1_epi64x(Limits->ErrorFrom - 1);
+   const __m256i NotAvailableBelow = _mm256_set1_epi64x(Limits->NotAvailableFrom - 1);
+   const __m256i OffsetRaw = _mm256_set1_epi64x(Spn->OffsetRaw);
+   const __m256i Mult = _mm256_set1_epi64x(Spn->Mult);
+   const __m256i Min = _mm256_set1_epi32(Spn->Min);
+   const __m256i Max = _mm256_set1_epi32(Spn->Max);
+   const __m256i Low32 = _mm256_setr_epi32(0,2,4,6,1,3,5,7);
+   const __m256i Zero = _mm256_setzero_si256();
+   const __m256i One = _mm256_set1_epi32(1);
+   __m256i Lanes[2], Error[2], NotAvailable[2], Negative, Value32, Error32, NotAvailable32, Status32, Packed;
+   uint8_t h;
+
+   for(;j + 8 <= Count;j+=8)
+   {
+      //4 frames per 64 bit lane half, raw values are at most 32 bits so the
+      //signed 64 bit compares are safe
+      for(h=0;h<2;h++)
+      {
+         Lanes[h] = _mm256_loadu_si256((const __m256i *)(Data + j + h * 4));
+         Lanes[h] = _mm256_and_si256(_mm256_srl_epi64(Lanes[h],StartBit),Mask);
+
+         Error[h] = _mm256_cmpgt_epi64(Lanes[h],ErrorBelow);
+         NotAvailable[h] = _mm256_cmpgt_epi64(Lanes[h],NotAvailableBelow);
+
+         //(raw - OffsetRaw) * Mult >> Shift on the magnitude, like SpnValue()
+         Lanes[h] = _mm256_sub_epi64(Lanes[h],OffsetRaw);
+         Negative = _mm256_cmpgt_epi64(Zero,Lanes[h]);
+         Lanes[h] = _mm256_sub_epi64(_mm256_xor_si256(Lanes[h],Negative),Negative);
+         Lanes[h] = _mm256_srl_epi64(_mm256_mul_epu32(Lanes[h],Mult),Shift);
+         Lanes[h] = _mm256_sub_epi64(_mm256_xor_si256(Lanes[h],Negative),Negative);
+      }
+
+      //low 32 bits of the 8 lanes, values cut to int16_t as the store keeps them
+      Value32 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(Lanes[0],Low32))),
+                                        _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(Lanes[1],Low32)),1);
+      Value32 = _mm256_srai_epi32(_mm256_slli_epi32(Value32,16),16);
+      Error32 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(Error[0],Low32))),
+                                        _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(Error[1],Low32)),1);
+      NotAvailable32 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(NotAvailable[0],Low32))),
+                                               _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(NotAvailable[1],Low32)),1);
+
+      //not available is also past the error limit, so the masks (-1) add up
+      //to SPN_VALID 1, SPN_ERROR 2 or SPN_NOT_AVAILABLE 3
+      Error32 = _mm256_or_si256(Error32,_mm256_or_si256(_mm256_cmpgt_epi32(Min,Value32),_mm256_cmpgt_epi32(Value32,Max)));
+      Status32 = _mm256_sub_epi32(_mm256_sub_epi32(One,Error32),NotAvailable32);
+
+      Packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(Value32,Value32),_MM_SHUFFLE(3,1,2,0));
+      _mm_storeu_si128((__m128i *)(Values + j),_mm256_castsi256_si128(Packed));
+
+      Packed = _mm256_packus_epi16(_mm256_packs_epi32(Status32,Status32),Zero);
+      Packed = _mm256_permutevar8x32_epi32(Packed,_mm256_setr_epi32(0,4,1,1,1,1,1,1));
+      _mm_storel_epi64((__m128i *)(Status + j),_mm256_castsi256_si128(Packed));
+   }
+  #elif defined(__SSE2__)
+   //SSE2 has no 64 bit compare.  Raw values are at most 32 bits, so the
+   //reserved ranges are compared on the low 32 bits, biased by 0x80000000 to
+   //compare unsigned.  Limits past 32 bits are never reached.
+   const __m128i StartBit = _mm_cvtsi32_si128(Spn->StartBit);
+   const __m128i Shift = _mm_cvtsi32_si128(Spn->Shift);
+   const __m128i Mask = _mm_set1_epi64x(Limits->Mask);
+   const __m128i Bias = _mm_set1_epi32((int)0x80000000);
+   const __m128i ErrorBelow = _mm_set1_epi32((int)((Limits->ErrorFrom > 0xFFFFFFFF) ? 0x7FFFFFFF : (uint32_t)(Limits->ErrorFrom - 1) ^ 0x80000000));
+   const __m128i NotAvailableBelow = _mm_set1_epi32((int)((Limits->NotAvailableFrom > 0xFFFFFFFF) ? 0x7FFFFFFF : (uint32_t)(Limits->NotAvailableFrom - 1) ^ 0x80000000));
+   const __m128i OffsetRaw = _mm_set1_epi64x(Spn->OffsetRaw);
+   const __m128i Mult = _mm_set1_epi64x(Spn->Mult);
+   const __m128i Min = _mm_set1_epi32(Spn->Min);
+   const __m128i Max = _mm_set1_epi32(Spn->Max);
+   const __m128i One = _mm_set1_epi32(1);
+   __m128i Lanes[2], Raw32, Negative, Value32, Error32, NotAvailable32, Status32;
+   uint32_t Status4;
+   uint8_t h;
+
+   for(;j + 4 <= Count;j+=4)
+   {
+      //2 frames per 64 bit lane half, scaled the same way as the AVX2 kernel
+      for(h=0;h<2;h++)
+      {
+         Lanes[h] = _mm_loadu_si128((const __m128i *)(Data + j + h * 2));
+         Lanes[h] = _mm_and_si128(_mm_srl_epi64(Lanes[h],StartBit),Mask);
+      }
+
+      //low 32 bits of the 4 raw values
+      Raw32 = _mm_unpacklo_epi64(_mm_shuffle_epi32(Lanes[0],_MM_SHUFFLE(3,1,2,0)),_mm_shuffle_epi32(Lanes[1],_MM_SHUFFLE(3,1,2,0)));
+      Raw32 = _mm_xor_si128(Raw32,Bias);
+      Error32 = _mm_cmpgt_epi32(Raw32,ErrorBelow);
+      NotAvailable32 = _mm_cmpgt_epi32(Raw32,NotAvailableBelow);
+
+      //(raw - OffsetRaw) * Mult >> Shift on the magnitude, like SpnValue(),
+      //the sign of each 64 bit lane is copied from its high half
+      for(h=0;h<2;h++)
+      {
+         Lanes[h] = _mm_sub_epi64(Lanes[h],OffsetRaw);
+         Negative = _mm_shuffle_epi32(_mm_srai_epi32(Lanes[h],31),_MM_SHUFFLE(3,3,1,1));
+         Lanes[h] = _mm_sub_epi64(_mm_xor_si128(Lanes[h],Negative),Negative);
+         Lanes[h] = _mm_srl_epi64(_mm_mul_epu32(Lanes[h],Mult),Shift);
+         Lanes[h] = _mm_sub_epi64(_mm_xor_si128(Lanes[h],Negative),Negative);
+      }
+
+      //low 32 bits of the 4 lanes, values cut to int16_t as the store keeps them
+      Value32 = _mm_unpacklo_epi64(_mm_shuffle_epi32(Lanes[0],_MM_SHUFFLE(3,1,2,0)),_mm_shuffle_epi32(Lanes[1],_MM_SHUFFLE(3,1,2,0)));
+      Value32 = _mm_srai_epi32(_mm_slli_epi32(Value32,16),16);
+
+      //masks (-1) add up to SPN_VALID 1, SPN_ERROR 2 or SPN_NOT_AVAILABLE 3
+      Error32 = _mm_or_si128(Error32,_mm_or_si128(_mm_cmplt_epi32(Value32,Min),_mm_cmpgt_epi32(Value32,Max)));
+      Status32 = _mm_sub_epi32(_mm_sub_epi32(One,Error32),NotAvailable32);
+
+      _mm_storel_epi64((__m128i *)(Values + j),_mm_packs_epi32(Value32,Value32));
+
+      Status4 = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(Status32,Status32),Status32));
+      memcpy(Status + j,&Status4,4);
+   }
+  #endif
+
+   for(;j<Count;j++)
+   {
+      Raw = (Data[j] >> Spn->StartBit) & Limits->Mask;
+
+      Difference = (int64_t)Raw - Spn->OffsetRaw;
+      Scaled = ((uint64_t)((Difference < 0) ? -Difference : Difference) * Spn->Mult) >> Spn->Shift;
+      Value = (int16_t)((Difference < 0) ? -(int64_t)Scaled : (int64_t)Scaled);
+      Values[j] = Value;
+
+      if(Raw >= Limits->NotAvailableFrom)
+         Status[j] = SPN_NOT_AVAILABLE;
+      else if((Raw >= Limits->ErrorFrom) || (Value < Spn->Min) || (Value > Spn->Max))
+         Status[j] = SPN_ERROR;
+      else
+         Status[j] = SPN_VALID;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////// Chunks
+
+//one chunk of the log and its decoded columns.  Columns are laid out by
+//group, group g's frames are Start[g] to Start[g] + Frames[g] - 1 of Data[],
+//Time[], Source[] and of each of its rows' Values[] and Status[].
+typedef struct _BULK_CHUNK {
+   const BULK_FRAME *Frames;
+   uint32_t Count;
+   uint32_t Size;                   //frames the buffers hold
+
+   uint8_t *Group;
+   uint64_t *Data;
+   uint32_t *Time;
+   uint8_t *Source;
+   int16_t *Values[SPN_SLOTS];
+   uint8_t *Status[SPN_SLOTS];
+
+   uint32_t Start[SPN_PGNS];
+   uint32_t GroupFrames[SPN_PGNS];
+   uint32_t Skipped;                //frames of PGNs the table doesn't decode
+   uint32_t Counts[SPN_SLOTS][SPN_STALE];    //values of each status
+   uint64_t Nanoseconds;            //time the thread spent
+} BULK_CHUNK;
+
+uint64_t BulkNow(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC,&ts);
+
+   return((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+void *BulkAllocate(size_t Size)
+{
+   void *p = malloc(Size ? Size : 1);
+
+   if(p == NULL)
+   {
+      fprintf(stderr,"out of memory\n");
+      exit(2);
+   }
+
+   return(p);
+}
+
+void BulkChunkAllocate(BULK_CHUNK *Chunk, uint32_t Size)
+{
+   uint8_t i;
+
+   memset(Chunk,0,sizeof(BULK_CHUNK));
+   Chunk->Size = Size;
+   Chunk->Group = (uint8_t *)BulkAllocate(Size);
+   Chunk->Data = (uint64_t *)BulkAllocate((size_t)Size * sizeof(uint64_t));
+   Chunk->Time = (uint32_t *)BulkAllocate((size_t)Size * sizeof(uint32_t));
+   Chunk->Source = (uint8_t *)BulkAllocate(Size);
+
+   for(i=0;i<SPN_SLOTS;i++)
+   {
+      Chunk->Values[i] = (int16_t *)BulkAllocate((size_t)Size * sizeof(int16_t));
+      Chunk->Status[i] = (uint8_t *)BulkAllocate(Size);
+   }
+}
+
+void BulkChunkFree(BULK_CHUNK *Chunk)
+{
+   uint8_t i;
+
+   free(Chunk->Group);
+   free(Chunk->Data);
+   free(Chunk->Time);
+   free(Chunk->Source);
+
+   for(i=0;i<SPN_SLOTS;i++)
+   {
+      free(Chunk->Values[i]);
+      free(Chunk->Status[i]);
+   }
+}
+
+//Groups a chunk's frames by PGN, keeping their order, then decodes each row
+//of the table over its group's payloads.  Runs on its own thread.
+void *BulkChunkTask(void *Context)
+{
+   BULK_CHUNK *Chunk = (BULK_CHUNK *)Context;
+   const BULK_FRAME *Frame;
+   uint32_t Next[SPN_PGNS], i, Position, Valid, Error;
+   uint64_t Start = BulkNow();
+   uint8_t g, r, Group;
+
+   memset(Chunk->Counts,0,sizeof(Chunk->Counts));
+
+   memset(Chunk->GroupFrames,0,sizeof(Chunk->GroupFrames));
+   Chunk->Skipped = 0;
+
+   for(i=0;i<Chunk->Count;i++)
+   {
+      Group = BulkGroup(Chunk->Frames[i].ID);
+      Chunk->Group[i] = Group;
+
+      if(Group == BULK_NO_GROUP)
+         Chunk->Skipped++;
+      else
+         Chunk->GroupFrames[Group]++;
+   }
+
+   Position = 0;
+   for(g=0;g<SPN_PGNS;g++)
+   {
+      Chunk->Start[g] = Position;
+      Next[g] = Position;
+      Position += Chunk->GroupFrames[g];
+   }
+
+   for(i=0;i<Chunk->Count;i++)
+   {
+      Group = Chunk->Group[i];
+      if(Group == BULK_NO_GROUP)
+         continue;
+
+      Frame = &Chunk->Frames[i];
+      Position = Next[Group]++;
+      memcpy(&Chunk->Data[Position],Frame->Data,8);
+      Chunk->Time[Position] = Frame->Time;
+      Chunk->Source[Position] = (uint8_t)Frame->ID;
+   }
+
+   for(g=0;g<SPN_PGNS;g++)
+   {
+      for(r=g_BulkGroups[g].FirstRow;r<g_BulkGroups[g].FirstRow + g_BulkGroups[g].Rows;r++)
+      {
+         BulkDecodeRow(r,Chunk->Data + Chunk->Start[g],Chunk->GroupFrames[g],Chunk->Values[r] + Chunk->Start[g],Chunk->Status[r] + Chunk->Start[g]);
+
+         //written so the compiler vectorizes it, every value is one of the 3
+         for(i=Chunk->Start[g],Valid=0,Error=0;i<Chunk->Start[g] + Chunk->GroupFrames[g];i++)
+         {
+            Valid += (Chunk->Status[r][i] == SPN_VALID);
+            Error += (Chunk->Status[r][i] == SPN_ERROR);
+         }
+         Chunk->Counts[r][SPN_VALID] = Valid;
+         Chunk->Counts[r][SPN_ERROR] = Error;
+         Chunk->Counts[r][SPN_NOT_AVAILABLE] = Chunk->GroupFrames[g] - Valid - Error;
+      }
+   }
+
+   Chunk->Nanoseconds = BulkNow() - Start;
+
+   return(NULL);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Output
+
+FILE *g_BulkTimeFiles[SPN_PGNS], *g_BulkSourceFiles[SPN_PGNS];
+FILE *g_BulkValueFiles[SPN_SLOTS], *g_BulkStatusFiles[SPN_SLOTS];
+
+FILE *BulkCreate(const char *Directory, const char *Format, unsigned Number)
+{
+   char Name[1024], Base[64];
+   FILE *File;
+
+   snprintf(Base,sizeof(Base),Format,Number);
+   snprintf(Name,sizeof(Name),"%s/%s",Directory,Base);
+
+   File = fopen(Name,"wb");
+   if(File == NULL)
+   {
+      fprintf(stderr,"can't write %s\n",Name);
+      exit(2);
+   }
+
+   return(File);
+}
+
+void BulkOpenOutput(const char *Directory)
+{
+   uint8_t i;
+
+   if((mkdir(Directory,0777) != 0) && (errno != EEXIST))
+   {
+      fprintf(stderr,"can't make %s\n",Directory);
+      exit(2);
+   }
+
+   for(i=0;i<SPN_PGNS;i++)
+   {
+      g_BulkTimeFiles[i] = BulkCreate(Directory,"pgn%04X.time",g_BulkGroups[i].PGN);
+      g_BulkSourceFiles[i] = BulkCreate(Directory,"pgn%04X.source",g_BulkGroups[i].PGN);
+   }
+
+   for(i=0;i<SPN_SLOTS;i++)
+   {
+      g_BulkValueFiles[i] = BulkCreate(Directory,"spn%u.value",g_SpnTable[i].SPN);
+      g_BulkStatusFiles[i] = BulkCreate(Directory,"spn%u.status",g_SpnTable[i].SPN);
+   }
+}
+
+//appends a decoded chunk to the columns
+void BulkWrite(BULK_CHUNK *Chunk)
+{
+   uint8_t g, r;
+   uint32_t Start, Count;
+
+   for(g=0;g<SPN_PGNS;g++)
+   {
+      Start = Chunk->Start[g];
+      Count = Chunk->GroupFrames[g];
+
+      fwrite(Chunk->Time + Start,sizeof(uint32_t),Count,g_BulkTimeFiles[g]);
+      fwrite(Chunk->Source + Start,1,Count,g_BulkSourceFiles[g]);
+
+      for(r=g_BulkGroups[g].FirstRow;r<g_BulkGroups[g].FirstRow + g_BulkGroups[g].Rows;r++)
+      {
+         fwrite(Chunk->Values[r] + Start,sizeof(int16_t),Count,g_BulkValueFiles[r]);
+         fwrite(Chunk->Status[r] + Start,1,Count,g_BulkStatusFiles[r]);
+      }
+   }
+}
+
+int BulkCloseOutput(void)
+{
+   int Failed = 0;
+   uint8_t i;
+
+   for(i=0;i<SPN_PGNS;i++)
+   {
+      Failed |= ferror(g_BulkTimeFiles[i]) | fclose(g_BulkTimeFiles[i]);
+      Failed |= ferror(g_BulkSourceFiles[i]) | fclose(g_BulkSourceFiles[i]);
+   }
+
+   for(i=0;i<SPN_SLOTS;i++)
+   {
+      Failed |= ferror(g_BulkValueFiles[i]) | fclose(g_BulkValueFiles[i]);
+      Failed |= ferror(g_BulkStatusFiles[i]) | fclose(g_BulkStatusFiles[i]);
+   }
+
+   return(Failed);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Verify
+
+//Decodes a chunk's frames one at a time with SpnStorePGN() and compares the
+//store with the chunk's columns.  Returns number of values that differ.
+uint32_t BulkVerify(BULK_CHUNK *Chunk)
+{
+   uint32_t Next[SPN_PGNS], i, Position, Wrong = 0;
+   uint8_t r, Group;
+   const BULK_FRAME *Frame;
+
+   for(Group=0;Group<SPN_PGNS;Group++)
+      Next[Group] = Chunk->Start[Group];
+
+   for(i=0;i<Chunk->Count;i++)
+   {
+      Frame = &Chunk->Frames[i];
+      Group = BulkGroup(Frame->ID);
+      if(Group == BULK_NO_GROUP)
+         continue;
+
+      Position = Next[Group]++;
+      SpnStorePGN(g_BulkGroups[Group].PGN,(uint8_t *)Frame->Data);
+
+      if((Chunk->Time[Position] != Frame->Time) || (Chunk->Source[Position] != (uint8_t)Frame->ID))
+         Wrong++;
+
+      for(r=g_BulkGroups[Group].FirstRow;r<g_BulkGroups[Group].FirstRow + g_BulkGroups[Group].Rows;r++)
+      {
+         if((g_SpnStore[r].Status != Chunk->Status[r][Position]) || (g_SpnStore[r].Value != Chunk->Values[r][Position]))
+         {
+            if(Wrong < 10)
+               printf("frame %u SPN %u: store %d status %u, bulk %d status %u\n",i,g_SpnTable[r].SPN,g_SpnStore[r].Value,
+                      g_SpnStore[r].Status,Chunk->Values[r][Position],Chunk->Status[r][Position]);
+            Wrong++;
+         }
+      }
+   }
+
+   return(Wrong);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Synthetic log
+
+uint32_t g_BulkRandom = 1;
+
+uint32_t BulkRandom(void)
+{
+   g_BulkRandom ^= g_BulkRandom << 13;
+   g_BulkRandom ^= g_BulkRandom >> 17;
+   g_BulkRandom ^= g_BulkRandom << 5;
+
+   return(g_BulkRandom);
+}
+
+//Writes Count frames, 7 in 8 of the table's PGNs from a few source
+//addresses, the rest other PGNs.  Data is random with reserved bytes mixed in
+//so every status turns up.
+int BulkMake(const char *FileName, uint32_t Count)
+{
+   BULK_FRAME Frames[4096];
+   FILE *File;
+   uint32_t i, j, n, Random;
+   uint16_t PGN;
+   uint8_t b;
+
+   File = fopen(FileName,"wb");
+   if(File == NULL)
+   {
+      fprintf(stderr,"can't write %s\n",FileName);
+      return(2);
+   }
+
+   for(i=0;i<Count;i+=n)
+   {
+      n = (Count - i < 4096) ? Count - i : 4096;
+
+      for(j=0;j<n;j++)
+      {
+         Random = BulkRandom();
+
+         if(Random & 7)
+            PGN = g_SpnPgnList[(Random >> 3) % SPN_PGNS];
+         else
+            PGN = 0xFE00 + ((Random >> 3) & 0xFF);
+
+         Frames[j].Time = i + j;
+         Frames[j].ID = ((uint32_t)6 << 26) | ((uint32_t)PGN << 8) | ((Random >> 16) & 3);
+
+         for(b=0;b<8;b++)
+            Frames[j].Data[b] = (BulkRandom() & 3) ? BulkRandom() : 0xFB + (BulkRandom() % 5);
+      }
+
+      if(fwrite(Frames,sizeof(BULK_FRAME),n,File) != n)
+         break;
+   }
+
+   if(fclose(File) || (i < Count))
+   {
+      fprintf(stderr,"can't write %s\n",FileName);
+      return(2);
+   }
+
+   return(0);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Main
+
+int main(int argc, char *argv[])
+{
+   const char *FileName = NULL, *Directory = NULL;
+   uint32_t Threads = 0, ChunkSize = BULK_CHUNK_FRAMES, Make = 0, t, Running, Wrong = 0;
+   uint64_t Frames, Frame, Skipped = 0, ThreadTime = 0, Start, Elapsed;
+   uint64_t Counts[SPN_SLOTS][SPN_STALE] = {{0}};
+   static BULK_CHUNK Chunks[BULK_MAX_THREADS];
+   pthread_t Thread[BULK_MAX_THREADS];
+   const BULK_FRAME *Log;
+   struct stat Stat;
+   int Verify = 0, File, i;
+   uint32_t j;
+   uint8_t r;
+
+   for(i=1;i<argc;i++)
+   {
+      if((i + 1 < argc) && !strcmp(argv[i],"-o"))
+         Directory = argv[++i];
+      else if((i + 1 < argc) && !strcmp(argv[i],"-threads"))
+         Threads = strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-chunk"))
+         ChunkSize = strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-make"))
+         Make = strtoul(argv[++i],NULL,0);
+      else if(!strcmp(argv[i],"-verify"))
+         Verify = 1;
+      else if((argv[i][0] != '-') && (FileName == NULL))
+         FileName = argv[i];
+      else
+      {
+         fprintf(stderr,"unknown option %s\n",argv[i]);
+         return(2);
+      }
+   }
+
+   if((FileName == NULL) || (ChunkSize == 0))
+   {
+      fprintf(stderr,"usage: j1939-bulk [-o dir] [-threads n] [-chunk frames] [-verify] log.bin\n"
+                     "       j1939-bulk -make frames log.bin\n");
+      return(2);
+   }
+
+   if(Make)
+      return(BulkMake(FileName,Make));
+
+   if(Threads == 0)
+      Threads = sysconf(_SC_NPROCESSORS_ONLN);
+   if(Threads > BULK_MAX_THREADS)
+      Threads = BULK_MAX_THREADS;
+   if(Threads == 0)
+      Threads = 1;
+
+   File = open(FileName,O_RDONLY);
+   if((File < 0) || (fstat(File,&Stat) != 0))
+   {
+      fprintf(stderr,"can't open %s\n",FileName);
+      return(2);
+   }
+
+   Frames = Stat.st_size / sizeof(BULK_FRAME);
+   if(Stat.st_size % sizeof(BULK_FRAME))
+      fprintf(stderr,"%s: %u bytes at the end aren't a whole frame, ignored\n",FileName,(unsigned)(Stat.st_size % sizeof(BULK_FRAME)));
+   if(Frames == 0)
+   {
+      fprintf(stderr,"no frames in %s\n",FileName);
+      return(2);
+   }
+
+   Log = (const BULK_FRAME *)mmap(NULL,Stat.st_size,PROT_READ,MAP_PRIVATE,File,0);
+   if(Log == MAP_FAILED)
+   {
+      fprintf(stderr,"can't map %s\n",FileName);
+      return(2);
+   }
+   madvise((void *)Log,Stat.st_size,MADV_SEQUENTIAL);
+
+   BulkInit();
+   if(Directory != NULL)
+      BulkOpenOutput(Directory);
+
+   if((uint64_t)Threads * ChunkSize > Frames)
+      Threads = (Frames + ChunkSize - 1) / ChunkSize;
+   if(ChunkSize > Frames)
+      ChunkSize = Frames;
+   for(t=0;t<Threads;t++)
+      BulkChunkAllocate(&Chunks[t],ChunkSize);
+
+   //a round is one chunk per thread, written in log order so each column
+   //stays in frame order
+   Start = BulkNow();
+   for(Frame=0;Frame<Frames;Frame+=Running * ChunkSize)
+   {
+      for(Running=0;(Running < Threads) && (Frame + (uint64_t)Running * ChunkSize < Frames);Running++)
+      {
+         Chunks[Running].Frames = Log + Frame + (uint64_t)Running * ChunkSize;
+         Chunks[Running].Count = (Frames - (Frame + (uint64_t)Running * ChunkSize) < ChunkSize) ? Frames - (Frame + (uint64_t)Running * ChunkSize) : ChunkSize;
+      }
+
+      if(Running == 1)
+         BulkChunkTask(&Chunks[0]);
+      else
+      {
+         for(t=0;t<Running;t++)
+            pthread_create(&Thread[t],NULL,BulkChunkTask,&Chunks[t]);
+         for(t=0;t<Running;t++)
+            pthread_join(Thread[t],NULL);
+      }
+
+      for(t=0;t<Running;t++)
+      {
+         ThreadTime += Chunks[t].Nanoseconds;
+         Skipped += Chunks[t].Skipped;
+
+         for(r=0;r<SPN_SLOTS;r++)
+         {
+            for(j=0;j<SPN_STALE;j++)
+               Counts[r][j] += Chunks[t].Counts[r][j];
+         }
+
+         if(Directory != NULL)
+            BulkWrite(&Chunks[t]);
+         if(Verify)
+            Wrong += BulkVerify(&Chunks[t]);
+      }
+   }
+   Elapsed = BulkNow() - Start;
+
+   printf("%-6s %-5s %14s %14s %14s\n","pgn","spn","valid","error","n/a");
+   for(r=0;r<SPN_SLOTS;r++)
+      printf("%04X   %-5u %14llu %14llu %14llu\n",g_SpnTable[r].PGN,g_SpnTable[r].SPN,(unsigned long long)Counts[r][SPN_VALID],
+             (unsigned long long)Counts[r][SPN_ERROR],(unsigned long long)Counts[r][SPN_NOT_AVAILABLE]);
+
+   printf("log %s  frames %llu  not decoded %llu  threads %u  chunk %u\n",FileName,(unsigned long long)Frames,
+          (unsigned long long)Skipped,Threads,ChunkSize);
+   printf("time %.3fs  %.1f M frames/s  decode %.2f ns/frame per thread, %.1f M frames/s per thread\n",Elapsed / 1e9,
+          Frames * 1e3 / (Elapsed ? Elapsed : 1),(double)ThreadTime / Frames,Frames * 1e3 / (ThreadTime ? ThreadTime : 1));
+
+   if(Verify)
+      printf("verify against SpnStorePGN(), %u wrong\n",Wrong);
+
+   for(t=0;t<Threads;t++)
+      BulkChunkFree(&Chunks[t]);
+   munmap((void *)Log,Stat.st_size);
+   close(File);
+
+   if((Directory != NULL) && BulkCloseOutput())
+   {
+      fprintf(stderr,"can't write the columns to %s\n",Directory);
+      return(2);
+   }
+
+   return(Wrong ? 1 : 0);
+}
@@ -0,0 +1,385 @@
+////////////////////////////////////////////////////////////////////////////////
+////                             j1939-fuzz.cpp                             ////
+////                                                                        ////
+//// libFuzzer target for the J1939 driver.  Each input is played into the  ////
+//// driver through the host CAN driver (can-host.c) as received frames,    ////
+//// tick steps and messages the unit sends, so J1939ReceiveTask(), the     ////
+//// Address Claim handling, the address map and J1939XmitTask() see        ////
+//// whatever the fuzzer makes up.  The driver is built with                ////
+//// J1939_USE_CHECKS, a failed check or a bad frame sent by the unit       ////
+//// calls abort(), which the fuzzer reports as a crash.                    ////
+////                                                                        ////
+//// Input:                                                                 ////
+////    byte 0      unit's preferred address                                ////
+////    bytes 1-8   unit's J1939 Name                                       ////
+////    then records of 15 bytes:                                           ////
+////       Ticks    ms to move the tick on before the record                ////
+////       Flags    FUZZ_EXT, FUZZ_RTR, FUZZ_TX_BUSY, FUZZ_RUN, FUZZ_SEND,  ////
+////                FUZZ_NO_FRAME                                           ////
+////       ID       4 bytes, most significant first                         ////
+////       Length   0 to 15, CAN FD style lengths over 8 are passed on      ////
+////       Data     8 bytes                                                 ////
+////                                                                        ////
+//// libFuzzer, clang only:                                                 ////
+////    clang++ -x c++ -g -O1 -fsanitize=fuzzer,address,undefined           ////
+////        j1939-fuzz.cpp -o j1939-fuzz                                    ////
+////    ./j1939-fuzz j1939-fuzz-corpus                                      ////
+////                                                                        ////
+//// Without libFuzzer, runs inputs given on the command line, or with      ////
+//// -mutate N that many random changes of them, to reproduce a crash with  ////
+//// GCC or on a machine without libFuzzer:                                 ////
+////    g++ -x c++ -g -O1 -fsanitize=address,undefined -DFUZZ_MAIN=1        ////
+////        j1939-fuzz.cpp -o j1939-fuzz                                    ////
+////    ./j1939-fuzz crash-1234                                             ////
+////    ./j1939-fuzz -mutate 100000 j1939-fuzz-corpus/*                     ////
+////                                                                        ////
+//// Seeds are made from CAN captures with "j1939-replay -fuzz seed log",   ////
+//// j1939-fuzz-corpus holds the ones made from the EX_J1939 captures.      ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "can-host.h"
+
+void InitJ1939Address(void);
+void InitJ1939Name(void);
+
+//set to TRUE to build a main() that runs inputs without libFuzzer
+#ifndef FUZZ_MAIN
+ #define FUZZ_MAIN FALSE
+#endif
+
+//////////////////////////////////////////////////////////////////////////////// Tick Timer
+
+//ms since the start of the input, moved on by each record
+uint32_t g_FuzzTick;
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Settings
+
+//Following Macros used to initialize unit's J1939 Address and Name - Required
+#define J1939InitAddress()    InitJ1939Address()
+#define J1939InitName()       InitJ1939Name()
+
+//Following define selects the host CAN driver, can-host.c
+#define USE_HOST_CAN   TRUE
+
+//Following defines/macros used to associate the input's time to J1939 tick
+#define J1939GetTick()                 g_FuzzTick
+#define J1939GetTickDifference(a,b)    ((uint32_t)((a) - (b)))
+#define J1939_TICKS_PER_SECOND         1000
+#define J1939_TICK_TYPE                uint32_t
+
+//Check the buffers after every task, stop on the first failed check
+#define J1939_USE_CHECKS               TRUE
+#define J1939CheckFailed(line)         FuzzFailed("J1939Check",line)
+
+//input being run, written to fuzz-crash by the standalone driver when it fails
+const uint8_t *g_FuzzInput;
+size_t g_FuzzInputSize;
+
+void FuzzFailed(const char *What, unsigned Line)
+{
+   fprintf(stderr,"%s failed, line %u\n",What,Line);
+
+  #if FUZZ_MAIN == TRUE
+   FILE *f = fopen("fuzz-crash","wb");
+   if(f != NULL)
+   {
+      fwrite(g_FuzzInput,1,g_FuzzInputSize,f);
+      fclose(f);
+      fprintf(stderr,"input written to fuzz-crash\n");
+   }
+  #endif
+
+   abort();
+}
+
+#define FuzzCheck(condition)   do{ if(!(condition)) FuzzFailed("FuzzCheck",__LINE__); }while(0)
+
+//Include the J1939 driver
+#include "j1939.c"
+
+//////////////////////////////////////////////////////////////////////////////// Input
+
+#define FUZZ_HEADER_SIZE   9
+#define FUZZ_RECORD_SIZE   15
+
+//record flags
+#define FUZZ_EXT        0x01     //29-bit ID
+#define FUZZ_RTR        0x02     //remote transmission request
+#define FUZZ_TX_BUSY    0x04     //can_tbe() returns FALSE while the record runs
+#define FUZZ_RUN        0x08     //run a pass of the unit's main loop after the record
+#define FUZZ_SEND       0x10     //the unit sends the record with J1939PutMessage() instead of receiving it
+#define FUZZ_NO_FRAME   0x20     //tick step only
+
+//the input's preferred address and Name, used by InitJ1939Address() and InitJ1939Name()
+uint8_t g_FuzzAddress;
+uint8_t g_FuzzName[8];
+
+//Function used to initialize this unit's J1939 Address
+void InitJ1939Address(void)
+{
+   g_MyJ1939Address = g_FuzzAddress;
+}
+
+//Function used to initialize this unit's J1939 Name
+void InitJ1939Name(void)
+{
+   memcpy(g_J1939Name,g_FuzzName,8);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Fuzz CAN backend
+
+//frames waiting to be received, more than the ECAN buffers hold so the
+//driver's own overflow handling is reached as well as the backend's
+#define FUZZ_RX_FRAMES  16
+
+can_host_frame g_FuzzRx[FUZZ_RX_FRAMES];
+uint8_t g_FuzzRxNextIn, g_FuzzRxNextOut, g_FuzzRxCount;
+int1 g_FuzzTxBusy;
+
+int1 FuzzCanInit(void *Context)
+{
+   (void)Context;
+   return(TRUE);
+}
+
+int1 FuzzCanGetd(void *Context, can_host_frame *Frame)
+{
+   (void)Context;
+
+   if(g_FuzzRxCount == 0)
+      return(FALSE);
+
+   *Frame = g_FuzzRx[g_FuzzRxNextOut];
+   if(++g_FuzzRxNextOut >= FUZZ_RX_FRAMES)
+      g_FuzzRxNextOut = 0;
+   g_FuzzRxCount--;
+
+   return(TRUE);
+}
+
+//every frame the unit sends must be a J1939 frame
+int1 FuzzCanPutd(void *Context, can_host_frame *Frame)
+{
+   (void)Context;
+
+   FuzzCheck(Frame->ext);
+   FuzzCheck(!Frame->rtr);
+   FuzzCheck(Frame->id <= 0x1FFFFFFF);
+   FuzzCheck(Frame->len <= 8);
+
+   return(TRUE);
+}
+
+int1 FuzzCanKbhit(void *Context)
+{
+   (void)Context;
+   return(g_FuzzRxCount != 0);
+}
+
+int1 FuzzCanTbe(void *Context)
+{
+   (void)Context;
+   return(!g_FuzzTxBusy);
+}
+
+const can_host_ops FuzzCanOps = {
+   FuzzCanInit,
+   FuzzCanGetd,
+   FuzzCanPutd,
+   FuzzCanKbhit,
+   FuzzCanTbe,
+   NULL,
+   NULL,
+   NULL,
+   NULL
+};
+
+//////////////////////////////////////////////////////////////////////////////// Fuzz target
+
+//J1939Init() expects the driver's globals to be cleared at power up, clear
+//the buffer indexes it doesn't set so each input starts from power up
+void FuzzResetDriver(void)
+{
+   g_J1939ReceiveNextIn = 0;
+   g_J1939ReceiveNextOut = 0;
+   g_J1939XmitNextIn = 0;
+   g_J1939XmitNextOut = 0;
+  #if J1939_STAGED_BUFFERS > 0
+   g_J1939StagedNextIn = 0;
+   g_J1939StagedNextOut = 0;
+  #endif
+   g_J1939ReceiveOverflows = 0;
+   g_J1939ReceiveDropped = 0;
+   g_J1939CheckFailures = 0;
+
+   g_FuzzRxNextIn = 0;
+   g_FuzzRxNextOut = 0;
+   g_FuzzRxCount = 0;
+   g_FuzzTxBusy = FALSE;
+   g_FuzzTick = 0;
+}
+
+//one pass of the unit's main loop
+void FuzzTask(void)
+{
+   J1939_PDU_STRUCT PDU;
+   uint8_t Data[8];
+   uint8_t Length;
+
+   J1939ReceiveTask();
+
+   while(J1939Kbhit())
+   {
+      FuzzCheck(J1939GetMessage(PDU,Data,Length));
+      FuzzCheck(Length <= 8);
+   }
+
+   J1939XmitTask();
+
+   if(g_J1939Flags.AddressClaimed)
+      FuzzCheck(g_MyJ1939Address < J1939_NULL_ADDRESS);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Input, size_t Size)
+{
+   J1939_PDU_STRUCT PDU;
+   can_host_frame Frame;
+   const uint8_t *Record;
+   uint8_t Flags;
+
+   if(Size < FUZZ_HEADER_SIZE)
+      return(0);
+
+   g_FuzzInput = Input;
+   g_FuzzInputSize = Size;
+
+   g_FuzzAddress = Input[0] % J1939_NULL_ADDRESS;     //the application must give an address from 0 to 253
+   memcpy(g_FuzzName,&Input[1],8);
+
+   FuzzResetDriver();
+   can_host_set_ops(&FuzzCanOps,NULL);
+   J1939Init();
+
+   for(Record=Input + FUZZ_HEADER_SIZE;Record + FUZZ_RECORD_SIZE <= Input + Size;Record+=FUZZ_RECORD_SIZE)
+   {
+      g_FuzzTick += Record[0];
+      Flags = Record[1];
+
+      memset(&Frame,0,sizeof(Frame));
+      Frame.id = ((uint32_t)Record[2] << 24) | ((uint32_t)Record[3] << 16) | ((uint32_t)Record[4] << 8) | Record[5];
+      Frame.ext = (Flags & FUZZ_EXT) ? TRUE : FALSE;
+      Frame.rtr = (Flags & FUZZ_RTR) ? TRUE : FALSE;
+      Frame.id &= Frame.ext ? 0x1FFFFFFF : 0x7FF;
+      Frame.len = Record[6] & 0x0F;
+      memcpy(Frame.data,&Record[7],8);
+
+      if(Flags & FUZZ_NO_FRAME)
+         ;
+      else if(Flags & FUZZ_SEND)
+      {
+         J1939IDToPDU(Frame.id,&PDU);
+         J1939PutMessage(PDU,Frame.data,(Frame.len > 8) ? 8 : Frame.len);
+      }
+      else if(g_FuzzRxCount < FUZZ_RX_FRAMES)
+      {
+         g_FuzzRx[g_FuzzRxNextIn] = Frame;
+         if(++g_FuzzRxNextIn >= FUZZ_RX_FRAMES)
+            g_FuzzRxNextIn = 0;
+         g_FuzzRxCount++;
+      }
+
+      g_FuzzTxBusy = (Flags & FUZZ_TX_BUSY) ? TRUE : FALSE;
+
+      if(Flags & FUZZ_RUN)
+         FuzzTask();
+   }
+
+   //let any claim in progress finish
+   g_FuzzTxBusy = FALSE;
+   g_FuzzTick += 1000;
+   FuzzTask();
+   FuzzTask();
+
+   return(0);
+}
+
+#if FUZZ_MAIN == TRUE
+//////////////////////////////////////////////////////////////////////////////// Standalone driver
+
+uint8_t *FuzzLoad(const char *FileName, size_t *Size)
+{
+   FILE *f;
+   uint8_t *Buffer;
+   long Length;
+
+   f = fopen(FileName,"rb");
+   if(f == NULL)
+      return(NULL);
+
+   fseek(f,0,SEEK_END);
+   Length = ftell(f);
+   fseek(f,0,SEEK_SET);
+
+   Buffer = (uint8_t *)malloc(Length ? Length : 1);
+   if((Buffer == NULL) || (fread(Buffer,1,Length,f) != (size_t)Length))
+   {
+      free(Buffer);
+      Buffer = NULL;
+   }
+
+   fclose(f);
+   *Size = Length;
+
+   return(Buffer);
+}
+
+int main(int argc, char *argv[])
+{
+   uint32_t Mutate = 0, m, Changes;
+   uint8_t *Input, *Copy;
+   size_t Size;
+   int i;
+
+   srand(1);
+
+   for(i=1;i<argc;i++)
+   {
+      if((i + 1 < argc) && !strcmp(argv[i],"-mutate"))
+      {
+         Mutate = strtoul(argv[++i],NULL,0);
+         continue;
+      }
+
+      Input = FuzzLoad(argv[i],&Size);
+      if(Input == NULL)
+      {
+         fprintf(stderr,"can't read %s\n",argv[i]);
+         return(2);
+      }
+
+      LLVMFuzzerTestOneInput(Input,Size);
+
+      Copy = (uint8_t *)malloc(Size ? Size : 1);
+      for(m=0;(m < Mutate) && Size;m++)
+      {
+         memcpy(Copy,Input,Size);
+         for(Changes=1 + rand() % 8;Changes;Changes--)
+            Copy[rand() % Size] = (rand() & 1) ? (uint8_t)rand() : (uint8_t)(Copy[rand() % Size] ^ (1 << (rand() % 8)));
+         LLVMFuzzerTestOneInput(Copy,Size);
+      }
+
+      printf("%s  %u bytes  %u records  %u mutations\n",argv[i],(unsigned)Size,
+             (unsigned)((Size < FUZZ_HEADER_SIZE) ? 0 : (Size - FUZZ_HEADER_SIZE) / FUZZ_RECORD_SIZE),Mutate);
+
+      free(Copy);
+      free(Input);
+   }
+
+   return(0);
+}
+#endif
@@ -0,0 +1,1055 @@
+////////////////////////////////////////////////////////////////////////////////
+////                              j1939-gen.cpp                             ////
+////                                                                        ////
+//// Generates the SPN table EX_J1939_SPN.c decodes with, from a CSV export ////
+//// of the J1939 Digital Annex or a J1939 DBC file, so SPNs aren't kept    ////
+//// by hand.  The header has the PGN_ and SPN_ defines, the SPN_SLOT_      ////
+//// enum, g_SpnTable[] sorted by PGN, the list of PGNs (g_SpnPgnList[],    ////
+//// for requesting them or setting up CAN filters) and a perfect hash from ////
+//// PGN to its first row (g_SpnPgnHash[]).                                 ////
+////                                                                        ////
+//// CSV columns, found by name in the first line, any order:               ////
+////    PGN, Parameter Group Label, Transmission Rate, SPN, SPN Name,       ////
+////    SPN Position in PG, SPN Length, Resolution, Offset,                 ////
+////    Operational Range (or Data Range)                                   ////
+//// Values are written the way the Digital Annex writes them, for example  ////
+//// "4-5", "2.5", "2 bytes", "0.125 rpm/bit", "10^-7 deg/bit", "-40 deg C" ////
+//// "0 to 8031.875 rpm" and "100 ms".                                      ////
+////                                                                        ////
+//// DBC files need the "SPN" signal attribute and "GenMsgCycleTime".       ////
+//// Signals must be Intel byte order (@1) and unsigned, as J1939 sends     ////
+//// them, Motorola (@0) signals are rejected.                              ////
+////                                                                        ////
+//// Building with -DGEN_VERIFY=TRUE compiles EX_J1939_SPN.c and the        ////
+//// generated table in, and -verify then checks it against the source      ////
+//// with a reference decoder: every raw value of fields up to 16 bits,     ////
+//// 65536 of wider ones, the status and every PGN through the hash.        ////
+////                                                                        ////
+//// Build:                                                                 ////
+////    g++ -x c++ -O2 j1939-gen.cpp -o j1939-gen                           ////
+////    g++ -x c++ -O2 -DGEN_VERIFY=TRUE j1939-gen.cpp -o j1939-gen-verify  ////
+////                                                                        ////
+//// Run:                                                                   ////
+////    ./j1939-gen -o EX_J1939_SPN_TABLE.h EX_J1939_SPN.csv                ////
+////    ./j1939-gen-verify -verify EX_J1939_SPN.csv                         ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+
+#ifndef GEN_VERIFY
+#define GEN_VERIFY   FALSE
+#endif
+
+#ifndef TRUE
+#define TRUE   1
+#define FALSE  0
+#endif
+
+#define GEN_MAX_SIGNALS    254      //SPN_NOT_FOUND is 0xFF
+#define GEN_MAX_FIELDS     32
+#define GEN_NAME_SIZE      64
+
+//////////////////////////////////////////////////////////////////////////////// Signals
+
+typedef struct _GEN_SIGNAL {
+   uint32_t PGN;
+   uint32_t SPN;
+   char PgnName[GEN_NAME_SIZE];
+   char SpnName[GEN_NAME_SIZE];
+   char Units[GEN_NAME_SIZE];
+   uint8_t StartBit;
+   uint8_t Length;
+   double Resolution;
+   double Offset;
+   double Min;
+   double Max;
+   uint32_t Rate;             //ms
+   uint8_t Shift;
+   int Line;
+} GEN_SIGNAL;
+
+GEN_SIGNAL g_GenSignals[GEN_MAX_SIGNALS];
+uint16_t g_GenSignalCount;
+
+//DBC signals waiting for their SPN and rate attributes
+typedef struct _GEN_DBC_SIGNAL {
+   uint32_t ID;
+   char Name[GEN_NAME_SIZE];
+} GEN_DBC_SIGNAL;
+
+GEN_DBC_SIGNAL g_GenDbcSignals[GEN_MAX_SIGNALS];
+
+uint16_t g_GenPgns[GEN_MAX_SIGNALS];
+uint16_t g_GenPgnCount;
+uint8_t g_GenHashBits, g_GenHashMult;
+uint8_t g_GenHash[256];
+
+const char *g_GenFileName;
+int g_GenErrors;
+
+void GenError(int Line, const char *Text, const char *Detail)
+{
+   fprintf(stderr,"%s:%d: %s%s%s\n",g_GenFileName,Line,Text,Detail ? " " : "",Detail ? Detail : "");
+   g_GenErrors++;
+}
+
+//////////////////////////////////////////////////////////////////////////////// Text
+
+//makes a C identifier from a name, "Engine Speed" and "EngineSpeed" both
+//become ENGINE_SPEED
+void GenIdentifier(const char *Text, char *Out)
+{
+   uint8_t n = 0;
+   char Previous = ' ';
+
+   while(*Text && (n < GEN_NAME_SIZE - 2))
+   {
+      if(isalnum((unsigned char)*Text))
+      {
+         if(isupper((unsigned char)*Text) && islower((unsigned char)Previous) && n && (Out[n - 1] != '_'))
+            Out[n++] = '_';
+         Out[n++] = toupper((unsigned char)*Text);
+      }
+      else if(n && (Out[n - 1] != '_'))
+         Out[n++] = '_';
+
+      Previous = *Text++;
+   }
+
+   while(n && (Out[n - 1] == '_'))
+      n--;
+   Out[n] = 0;
+
+   if(isdigit((unsigned char)Out[0]))
+   {
+      memmove(Out + 1,Out,n + 1);
+      Out[0] = '_';
+   }
+}
+
+//reads a number at the start of Text, also "10^-7" and "1/8".  Returns
+//FALSE if there's none, End is set past it.
+int GenNumber(const char *Text, double &Value, const char **End)
+{
+   char *p;
+   double Denominator;
+
+   while(isspace((unsigned char)*Text))
+      Text++;
+   if(*Text == '+')
+      Text++;
+
+   Value = strtod(Text,&p);
+   if(p == Text)
+      return(FALSE);
+
+   if(*p == '^')
+   {
+      Text = p + 1;
+      Value = pow(Value,strtod(Text,&p));
+      if(p == Text)
+         return(FALSE);
+   }
+   else if((*p == '/') && isdigit((unsigned char)p[1]))
+   {
+      Text = p + 1;
+      Denominator = strtod(Text,&p);
+      if(Denominator == 0)
+         return(FALSE);
+      Value /= Denominator;
+   }
+
+   if(End)
+      *End = p;
+
+   return(TRUE);
+}
+
+void GenTrim(char *Text)
+{
+   char *p = Text;
+   size_t n;
+
+   while(isspace((unsigned char)*p))
+      p++;
+   memmove(Text,p,strlen(p) + 1);
+
+   n = strlen(Text);
+   while(n && isspace((unsigned char)Text[n - 1]))
+      Text[--n] = 0;
+}
+
+//copies what's left of Text, trimmed, into Out
+void GenCopy(char *Out, const char *Text)
+{
+   strncpy(Out,Text,GEN_NAME_SIZE - 1);
+   Out[GEN_NAME_SIZE - 1] = 0;
+   GenTrim(Out);
+}
+
+//splits a CSV line in place, quoted fields can hold commas and "" quotes.
+//Returns number of fields.
+int GenSplitCsv(char *Line, char *Fields[])
+{
+   int Count = 0;
+   char *In = Line, *Out;
+
+   while(Count < GEN_MAX_FIELDS)
+   {
+      Fields[Count++] = Out = In;
+
+      if(*In == '"')
+      {
+         In++;
+         while(*In)
+         {
+            if((In[0] == '"') && (In[1] == '"'))
+            {
+               *Out++ = '"';
+               In += 2;
+            }
+            else if(*In == '"')
+            {
+               In++;
+               break;
+            }
+            else
+               *Out++ = *In++;
+         }
+         while(*In && (*In != ','))
+            In++;
+      }
+      else
+      {
+         while(*In && (*In != ',') && (*In != '\r') && (*In != '\n'))
+            *Out++ = *In++;
+      }
+
+      if(*In != ',')
+      {
+         *Out = 0;
+         break;
+      }
+
+      In++;
+      *Out = 0;
+   }
+
+   return(Count);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Digital Annex CSV
+
+enum {
+   GEN_COLUMN_PGN,
+   GEN_COLUMN_PGN_NAME,
+   GEN_COLUMN_RATE,
+   GEN_COLUMN_SPN,
+   GEN_COLUMN_SPN_NAME,
+   GEN_COLUMN_POSITION,
+   GEN_COLUMN_LENGTH,
+   GEN_COLUMN_RESOLUTION,
+   GEN_COLUMN_OFFSET,
+   GEN_COLUMN_RANGE,
+   GEN_COLUMNS
+};
+
+const char *g_GenColumnNames[GEN_COLUMNS][2] = {
+   {"PGN",                    NULL},
+   {"Parameter Group Label",  NULL},
+   {"Transmission Rate",      NULL},
+   {"SPN",                    NULL},
+   {"SPN Name",               NULL},
+   {"SPN Position in PG",     "SPN Position in PGN"},
+   {"SPN Length",             NULL},
+   {"Resolution",             NULL},
+   {"Offset",                 NULL},
+   {"Operational Range",      "Data Range"},
+};
+
+//"4-5" and "1" are bytes, "2.5" is byte 2 bit 5, all counted from 1
+int GenPosition(const char *Text, uint8_t &StartBit)
+{
+   char *p;
+   long Byte, Bit = 1;
+
+   Byte = strtol(Text,&p,10);
+   if((p == Text) || (Byte < 1) || (Byte > 8))
+      return(FALSE);
+
+   if(*p == '.')
+   {
+      Bit = strtol(p + 1,&p,10);
+      if((Bit < 1) || (Bit > 8))
+         return(FALSE);
+   }
+
+   StartBit = (Byte - 1) * 8 + Bit - 1;
+
+   return(TRUE);
+}
+
+//"2 bytes", "1 byte" or "4 bits"
+int GenLength(const char *Text, uint8_t &Length)
+{
+   const char *p;
+   double Value;
+
+   if(!GenNumber(Text,Value,&p) || (Value < 1))
+      return(FALSE);
+
+   while(isspace((unsigned char)*p))
+      p++;
+
+   if(!strncasecmp(p,"byte",4))
+      Value *= 8;
+   else if(strncasecmp(p,"bit",3))
+      return(FALSE);
+
+   if(Value > 32)
+      return(FALSE);
+
+   Length = (uint8_t)Value;
+
+   return(TRUE);
+}
+
+//"0.125 rpm/bit", units are what's between the number and "/bit" or "per bit"
+int GenResolution(const char *Text, double &Resolution, char *Units)
+{
+   const char *p;
+   char *End;
+
+   if(!GenNumber(Text,Resolution,&p) || (Resolution <= 0))
+      return(FALSE);
+
+   GenCopy(Units,p);
+
+   if((End = strstr(Units,"/bit")) != NULL)
+      *End = 0;
+   else if((End = strstr(Units,"per bit")) != NULL)
+      *End = 0;
+   GenTrim(Units);
+
+   return(TRUE);
+}
+
+//"-40 to 210 deg C"
+int GenRange(const char *Text, double &Min, double &Max)
+{
+   const char *p;
+
+   if(!GenNumber(Text,Min,&p))
+      return(FALSE);
+
+   while(isspace((unsigned char)*p))
+      p++;
+   if(strncasecmp(p,"to",2))
+      return(FALSE);
+
+   return(GenNumber(p + 2,Max,NULL) && (Max >= Min));
+}
+
+//"100 ms" or "1 s"
+int GenRate(const char *Text, uint32_t &Rate)
+{
+   const char *p;
+   double Value;
+
+   if(!GenNumber(Text,Value,&p) || (Value <= 0))
+      return(FALSE);
+
+   while(isspace((unsigned char)*p))
+      p++;
+
+   if(!strncasecmp(p,"ms",2))
+      Rate = (uint32_t)Value;
+   else if((tolower((unsigned char)*p) == 's') && !isalpha((unsigned char)p[1]))
+      Rate = (uint32_t)(Value * 1000);
+   else
+      return(FALSE);
+
+   return(Rate > 0);
+}
+
+void GenReadCsv(FILE *File)
+{
+   char Line[2048];
+   char *Fields[GEN_MAX_FIELDS];
+   int Columns[GEN_COLUMNS];
+   int Count, LineNumber = 0, i, j;
+   GEN_SIGNAL *Signal;
+   double Value;
+
+   if(fgets(Line,sizeof(Line),File) == NULL)
+      return;
+   LineNumber++;
+
+   Count = GenSplitCsv(Line,Fields);
+   for(i=0;i<GEN_COLUMNS;i++)
+   {
+      Columns[i] = -1;
+      for(j=0;j<Count;j++)
+      {
+         GenTrim(Fields[j]);
+         if(!strcasecmp(Fields[j],g_GenColumnNames[i][0]) || (g_GenColumnNames[i][1] && !strcasecmp(Fields[j],g_GenColumnNames[i][1])))
+            Columns[i] = j;
+      }
+      if(Columns[i] < 0)
+         GenError(LineNumber,"missing column",g_GenColumnNames[i][0]);
+   }
+   if(g_GenErrors)
+      return;
+
+   while(fgets(Line,sizeof(Line),File) != NULL)
+   {
+      LineNumber++;
+
+      Count = GenSplitCsv(Line,Fields);
+      if((Count == 1) && (Fields[0][0] == 0))
+         continue;
+
+      if(g_GenSignalCount >= GEN_MAX_SIGNALS)
+      {
+         GenError(LineNumber,"too many signals",NULL);
+         return;
+      }
+
+      for(i=0;i<GEN_COLUMNS;i++)
+      {
+         if(Columns[i] >= Count)
+            break;
+      }
+      if(i < GEN_COLUMNS)
+      {
+         GenError(LineNumber,"missing fields",NULL);
+         continue;
+      }
+
+      Signal = &g_GenSignals[g_GenSignalCount];
+      memset(Signal,0,sizeof(GEN_SIGNAL));
+      Signal->Line = LineNumber;
+
+      if(!GenNumber(Fields[Columns[GEN_COLUMN_PGN]],Value,NULL) || (Value < 0))
+         GenError(LineNumber,"bad PGN",Fields[Columns[GEN_COLUMN_PGN]]);
+      Signal->PGN = (uint32_t)Value;
+      if(!GenNumber(Fields[Columns[GEN_COLUMN_SPN]],Value,NULL) || (Value < 0))
+         GenError(LineNumber,"bad SPN",Fields[Columns[GEN_COLUMN_SPN]]);
+      Signal->SPN = (uint32_t)Value;
+
+      GenIdentifier(Fields[Columns[GEN_COLUMN_PGN_NAME]],Signal->PgnName);
+      GenIdentifier(Fields[Columns[GEN_COLUMN_SPN_NAME]],Signal->SpnName);
+
+      if(!GenRate(Fields[Columns[GEN_COLUMN_RATE]],Signal->Rate))
+         GenError(LineNumber,"transmission rate isn't a time, write it in ms or s:",Fields[Columns[GEN_COLUMN_RATE]]);
+      if(!GenPosition(Fields[Columns[GEN_COLUMN_POSITION]],Signal->StartBit))
+         GenError(LineNumber,"bad position",Fields[Columns[GEN_COLUMN_POSITION]]);
+      if(!GenLength(Fields[Columns[GEN_COLUMN_LENGTH]],Signal->Length))
+         GenError(LineNumber,"bad length, 1 to 32 bits",Fields[Columns[GEN_COLUMN_LENGTH]]);
+      if(!GenResolution(Fields[Columns[GEN_COLUMN_RESOLUTION]],Signal->Resolution,Signal->Units))
+         GenError(LineNumber,"bad resolution",Fields[Columns[GEN_COLUMN_RESOLUTION]]);
+      if(!GenNumber(Fields[Columns[GEN_COLUMN_OFFSET]],Signal->Offset,NULL))
+         GenError(LineNumber,"bad offset",Fields[Columns[GEN_COLUMN_OFFSET]]);
+      if(!GenRange(Fields[Columns[GEN_COLUMN_RANGE]],Signal->Min,Signal->Max))
+         GenError(LineNumber,"bad range",Fields[Columns[GEN_COLUMN_RANGE]]);
+
+      g_GenSignalCount++;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////// DBC
+
+void GenReadDbc(FILE *File)
+{
+   char Line[2048], Name[GEN_NAME_SIZE], MessageName[GEN_NAME_SIZE], Order, Sign;
+   char Units[GEN_NAME_SIZE];
+   int LineNumber = 0, Start, Length, i;
+   unsigned long ID = 0, Value;
+   unsigned long Pf, Ps;
+   GEN_SIGNAL *Signal;
+   char *p;
+
+   MessageName[0] = 0;
+
+   while(fgets(Line,sizeof(Line),File) != NULL)
+   {
+      LineNumber++;
+      p = Line;
+      while(isspace((unsigned char)*p))
+         p++;
+
+      if(!strncmp(p,"BO_ ",4))
+      {
+         if(sscanf(p,"BO_ %lu %63[^: ]",&ID,MessageName) != 2)
+         {
+            GenError(LineNumber,"bad message",NULL);
+            continue;
+         }
+         if(!(ID & 0x80000000))
+            GenError(LineNumber,"not an extended (J1939) identifier, message",MessageName);
+         ID &= 0x1FFFFFFF;
+      }
+      else if(!strncmp(p,"SG_ ",4))
+      {
+         if(g_GenSignalCount >= GEN_MAX_SIGNALS)
+         {
+            GenError(LineNumber,"too many signals",NULL);
+            return;
+         }
+
+         Signal = &g_GenSignals[g_GenSignalCount];
+         memset(Signal,0,sizeof(GEN_SIGNAL));
+         Signal->Line = LineNumber;
+
+         Units[0] = 0;
+         if(sscanf(p,"SG_ %63s : %d|%d@%c%c (%lf,%lf) [%lf|%lf] \"%63[^\"]\"",Name,&Start,&Length,&Order,&Sign,
+                   &Signal->Resolution,&Signal->Offset,&Signal->Min,&Signal->Max,Units) < 9)
+         {
+            GenError(LineNumber,"bad or multiplexed signal",NULL);
+            continue;
+         }
+         if(Order != '1')
+         {
+            GenError(LineNumber,"Motorola byte order, J1939 is little endian (@1), signal",Name);
+            continue;
+         }
+         if(Sign != '+')
+            GenError(LineNumber,"signed signal, J1939 uses an offset, signal",Name);
+         if((Start < 0) || (Start > 63) || (Length < 1) || (Length > 32))
+            GenError(LineNumber,"bit position or length out of range, signal",Name);
+
+         Pf = (ID >> 16) & 0xFF;
+         Ps = (ID >> 8) & 0xFF;
+         Signal->PGN = ((ID >> 8) & 0x30000) | (Pf << 8) | ((Pf >= 240) ? Ps : 0);
+         Signal->StartBit = Start;
+         Signal->Length = Length;
+         GenIdentifier(MessageName,Signal->PgnName);
+         GenIdentifier(Name,Signal->SpnName);
+         GenCopy(Signal->Units,Units);
+
+         g_GenDbcSignals[g_GenSignalCount].ID = ID;
+         strcpy(g_GenDbcSignals[g_GenSignalCount].Name,Name);
+         g_GenSignalCount++;
+      }
+      else if(sscanf(p,"BA_ \"SPN\" SG_ %lu %63s %lu",&ID,Name,&Value) == 3)
+      {
+         for(i=0;i<g_GenSignalCount;i++)
+         {
+            if((g_GenDbcSignals[i].ID == (ID & 0x1FFFFFFF)) && !strcmp(g_GenDbcSignals[i].Name,Name))
+               g_GenSignals[i].SPN = Value;
+         }
+      }
+      else if(sscanf(p,"BA_ \"GenMsgCycleTime\" BO_ %lu %lu",&ID,&Value) == 2)
+      {
+         for(i=0;i<g_GenSignalCount;i++)
+         {
+            if(g_GenDbcSignals[i].ID == (ID & 0x1FFFFFFF))
+               g_GenSignals[i].Rate = Value;
+         }
+      }
+   }
+
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      if(g_GenSignals[i].SPN == 0)
+         GenError(g_GenSignals[i].Line,"no SPN attribute for signal",g_GenDbcSignals[i].Name);
+      if(g_GenSignals[i].Rate == 0)
+         GenError(g_GenSignals[i].Line,"no GenMsgCycleTime for the message of signal",g_GenDbcSignals[i].Name);
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////// Table
+
+//shift for SPN_MULT(), the smallest that makes resolution * 2^shift whole,
+//else the largest that keeps it at or below 65535
+uint8_t GenShift(double Resolution)
+{
+   double Mult;
+   uint8_t Shift, Largest = 0;
+
+   for(Shift=0;Shift<=47;Shift++)
+   {
+      Mult = ldexp(Resolution,Shift);
+      if(ceil(Mult) > 65535)
+         break;
+      if(fabs(Mult - floor(Mult + 0.5)) < 1e-9 * Mult)
+         return(Shift);
+      Largest = Shift;
+   }
+
+   return(Largest);
+}
+
+int GenCompare(const void *a, const void *b)
+{
+   const GEN_SIGNAL *x = (const GEN_SIGNAL *)a, *y = (const GEN_SIGNAL *)b;
+
+   if(x->PGN != y->PGN)
+      return((x->PGN < y->PGN) ? -1 : 1);
+   if(x->StartBit != y->StartBit)
+      return((x->StartBit < y->StartBit) ? -1 : 1);
+
+   return(x->Line - y->Line);
+}
+
+//same hash as SPN_PGN_HASH() in the generated header
+uint8_t GenHash(uint16_t PGN, uint8_t Mult, uint8_t Bits)
+{
+   return((uint8_t)((uint8_t)PGN * Mult + (uint8_t)(PGN >> 8)) >> (8 - Bits));
+}
+
+//finds the smallest table and a multiplier that give each PGN its own entry
+int GenPerfectHash(void)
+{
+   uint8_t Used[256];
+   uint16_t Bits, Mult, i;
+
+   for(Bits=1;(1 << Bits) < g_GenPgnCount;Bits++);
+
+   for(;Bits<=8;Bits++)
+   {
+      for(Mult=1;Mult<256;Mult+=2)
+      {
+         memset(Used,0,sizeof(Used));
+
+         for(i=0;i<g_GenPgnCount;i++)
+         {
+            if(Used[GenHash(g_GenPgns[i],Mult,Bits)]++)
+               break;
+         }
+
+         if(i == g_GenPgnCount)
+         {
+            g_GenHashBits = Bits;
+            g_GenHashMult = Mult;
+            return(TRUE);
+         }
+      }
+   }
+
+   return(FALSE);
+}
+
+void GenCheck(void)
+{
+   GEN_SIGNAL *Signal;
+   double Raw;
+   uint16_t i, j;
+
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      Signal = &g_GenSignals[i];
+
+      if(Signal->PGN > 0xFFFF)
+         GenError(Signal->Line,"PGN with data page set, g_SpnTable[] PGNs are 16 bits, SPN",Signal->SpnName);
+      if(Signal->StartBit + Signal->Length > 64)
+         GenError(Signal->Line,"field runs past byte 8, SPN",Signal->SpnName);
+      if((Signal->Length == 32) && (Signal->StartBit & 7))
+         GenError(Signal->Line,"32 bit field doesn't start on a byte, SPN",Signal->SpnName);
+
+      Raw = -Signal->Offset / Signal->Resolution;
+      if((Signal->Offset > 0) || (fabs(Raw - floor(Raw + 0.5)) > 1e-6 * (Raw + 1)) || (Raw > 4294967295.0))
+         GenError(Signal->Line,"offset must be 0 or negative and a whole number of resolutions, SPN",Signal->SpnName);
+
+      //SpnValue() returns int16_t, every raw value has to fit so reserved
+      //values can't wrap into Min to Max
+      if((Signal->Min < -32768) || (Signal->Max > 32767) || (Signal->Offset < -32768) ||
+         ((ldexp(1,Signal->Length) - 1) * Signal->Resolution + Signal->Offset >= 32768))
+         GenError(Signal->Line,"values don't fit 16 bits, SPN",Signal->SpnName);
+      if((uint64_t)Signal->Rate * 3 > 65535)
+         GenError(Signal->Line,"3 times the rate doesn't fit 16 bits of 1ms ticks, SPN",Signal->SpnName);
+
+      Signal->Shift = GenShift(Signal->Resolution);
+
+      for(j=0;j<i;j++)
+      {
+         if((g_GenSignals[j].PGN == Signal->PGN) && (g_GenSignals[j].SPN == Signal->SPN))
+            GenError(Signal->Line,"SPN repeated in the same PGN, SPN",Signal->SpnName);
+         if(!strcmp(g_GenSignals[j].SpnName,Signal->SpnName) && (g_GenSignals[j].SPN != Signal->SPN))
+            GenError(Signal->Line,"two SPNs with the same name",Signal->SpnName);
+         if(!strcmp(g_GenSignals[j].PgnName,Signal->PgnName) && (g_GenSignals[j].PGN != Signal->PGN))
+            GenError(Signal->Line,"two PGNs with the same name",Signal->PgnName);
+         if((g_GenSignals[j].PGN == Signal->PGN) && (g_GenSignals[j].Rate != Signal->Rate))
+            GenError(Signal->Line,"PGN has two rates",Signal->PgnName);
+      }
+   }
+
+   if(g_GenErrors)
+      return;
+
+   qsort(g_GenSignals,g_GenSignalCount,sizeof(GEN_SIGNAL),GenCompare);
+
+   g_GenPgnCount = 0;
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      if((i == 0) || (g_GenSignals[i].PGN != g_GenSignals[i - 1].PGN))
+         g_GenPgns[g_GenPgnCount++] = g_GenSignals[i].PGN;
+   }
+
+   if(!GenPerfectHash())
+   {
+      GenError(0,"no perfect hash for the PGNs",NULL);
+      return;
+   }
+
+   memset(g_GenHash,0xFF,sizeof(g_GenHash));
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      if((i == 0) || (g_GenSignals[i].PGN != g_GenSignals[i - 1].PGN))
+         g_GenHash[GenHash(g_GenSignals[i].PGN,g_GenHashMult,g_GenHashBits)] = i;
+   }
+}
+
+//writes a number for a C initializer, without an exponent so CCS reads it
+void GenDecimal(char *Out, double Value)
+{
+   size_t n;
+
+   sprintf(Out,"%.15f",Value);
+   n = strlen(Out);
+   while(Out[n - 1] == '0')
+      Out[--n] = 0;
+   if(Out[n - 1] == '.')
+      Out[--n] = 0;
+   if(!strcmp(Out,"-0"))
+      strcpy(Out,"0");
+}
+
+void GenWrite(FILE *Out, const char *Source)
+{
+   GEN_SIGNAL *Signal;
+   char Resolution[32], Offset[32], Min[32], Max[32], Name[GEN_NAME_SIZE + 8];
+   int PgnWidth = 0, SpnWidth = 0;
+   uint16_t i;
+
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      if((int)strlen(g_GenSignals[i].PgnName) > PgnWidth)
+         PgnWidth = strlen(g_GenSignals[i].PgnName);
+      if((int)strlen(g_GenSignals[i].SpnName) > SpnWidth)
+         SpnWidth = strlen(g_GenSignals[i].SpnName);
+   }
+   PgnWidth += 5;          //"PGN_" and ","
+   SpnWidth += 5;
+
+   fprintf(Out,"////////////////////////////////////////////////////////////////////////////////\n");
+   fprintf(Out,"////                          EX_J1939_SPN_TABLE.h                          ////\n");
+   fprintf(Out,"////                                                                        ////\n");
+   fprintf(Out,"//// SPN table for EX_J1939_SPN.c, generated by j1939-gen.cpp.  Change the  ////\n");
+   fprintf(Out,"//// source and generate it again instead of editing it.                    ////\n");
+   fprintf(Out,"////                                                                        ////\n");
+   fprintf(Out,"////    %-68s////\n",Source);
+   fprintf(Out,"////                                                                        ////\n");
+   fprintf(Out,"////////////////////////////////////////////////////////////////////////////////\n\n");
+
+   fprintf(Out,"//PGNs\n");
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      Signal = &g_GenSignals[i];
+      if((i == 0) || (Signal->PGN != g_GenSignals[i - 1].PGN))
+      {
+         sprintf(Name,"PGN_%s",Signal->PgnName);
+         fprintf(Out,"#define %-*s 0x%04X      //%u\n",PgnWidth,Name,Signal->PGN,Signal->PGN);
+      }
+   }
+
+   fprintf(Out,"\n//SPNs\n");
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      Signal = &g_GenSignals[i];
+      sprintf(Name,"SPN_%s",Signal->SpnName);
+      fprintf(Out,"#define %-*s %u\n",SpnWidth,Name,Signal->SPN);
+   }
+
+   fprintf(Out,"\n//Slot of each signal in g_SpnTable[] and g_SpnStore[]\nenum {\n");
+   for(i=0;i<g_GenSignalCount;i++)
+      fprintf(Out,"   SPN_SLOT_%s,\n",g_GenSignals[i].SpnName);
+   fprintf(Out,"   SPN_SLOTS\n};\n");
+
+   fprintf(Out,"\n//Decoded signals, sorted by PGN.  Rate is the PGN's transmission rate in ms.\n");
+   fprintf(Out,"const SPN_STRUCT g_SpnTable[] = {\n");
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      Signal = &g_GenSignals[i];
+      GenDecimal(Resolution,Signal->Resolution);
+      GenDecimal(Offset,Signal->Offset);
+      GenDecimal(Min,trunc(Signal->Min));
+      GenDecimal(Max,trunc(Signal->Max));
+      sprintf(Name,"PGN_%s,",Signal->PgnName);
+      fprintf(Out,"   SPN_ROW(%-*s ",PgnWidth,Name);
+      sprintf(Name,"SPN_%s,",Signal->SpnName);
+      fprintf(Out,"%-*s %2u, %2u, %10s, %2u, %6s, %6s, %6s, %5u),   //%s\n",SpnWidth,Name,Signal->StartBit,Signal->Length,
+              Resolution,Signal->Shift,Offset,Min,Max,Signal->Rate,Signal->Units);
+   }
+   fprintf(Out,"};\n");
+
+   fprintf(Out,"\n//PGNs decoded, for requesting them or setting up CAN filters\n");
+   fprintf(Out,"#define SPN_PGNS  %u\n\n",g_GenPgnCount);
+   fprintf(Out,"const uint16_t g_SpnPgnList[SPN_PGNS] = {\n");
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      if((i == 0) || (g_GenSignals[i].PGN != g_GenSignals[i - 1].PGN))
+         fprintf(Out,"   PGN_%s,\n",g_GenSignals[i].PgnName);
+   }
+   fprintf(Out,"};\n");
+
+   fprintf(Out,"\n//Perfect hash from PGN to its first row of g_SpnTable[], SPN_NOT_FOUND if\n");
+   fprintf(Out,"//no PGN hashes there.  The row's PGN still has to be compared.\n");
+   fprintf(Out,"#define SPN_PGN_HASH_BITS   %u\n",g_GenHashBits);
+   fprintf(Out,"#define SPN_PGN_HASH_MULT   %u\n",g_GenHashMult);
+   fprintf(Out,"#define SPN_PGN_HASH(pgn)   ((uint8_t)((uint8_t)(pgn) * SPN_PGN_HASH_MULT + (uint8_t)((pgn) >> 8)) >> (8 - SPN_PGN_HASH_BITS))\n\n");
+   fprintf(Out,"const uint8_t g_SpnPgnHash[1 << SPN_PGN_HASH_BITS] = {");
+   for(i=0;i<(1 << g_GenHashBits);i++)
+   {
+      if(g_GenHash[i] == 0xFF)
+         fprintf(Out,"%s%sSPN_NOT_FOUND",i ? "," : "",(i % 8) ? " " : "\n   ");
+      else
+         fprintf(Out,"%s%s%u",i ? "," : "",(i % 8) ? " " : "\n   ",g_GenHash[i]);
+   }
+   fprintf(Out,"\n};\n");
+}
+
+//////////////////////////////////////////////////////////////////////////////// Verify
+
+#if GEN_VERIFY == TRUE
+//what EX_J1939_SPN.c needs from the J1939 driver and CCS
+#define J1939_TICK_TYPE                uint32_t
+#define J1939_TICKS_PER_SECOND         1000
+#define J1939GetTick()                 ((uint32_t)0)
+#define J1939GetTickDifference(a,b)    ((uint32_t)((a) - (b)))
+#define J1939ProfileStart(probe)
+#define J1939ProfileStop(probe)
+
+typedef uint8_t int8;
+typedef uint16_t int16;
+
+#include "EX_J1939_SPN.c"
+
+uint32_t g_GenRandom = 1;
+
+uint32_t GenRandom(void)
+{
+   g_GenRandom ^= g_GenRandom << 13;
+   g_GenRandom ^= g_GenRandom >> 17;
+   g_GenRandom ^= g_GenRandom << 5;
+
+   return(g_GenRandom);
+}
+
+//reference status, J1939-71's reserved ranges worked out from the field's
+//largest value instead of its top byte
+uint8_t GenReferenceStatus(uint64_t Raw, uint8_t Length, int64_t Value, const GEN_SIGNAL *Signal)
+{
+   uint64_t Largest = ((uint64_t)1 << Length) - 1;
+   uint64_t Step = (Length >= 8) ? ((uint64_t)1 << (Length - 8)) : 1;
+
+   if(Length >= 8)
+   {
+      if(Raw >= Largest - Step + 1)
+         return(SPN_NOT_AVAILABLE);
+      if(Raw >= 0xFB * Step)
+         return(SPN_ERROR);
+   }
+   else if(Length >= 2)
+   {
+      if(Raw == Largest)
+         return(SPN_NOT_AVAILABLE);
+      if((Raw == Largest - 1) || ((Length >= 4) && (Raw >= Largest - 4)))
+         return(SPN_ERROR);
+   }
+
+   if((Value < (int64_t)trunc(Signal->Min)) || (Value > (int64_t)trunc(Signal->Max)))
+      return(SPN_ERROR);
+
+   return(SPN_VALID);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//GenVerify()
+// Checks the g_SpnTable[] compiled in against the source just read.  Each
+// row's layout is compared, then every raw value of fields up to 16 bits and
+// 65536 values of wider ones are put in messages of random data, stored with
+// SpnStorePGN() and compared with a reference decode done bit by bit in long
+// double.  Every 16 bit PGN is looked up through the hash.
+//  Parameters: None
+//  Returns:    Number of problems found
+////////////////////////////////////////////////////////////////////////////////
+int GenVerify(void)
+{
+   GEN_SIGNAL *Signal;
+   uint8_t Bytes[8], Status, Bit, Row;
+   uint64_t Raw, Values, Step, Field;
+   int64_t Value;
+   uint32_t Wrong, Rounded, PGN;
+   int Problems = 0, i;
+
+   if((g_GenSignalCount != SPN_TABLE_ENTRIES) || (SPN_SLOTS != SPN_TABLE_ENTRIES))
+   {
+      printf("%u signals in the source, %u rows and %u slots compiled in, generate the table again\n",
+             g_GenSignalCount,(unsigned)SPN_TABLE_ENTRIES,SPN_SLOTS);
+      return(1);
+   }
+
+   printf("%-6s %-5s %-4s %12s %10s %10s\n","pgn","spn","bits","values","wrong","rounded");
+
+   for(i=0;i<g_GenSignalCount;i++)
+   {
+      Signal = &g_GenSignals[i];
+
+      if((g_SpnTable[i].PGN != Signal->PGN) || (g_SpnTable[i].SPN != Signal->SPN) || (g_SpnTable[i].StartBit != Signal->StartBit) ||
+         (g_SpnTable[i].Length != Signal->Length) || (g_SpnTable[i].Min != (int16_t)trunc(Signal->Min)) ||
+         (g_SpnTable[i].Max != (int16_t)trunc(Signal->Max)) || (g_SpnTable[i].Timeout != SPN_TIMEOUT(Signal->Rate)))
+      {
+         printf("row %d (SPN %u) doesn't match line %d of the source\n",i,Signal->SPN,Signal->Line);
+         Problems++;
+         continue;
+      }
+
+      Values = (uint64_t)1 << Signal->Length;
+      Step = (Values > 0x10000) ? (Values >> 16) : 1;
+      Wrong = 0;
+      Rounded = 0;
+
+      for(Raw=0;Raw<Values;Raw+=Step)
+      {
+         Field = Raw + ((Step > 1) ? GenRandom() % Step : 0);
+
+         for(Bit=0;Bit<8;Bit++)
+            Bytes[Bit] = GenRandom();
+         for(Bit=0;Bit<Signal->Length;Bit++)
+         {
+            if((Field >> Bit) & 1)
+               Bytes[(Signal->StartBit + Bit) >> 3] |= 1 << ((Signal->StartBit + Bit) & 7);
+            else
+               Bytes[(Signal->StartBit + Bit) >> 3] &= ~(1 << ((Signal->StartBit + Bit) & 7));
+         }
+
+         SpnStorePGN(Signal->PGN,Bytes);
+
+         Value = (int64_t)truncl((long double)Field * Signal->Resolution + Signal->Offset);
+         Status = GenReferenceStatus(Field,Signal->Length,Value,Signal);
+
+         if(g_SpnStore[i].Status != Status)
+            Wrong++;
+         else if((Status == SPN_VALID) && (g_SpnStore[i].Value != Value))
+         {
+            if((Signal->Length > 16) && (llabs(g_SpnStore[i].Value - Value) == 1))
+               Rounded++;
+            else
+               Wrong++;
+         }
+      }
+
+      printf("%04X   %-5u %-4u %12llu %10u %10u\n",Signal->PGN,Signal->SPN,Signal->Length,(unsigned long long)(Values / Step),Wrong,Rounded);
+
+      if(Wrong)
+         Problems++;
+   }
+
+   Wrong = 0;
+   for(PGN=0;PGN<=0xFFFF;PGN++)
+   {
+      for(i=0;(i < g_GenSignalCount) && (g_GenSignals[i].PGN != PGN);i++);
+      Row = (i < g_GenSignalCount) ? i : SPN_NOT_FOUND;
+
+      if(SpnFindPGN(PGN) != Row)
+         Wrong++;
+   }
+   printf("PGN hash, 65536 PGNs, %u wrong\n",Wrong);
+   if(Wrong)
+      Problems++;
+
+   return(Problems);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////// Main
+
+int main(int argc, char *argv[])
+{
+   const char *OutName = NULL;
+   FILE *File, *Out;
+   int Verify = 0, i;
+   size_t n;
+
+   for(i=1;i<argc;i++)
+   {
+      if((i + 1 < argc) && !strcmp(argv[i],"-o"))
+         OutName = argv[++i];
+      else if(!strcmp(argv[i],"-verify"))
+         Verify = 1;
+      else if((argv[i][0] != '-') && (g_GenFileName == NULL))
+         g_GenFileName = argv[i];
+      else
+      {
+         fprintf(stderr,"unknown option %s\n",argv[i]);
+         return(2);
+      }
+   }
+
+   if(g_GenFileName == NULL)
+   {
+      fprintf(stderr,"usage: j1939-gen [-o header] [-verify] source.csv|source.dbc\n");
+      return(2);
+   }
+
+  #if GEN_VERIFY == FALSE
+   if(Verify)
+   {
+      fprintf(stderr,"-verify needs j1939-gen built with -DGEN_VERIFY=TRUE\n");
+      return(2);
+   }
+  #endif
+
+   File = fopen(g_GenFileName,"r");
+   if(File == NULL)
+   {
+      fprintf(stderr,"can't open %s\n",g_GenFileName);
+      return(2);
+   }
+
+   n = strlen(g_GenFileName);
+   if((n > 4) && !strcasecmp(g_GenFileName + n - 4,".dbc"))
+      GenReadDbc(File);
+   else
+      GenReadCsv(File);
+   fclose(File);
+
+   if(!g_GenErrors && (g_GenSignalCount == 0))
+      GenError(0,"no signals",NULL);
+   if(!g_GenErrors)
+      GenCheck();
+   if(g_GenErrors)
+      return(1);
+
+  #if GEN_VERIFY == TRUE
+   if(Verify)
+      return(GenVerify() ? 1 : 0);
+  #endif
+
+   if(OutName != NULL)
+   {
+      Out = fopen(OutName,"w");
+      if(Out == NULL)
+      {
+         fprintf(stderr,"can't write %s\n",OutName);
+         return(2);
+      }
+   }
+   else
+      Out = stdout;
+
+   GenWrite(Out,g_GenFileName);
+
+   if(Out != stdout)
+      fclose(Out);
+
+   return(0);
+}
@@ -0,0 +1,784 @@
+////////////////////////////////////////////////////////////////////////////////
+////                            j1939-replay.cpp                            ////
+////                                                                        ////
+//// Replays a CAN capture into the J1939 driver on a PC, through the host  ////
+//// CAN driver (can-host.c), to reproduce problems seen in the field.      ////
+//// Received messages are decoded with the EX_J1939 decoders               ////
+//// (EX_J1939_SPN.c), what the unit sends is counted and can be printed.   ////
+////                                                                        ////
+//// Capture formats, picked from the file:                                 ////
+////    candump    - "candump -l" logs, (1600000000.000000) can0 ID#data,   ////
+////                 and the default candump output, can0 ID [8] 01 02 ...  ////
+////    Vector ASC - "0.012345 1 18FEF200x Rx d 8 01 02 ...", base hex or   ////
+////                 dec                                                    ////
+////    PCAN TRC   - version 1.x and 2.x, data frames only                  ////
+////                                                                        ////
+//// The driver's tick follows the capture's time in every mode, so claim   ////
+//// and timeout behavior is the same however fast the capture is played.   ////
+//// The unit's main loop runs every -poll ms of capture time and gets the  ////
+//// frames received since the last pass.                                   ////
+////                                                                        ////
+////    -speed 1     play at the capture's own pace                         ////
+////    -speed 10    play 10 times faster (any factor)                      ////
+////    -speed 0     play as fast as possible (default), the summary is a   ////
+////                 throughput benchmark of the receive and decode paths   ////
+////                                                                        ////
+//// Build:                                                                 ////
+////    g++ -x c++ -O2 j1939-replay.cpp -o j1939-replay                     ////
+////                                                                        ////
+//// Run:                                                                   ////
+////    ./j1939-replay truck.asc                                            ////
+////    ./j1939-replay -speed 10 -address 0xF9 -v truck.log                 ////
+////    ./j1939-replay -bin truck.bin truck.log                             ////
+////                                                                        ////
+//// Options:                                                               ////
+////    -speed factor  -poll ms  -address unit's address  -repeat N         ////
+////    -v print messages received and frames sent                          ////
+////    -bin file  write the capture's extended frames as a j1939-bulk log  ////
+////               and exit                                                 ////
+////    -fuzz file write the capture as a j1939-fuzz seed input and exit    ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "can-host.h"
+
+void InitJ1939Address(void);
+void InitJ1939Name(void);
+
+//////////////////////////////////////////////////////////////////////////////// Tick Timer
+
+//capture time in ms since the first frame, set by the replay loop
+uint32_t g_ReplayTick;
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Settings
+
+//Following Macros used to initialize unit's J1939 Address and Name - Required
+#define J1939InitAddress()    InitJ1939Address()
+#define J1939InitName()       InitJ1939Name()
+
+//Following define selects the host CAN driver, can-host.c
+#define USE_HOST_CAN   TRUE
+
+//Following defines/macros used to associate the capture time to J1939 tick
+#define J1939GetTick()                 g_ReplayTick
+#define J1939GetTickDifference(a,b)    ((uint32_t)((a) - (b)))
+#define J1939_TICKS_PER_SECOND         1000
+#define J1939_TICK_TYPE                uint32_t
+
+//Include the J1939 driver
+#include "j1939.c"
+
+//CCS types used by EX_J1939's decoders
+typedef uint8_t int8;
+typedef uint16_t int16;
+
+#include "EX_J1939_SPN.c"
+
+uint8_t g_ReplayAddress = 0x80;
+
+//Function used to initialize this unit's J1939 Address
+void InitJ1939Address(void)
+{
+   g_MyJ1939Address = g_ReplayAddress;
+}
+
+//Function used to initialize this unit's J1939 Name
+void InitJ1939Name(void)
+{
+   J1939_NAME_FIELDS Fields;
+
+   memset(&Fields,0,sizeof(J1939_NAME_FIELDS));
+
+   Fields.IdentityNumber = 0x1FFFFF;      //largest Name, loses any contention so the capture isn't disturbed
+   Fields.ManufacturerCode = 0x7FF;
+   Fields.ArbitraryAddressCapable = TRUE;
+
+   J1939BuildName(&Fields,g_J1939Name);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Capture
+
+typedef struct _REPLAY_FRAME {
+   uint64_t Time;          //us from start of capture
+   can_host_frame Frame;
+} REPLAY_FRAME;
+
+REPLAY_FRAME *g_ReplayFrames;
+uint32_t g_ReplayFrameCount;
+uint32_t g_ReplayFrameSize;
+uint32_t g_ReplaySkipped;        //lines that looked like frames but couldn't be read
+
+#define REPLAY_FORMAT_CANDUMP    0
+#define REPLAY_FORMAT_ASC        1
+#define REPLAY_FORMAT_TRC        2
+
+void ReplayAddFrame(double Seconds, uint32_t ID, int1 Ext, uint8_t *Data, uint8_t Length)
+{
+   REPLAY_FRAME *p;
+
+   if(g_ReplayFrameCount >= g_ReplayFrameSize)
+   {
+      g_ReplayFrameSize = g_ReplayFrameSize ? g_ReplayFrameSize * 2 : 4096;
+      g_ReplayFrames = (REPLAY_FRAME *)realloc(g_ReplayFrames,g_ReplayFrameSize * sizeof(REPLAY_FRAME));
+      if(g_ReplayFrames == NULL)
+      {
+         fprintf(stderr,"out of memory\n");
+         exit(2);
+      }
+   }
+
+   p = &g_ReplayFrames[g_ReplayFrameCount++];
+   memset(p,0,sizeof(REPLAY_FRAME));
+
+   p->Time = (Seconds < 0) ? 0 : (uint64_t)(Seconds * 1e6 + 0.5);
+   p->Frame.id = ID & (Ext ? 0x1FFFFFFF : 0x7FF);
+   p->Frame.ext = Ext;
+   p->Frame.len = (Length > 8) ? 8 : Length;
+   memcpy(p->Frame.data,Data,p->Frame.len);
+}
+
+//reads hex bytes separated by spaces, returns number read
+uint8_t ReplayHexBytes(char **Token, int Count, uint8_t *Data, uint8_t Length)
+{
+   uint8_t i;
+   char *End;
+
+   for(i=0;(i < Length) && (i < 8) && (i < Count);i++)
+   {
+      Data[i] = (uint8_t)strtoul(Token[i],&End,16);
+      if(*End != 0)
+         break;
+   }
+
+   return(i);
+}
+
+//splits a line into tokens on spaces and tabs, returns number of tokens
+int ReplaySplit(char *Line, char **Token, int Max)
+{
+   int n = 0;
+
+   while(n < Max)
+   {
+      while(isspace((uint8_t)*Line))
+         Line++;
+      if(*Line == 0)
+         break;
+
+      Token[n++] = Line;
+      while((*Line != 0) && !isspace((uint8_t)*Line))
+         Line++;
+      if(*Line != 0)
+         *Line++ = 0;
+   }
+
+   return(n);
+}
+
+int1 ReplayIsHex(const char *s, int Length)
+{
+   int i;
+
+   for(i=0;i<Length;i++)
+      if(!isxdigit((uint8_t)s[i]))
+         return(FALSE);
+
+   return(s[Length] == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//ReplayCandump()
+// Reads a candump line, either "(seconds) can0 ID#data" from candump -l or
+// "can0 ID [len] data" from candump's default output (no time, frames are
+// 1ms apart).  An 8 digit ID is extended.
+//  Parameters: Line - line of the capture
+//              LineNumber - used for the time of frames without one
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void ReplayCandump(char *Line, uint32_t LineNumber)
+{
+   char *Token[80];
+   char *p, *Hash;
+   int n;
+   uint8_t Data[8], Length = 0;
+   double Seconds;
+
+   n = ReplaySplit(Line,Token,80);
+
+   if((n >= 3) && (Token[0][0] == '('))
+   {
+      Seconds = atof(Token[0] + 1);
+      Hash = strchr(Token[2],'#');
+      if(Hash == NULL)
+         return;
+      *Hash = 0;
+
+      if((Hash[1] == 'R') || (Hash[1] == '#'))     //remote and CAN FD frames
+         return;
+
+      if(!ReplayIsHex(Token[2],(int)strlen(Token[2])))
+      {
+         g_ReplaySkipped++;
+         return;
+      }
+
+      for(p=Hash+1;(Length < 8) && isxdigit((uint8_t)p[0]) && isxdigit((uint8_t)p[1]);p+=2)
+      {
+         sscanf(p,"%2hhx",&Data[Length]);
+         Length++;
+      }
+
+      ReplayAddFrame(Seconds,strtoul(Token[2],NULL,16),strlen(Token[2]) == 8,Data,Length);
+   }
+   else if((n >= 3) && (Token[2][0] == '[') && ReplayIsHex(Token[1],(int)strlen(Token[1])))
+   {
+      Length = (uint8_t)atoi(Token[2] + 1);
+      if(ReplayHexBytes(&Token[3],n - 3,Data,Length) != Length)
+      {
+         g_ReplaySkipped++;
+         return;
+      }
+
+      ReplayAddFrame(LineNumber / 1000.0,strtoul(Token[1],NULL,16),strlen(Token[1]) == 8,Data,Length);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//ReplayAsc()
+// Reads a Vector ASC line, "time channel ID[x] Rx|Tx d len data ...".  The ID
+// ends with x when extended and is in hex unless the header said base dec.
+//  Parameters: Line - line of the capture
+//              Decimal - TRUE if the header said base dec
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void ReplayAsc(char *Line, int1 Decimal)
+{
+   char *Token[80];
+   char *End;
+   int n, IDLength;
+   uint8_t Data[8], Length;
+   uint32_t ID;
+   int1 Ext;
+
+   n = ReplaySplit(Line,Token,80);
+
+   if((n < 6) || !isdigit((uint8_t)Token[0][0]) || (strcmp(Token[3],"Rx") && strcmp(Token[3],"Tx")) || strcmp(Token[4],"d"))
+      return;     //header, error frame, remote frame or event
+
+   IDLength = (int)strlen(Token[2]);
+   Ext = (IDLength > 1) && ((Token[2][IDLength - 1] == 'x') || (Token[2][IDLength - 1] == 'X'));
+   if(Ext)
+      Token[2][IDLength - 1] = 0;
+
+   ID = strtoul(Token[2],&End,Decimal ? 10 : 16);
+   if(*End != 0)
+   {
+      g_ReplaySkipped++;
+      return;
+   }
+
+   Length = (uint8_t)strtoul(Token[5],NULL,16);
+   if(ReplayHexBytes(&Token[6],n - 6,Data,Length) != ((Length > 8) ? 8 : Length))
+   {
+      g_ReplaySkipped++;
+      return;
+   }
+
+   ReplayAddFrame(atof(Token[0]),ID,Ext,Data,Length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//ReplayTrc()
+// Reads a PCAN TRC line, time is in ms.
+//    1.x   "1)  1059.9  Rx  18FEF200  8  01 02 ..."
+//    2.0   "1  1059.900 DT 18FEF200 Rx 8 01 02 ..."
+//    2.1   "1  1059.900 DT 1 18FEF200 Rx - 8 01 02 ..."
+// An 8 digit ID is extended, only data frames (DT, or Rx/Tx in 1.x) are read.
+//  Parameters: Line - line of the capture
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTrc(char *Line)
+{
+   char *Token[80];
+   int n, i, Direction, IDToken, LengthToken;
+   uint8_t Data[8], Length;
+
+   n = ReplaySplit(Line,Token,80);
+
+   if((n < 5) || !isdigit((uint8_t)Token[0][0]))
+      return;     //comment or header
+
+   for(Direction=2;Direction<n;Direction++)
+      if(!strcmp(Token[Direction],"Rx") || !strcmp(Token[Direction],"Tx"))
+         break;
+   if(Direction >= n - 1)
+      return;
+
+   if(Token[0][strlen(Token[0]) - 1] == ')')       //1.x
+   {
+      IDToken = Direction + 1;
+      LengthToken = Direction + 2;
+   }
+   else                                            //2.x
+   {
+      for(i=2;i<Direction;i++)
+         if(!strcmp(Token[i],"DT"))
+            break;
+      if(i == Direction)
+         return;     //not a data frame
+
+      IDToken = Direction - 1;
+      LengthToken = Direction + 1;
+      if((LengthToken < n) && !strcmp(Token[LengthToken],"-"))
+         LengthToken++;
+   }
+
+   if((LengthToken >= n) || !ReplayIsHex(Token[IDToken],(int)strlen(Token[IDToken])))
+   {
+      g_ReplaySkipped++;
+      return;
+   }
+
+   if(!isdigit((uint8_t)Token[LengthToken][0]))
+      return;     //RTR
+
+   Length = (uint8_t)atoi(Token[LengthToken]);
+   if(ReplayHexBytes(&Token[LengthToken + 1],n - LengthToken - 1,Data,Length) != ((Length > 8) ? 8 : Length))
+   {
+      g_ReplaySkipped++;
+      return;
+   }
+
+   ReplayAddFrame(atof(Token[1]) / 1000.0,strtoul(Token[IDToken],NULL,16),strlen(Token[IDToken]) == 8,Data,Length);
+}
+
+//reads the capture into g_ReplayFrames[], returns FALSE if it can't be opened
+int1 ReplayLoad(const char *FileName)
+{
+   FILE *File;
+   char Line[1024];
+   uint32_t LineNumber = 0, i;
+   int Format = REPLAY_FORMAT_CANDUMP;
+   int1 Decimal = FALSE;
+   const char *Extension;
+   uint64_t Start;
+
+   File = fopen(FileName,"r");
+   if(File == NULL)
+      return(FALSE);
+
+   Extension = strrchr(FileName,'.');
+   if(Extension && (!strcmp(Extension,".asc") || !strcmp(Extension,".ASC")))
+      Format = REPLAY_FORMAT_ASC;
+   else if(Extension && (!strcmp(Extension,".trc") || !strcmp(Extension,".TRC")))
+      Format = REPLAY_FORMAT_TRC;
+
+   while(fgets(Line,sizeof(Line),File))
+   {
+      LineNumber++;
+
+      if((LineNumber == 1) && !strncmp(Line,";$FILEVERSION",13))
+         Format = REPLAY_FORMAT_TRC;
+      else if((LineNumber == 1) && !strncmp(Line,"date ",5))
+         Format = REPLAY_FORMAT_ASC;
+
+      if(Format == REPLAY_FORMAT_ASC)
+      {
+         if(!strncmp(Line,"base ",5))
+            Decimal = (strstr(Line,"base dec") != NULL);
+         else
+            ReplayAsc(Line,Decimal);
+      }
+      else if(Format == REPLAY_FORMAT_TRC)
+         ReplayTrc(Line);
+      else
+         ReplayCandump(Line,LineNumber);
+   }
+
+   fclose(File);
+
+   if(g_ReplayFrameCount == 0)
+      return(TRUE);
+
+   //times from the first frame
+   Start = g_ReplayFrames[0].Time;
+   for(i=0;i<g_ReplayFrameCount;i++)
+      g_ReplayFrames[i].Time = (g_ReplayFrames[i].Time > Start) ? g_ReplayFrames[i].Time - Start : 0;
+
+   return(TRUE);
+}
+
+//Writes the extended frames of g_ReplayFrames[] as a binary log for
+//j1939-bulk.cpp, 16 byte records of time in ms, identifier and 8 data bytes
+//padded with 0xFF.  Returns number of frames written, or -1 if it can't.
+int32_t ReplayWriteBin(const char *FileName)
+{
+   FILE *File;
+   uint8_t Record[16];
+   uint32_t i, Time;
+   int32_t Count = 0;
+
+   File = fopen(FileName,"wb");
+   if(File == NULL)
+      return(-1);
+
+   for(i=0;i<g_ReplayFrameCount;i++)
+   {
+      if(!g_ReplayFrames[i].Frame.ext)
+         continue;
+
+      Time = (uint32_t)(g_ReplayFrames[i].Time / 1000);
+      memcpy(Record,&Time,4);
+      memcpy(Record + 4,&g_ReplayFrames[i].Frame.id,4);
+      memset(Record + 8,0xFF,8);
+      memcpy(Record + 8,g_ReplayFrames[i].Frame.data,g_ReplayFrames[i].Frame.len);
+
+      if(fwrite(Record,sizeof(Record),1,File) != 1)
+         break;
+      Count++;
+   }
+
+   if(fclose(File) || (i < g_ReplayFrameCount))
+      return(-1);
+
+   return(Count);
+}
+
+//Writes g_ReplayFrames[] as a seed input for j1939-fuzz.cpp, the unit's
+//address and Name, then a 15 byte record for each frame, received with a pass
+//of the main loop after it.  Gaps over 255 ms get tick only records.  Returns
+//number of records written, or -1 if it can't.
+int32_t ReplayWriteFuzz(const char *FileName)
+{
+   FILE *File;
+   uint8_t Record[15];
+   uint32_t i, Time, Previous = 0, Ticks;
+   int32_t Count = 0;
+
+   File = fopen(FileName,"wb");
+   if(File == NULL)
+      return(-1);
+
+   InitJ1939Name();
+   Record[0] = g_ReplayAddress;
+   memcpy(Record + 1,g_J1939Name,8);
+   if(fwrite(Record,9,1,File) != 1)
+   {
+      fclose(File);
+      return(-1);
+   }
+
+   for(i=0;i<g_ReplayFrameCount;i++)
+   {
+      Time = (uint32_t)(g_ReplayFrames[i].Time / 1000);
+      Ticks = Time - Previous;
+      Previous = Time;
+
+      memset(Record,0,sizeof(Record));
+      while(Ticks > 255)
+      {
+         Record[0] = 255;
+         Record[1] = 0x20;                                     //FUZZ_NO_FRAME
+         if(fwrite(Record,sizeof(Record),1,File) != 1)
+            break;
+         Ticks -= 255;
+         Count++;
+      }
+      if(Ticks > 255)
+         break;
+
+      Record[0] = (uint8_t)Ticks;
+      Record[1] = 0x08 | (g_ReplayFrames[i].Frame.ext ? 0x01 : 0) | (g_ReplayFrames[i].Frame.rtr ? 0x02 : 0);   //FUZZ_RUN, FUZZ_EXT, FUZZ_RTR
+      Record[2] = (uint8_t)(g_ReplayFrames[i].Frame.id >> 24);
+      Record[3] = (uint8_t)(g_ReplayFrames[i].Frame.id >> 16);
+      Record[4] = (uint8_t)(g_ReplayFrames[i].Frame.id >> 8);
+      Record[5] = (uint8_t)g_ReplayFrames[i].Frame.id;
+      Record[6] = g_ReplayFrames[i].Frame.len;
+      memcpy(Record + 7,g_ReplayFrames[i].Frame.data,8);
+
+      if(fwrite(Record,sizeof(Record),1,File) != 1)
+         break;
+      Count++;
+   }
+
+   if(fclose(File) || (i < g_ReplayFrameCount))
+      return(-1);
+
+   return(Count);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Replay CAN backend
+
+uint32_t g_ReplayNextFrame;      //next frame of the capture
+uint64_t g_ReplayNow;            //capture time in us the unit has reached
+int g_ReplayVerbose;
+
+//statistics
+uint32_t g_ReplayFramesIn, g_ReplayFramesOut, g_ReplayMessages, g_ReplaySignalsDecoded;
+
+//names of the SPN value store status
+const char *g_ReplayStatus[] = {"no data","valid","error","n/a","stale"};
+
+int1 ReplayCanInit(void *Context)
+{
+   (void)Context;
+   return(TRUE);
+}
+
+int1 ReplayCanGetd(void *Context, can_host_frame *Frame)
+{
+   (void)Context;
+
+   if((g_ReplayNextFrame >= g_ReplayFrameCount) || (g_ReplayFrames[g_ReplayNextFrame].Time > g_ReplayNow))
+      return(FALSE);
+
+   *Frame = g_ReplayFrames[g_ReplayNextFrame++].Frame;
+   g_ReplayFramesIn++;
+
+   return(TRUE);
+}
+
+int1 ReplayCanPutd(void *Context, can_host_frame *Frame)
+{
+   uint8_t i;
+
+   (void)Context;
+
+   g_ReplayFramesOut++;
+
+   if(g_ReplayVerbose)
+   {
+      printf("%10.3f tx %08X [%u]",g_ReplayNow / 1e6,Frame->id,Frame->len);
+      for(i=0;i<Frame->len;i++)
+         printf(" %02X",Frame->data[i]);
+      printf("\n");
+   }
+
+   return(TRUE);
+}
+
+int1 ReplayCanKbhit(void *Context)
+{
+   (void)Context;
+   return((g_ReplayNextFrame < g_ReplayFrameCount) && (g_ReplayFrames[g_ReplayNextFrame].Time <= g_ReplayNow));
+}
+
+int1 ReplayCanTbe(void *Context)
+{
+   (void)Context;
+   return(TRUE);
+}
+
+const can_host_ops ReplayCanOps = {
+   ReplayCanInit,
+   ReplayCanGetd,
+   ReplayCanPutd,
+   ReplayCanKbhit,
+   ReplayCanTbe,
+   NULL,
+   NULL,
+   NULL,
+   NULL
+};
+
+//////////////////////////////////////////////////////////////////////////////// Replay
+
+uint64_t ReplayWallTime(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC,&ts);
+
+   return((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+//one pass of the unit's main loop
+void ReplayTask(void)
+{
+   J1939_PDU_STRUCT PDU;
+   uint8_t Data[8];
+   uint8_t Length, i;
+   uint16_t PGN;
+   uint8_t Count;
+
+   J1939ReceiveTask();
+
+   while(J1939Kbhit())
+   {
+      J1939GetMessage(PDU,Data,Length);
+      g_ReplayMessages++;
+
+      if(g_ReplayVerbose)
+      {
+         printf("%10.3f rx PGN %02X%02X%02X SA %02X [%u]",g_ReplayNow / 1e6,PDU.DataPage,PDU.PDUFormat,
+                (PDU.PDUFormat < 240) ? 0 : PDU.DestinationAddress,PDU.SourceAddress,Length);
+         for(i=0;i<Length;i++)
+            printf(" %02X",Data[i]);
+         printf("\n");
+      }
+
+      PGN = ((uint16_t)PDU.PDUFormat << 8) | PDU.DestinationAddress;
+
+      Count = SpnStorePGN(PGN,Data);
+      g_ReplaySignalsDecoded += Count;
+
+      if(g_ReplayVerbose && Count)
+      {
+         for(i=SpnFindPGN(PGN);Count--;i++)
+            printf("%10.3f SPN %u = %d %s\n",g_ReplayNow / 1e6,g_SpnTable[i].SPN,g_SpnStore[i].Value,g_ReplayStatus[g_SpnStore[i].Status]);
+      }
+   }
+
+   J1939XmitTask();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//ReplayRun()
+// Plays the capture once.  The unit's main loop runs every Poll us of
+// capture time, skipping ahead over gaps in the capture.  With Speed not 0
+// each pass waits until its capture time, divided by Speed, has passed.
+//  Parameters: Poll - us of capture time between passes of the main loop
+//              Speed - 0 for as fast as possible, else times real time
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void ReplayRun(uint64_t Poll, double Speed)
+{
+   uint64_t WallStart, Due, Now;
+   struct timespec Sleep;
+
+   g_ReplayNextFrame = 0;
+   g_ReplayNow = 0;
+   g_ReplayTick = 0;
+
+   can_host_set_ops(&ReplayCanOps,NULL);
+   J1939Init();
+
+   WallStart = ReplayWallTime();
+
+   while(g_ReplayNextFrame < g_ReplayFrameCount)
+   {
+      if(Speed > 0)
+      {
+         Due = WallStart + (uint64_t)(g_ReplayNow * 1000 / Speed);
+         Now = ReplayWallTime();
+         if(Due > Now)
+         {
+            Sleep.tv_sec = (Due - Now) / 1000000000ULL;
+            Sleep.tv_nsec = (Due - Now) % 1000000000ULL;
+            nanosleep(&Sleep,NULL);
+         }
+      }
+
+      g_ReplayTick = (uint32_t)(g_ReplayNow / 1000);
+      ReplayTask();
+
+      g_ReplayNow += Poll;
+      if((g_ReplayNextFrame < g_ReplayFrameCount) && (g_ReplayFrames[g_ReplayNextFrame].Time > g_ReplayNow))
+         g_ReplayNow += (g_ReplayFrames[g_ReplayNextFrame].Time - g_ReplayNow) / Poll * Poll;   //skip passes with nothing to receive
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   const char *FileName = NULL, *BinName = NULL, *FuzzName = NULL;
+   double Speed = 0;
+   uint64_t Poll = 1000, Start, Elapsed;
+   uint32_t Repeat = 1, r;
+   int32_t n;
+   int i;
+
+   for(i=1;i<argc;i++)
+   {
+      if((i + 1 < argc) && !strcmp(argv[i],"-speed"))
+         Speed = atof(argv[++i]);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-poll"))
+         Poll = (uint64_t)(atof(argv[++i]) * 1000);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-address"))
+         g_ReplayAddress = (uint8_t)strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-repeat"))
+         Repeat = strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-bin"))
+         BinName = argv[++i];
+      else if((i + 1 < argc) && !strcmp(argv[i],"-fuzz"))
+         FuzzName = argv[++i];
+      else if(!strcmp(argv[i],"-v"))
+         g_ReplayVerbose = 1;
+      else if((argv[i][0] != '-') && (FileName == NULL))
+         FileName = argv[i];
+      else
+      {
+         fprintf(stderr,"unknown option %s\n",argv[i]);
+         return(2);
+      }
+   }
+
+   if((FileName == NULL) || (Poll == 0) || (Speed < 0) || (Repeat == 0))
+   {
+      fprintf(stderr,"usage: j1939-replay [-speed factor] [-poll ms] [-address n] [-repeat n] [-v] [-bin file] [-fuzz file] capture\n");
+      return(2);
+   }
+
+   if(!ReplayLoad(FileName))
+   {
+      fprintf(stderr,"can't open %s\n",FileName);
+      return(2);
+   }
+
+   if(g_ReplayFrameCount == 0)
+   {
+      fprintf(stderr,"no frames read from %s\n",FileName);
+      return(2);
+   }
+
+   if(BinName != NULL)
+   {
+      n = ReplayWriteBin(BinName);
+      if(n < 0)
+      {
+         fprintf(stderr,"can't write %s\n",BinName);
+         return(2);
+      }
+
+      printf("capture %s  frames %u  written to %s %d\n",FileName,g_ReplayFrameCount,BinName,n);
+      free(g_ReplayFrames);
+      return(0);
+   }
+
+   if(FuzzName != NULL)
+   {
+      n = ReplayWriteFuzz(FuzzName);
+      if(n < 0)
+      {
+         fprintf(stderr,"can't write %s\n",FuzzName);
+         return(2);
+      }
+
+      printf("capture %s  frames %u  written to %s %d\n",FileName,g_ReplayFrameCount,FuzzName,n);
+      free(g_ReplayFrames);
+      return(0);
+   }
+
+   Start = ReplayWallTime();
+   for(r=0;r<Repeat;r++)
+      ReplayRun(Poll,Speed);
+   Elapsed = ReplayWallTime() - Start;
+
+   printf("capture %s  frames %u  skipped lines %u  length %.3fs\n",FileName,g_ReplayFrameCount,g_ReplaySkipped,
+          g_ReplayFrames[g_ReplayFrameCount - 1].Time / 1e6);
+   printf("frames in %u  out %u  messages %u  signals %u  j1939 dropped %u  address %u %s\n",g_ReplayFramesIn,g_ReplayFramesOut,
+          g_ReplayMessages,g_ReplaySignalsDecoded,g_J1939ReceiveDropped,g_MyJ1939Address,
+          g_J1939Flags.AddressClaimed ? "claimed" : (g_J1939Flags.AddressCannotClaim ? "cannot claim" : "not claimed"));
+   printf("time %.3fs  %.0f frames/s  %.1f ns/frame  %.1fx real time\n",Elapsed / 1e9,g_ReplayFramesIn * 1e9 / (Elapsed ? Elapsed : 1),
+          (double)Elapsed / (g_ReplayFramesIn ? g_ReplayFramesIn : 1),
+          Repeat * (g_ReplayFrames[g_ReplayFrameCount - 1].Time / 1e6) / (Elapsed / 1e9));
+
+   free(g_ReplayFrames);
+
+   return(0);
+}
@@ -0,0 +1,234 @@
+////////////////////////////////////////////////////////////////////////////////
+////                            j1939-sim-node.h                            ////
+////                                                                        ////
+//// One node of the J1939 bus simulator (see j1939-sim.cpp).  Included     ////
+//// once for each node with SIM_NODE set to the node's number.  Each       ////
+//// include compiles its own copy of the J1939 driver and host CAN driver  ////
+//// in namespace sim_node_<SIM_NODE>, so every node has its own globals,   ////
+//// and connects it to the simulated bus through a can_host_ops backend.   ////
+//// With SIM_NODE_AUTO_BAUD defined the node is built with                 ////
+//// J1939_USE_AUTO_BAUD, see the baud scenario.                            ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#if (SIM_NODE < SIM_MAX_NODES) || defined(SIM_NODE_AUTO_BAUD)
+
+#undef _J1939_H
+#undef __CAN_HOST_LIB_DEFINES__
+
+namespace SIM_NAMESPACE(SIM_NODE) {
+
+#include "can-host.h"
+
+//tick of this node's clock
+static uint32_t SimNodeTick(void)
+{
+  #ifdef SIM_NODE_AUTO_BAUD
+   SimAutoBaudWait();   //J1939AutoBaud() loops in J1939Init(), the bus goes on meanwhile
+  #endif
+   return(SimTick(SIM_NODE));
+}
+
+void InitJ1939Address(void);
+void InitJ1939Name(void);
+
+#undef J1939_USE_AUTO_BAUD
+#ifdef SIM_NODE_AUTO_BAUD
+ #define J1939_USE_AUTO_BAUD   TRUE
+#endif
+
+#include "j1939.c"
+
+//Function used to initialize this unit's J1939 Address
+void InitJ1939Address(void)
+{
+   g_MyJ1939Address = g_SimNodes[SIM_NODE].PreferredAddress;
+}
+
+//Function used to initialize this unit's J1939 Name
+void InitJ1939Name(void)
+{
+   J1939_NAME_FIELDS Fields;
+
+   memset(&Fields,0,sizeof(J1939_NAME_FIELDS));
+
+   Fields.IdentityNumber = g_SimNodes[SIM_NODE].IdentityNumber;
+   Fields.ArbitraryAddressCapable = TRUE;
+
+   J1939BuildName(&Fields,g_J1939Name);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Simulated CAN backend
+
+static int1 SimCanInit(void *Context)
+{
+   (void)Context;
+   return(TRUE);
+}
+
+static int1 SimCanGetd(void *Context, can_host_frame *Frame)
+{
+   SIM_FRAME SimFrame;
+
+   (void)Context;
+
+   if(!SimBusGetd(SIM_NODE,&SimFrame))
+      return(FALSE);
+
+   Frame->id = SimFrame.ID;
+   memcpy(Frame->data,SimFrame.Data,8);
+   Frame->len = SimFrame.Length;
+   Frame->ext = SimFrame.Ext;
+   Frame->rtr = SimFrame.Rtr;
+
+   return(TRUE);
+}
+
+static int1 SimCanPutd(void *Context, can_host_frame *Frame)
+{
+   SIM_FRAME SimFrame;
+
+   (void)Context;
+
+   SimFrame.ID = Frame->id;
+   memcpy(SimFrame.Data,Frame->data,8);
+   SimFrame.Length = Frame->len;
+   SimFrame.Ext = Frame->ext;
+   SimFrame.Rtr = Frame->rtr;
+
+   return(SimBusPutd(SIM_NODE,&SimFrame));
+}
+
+static int1 SimCanKbhit(void *Context)
+{
+   (void)Context;
+   return(g_SimNodes[SIM_NODE].RxCount != 0);
+}
+
+static int1 SimCanTbe(void *Context)
+{
+   (void)Context;
+   return(g_SimNodes[SIM_NODE].TxCount < g_SimConfig.TxBuffers);
+}
+
+static void SimCanSetFilter(void *Context, uint8_t Filter, uint32_t Mask, uint32_t ID, int1 Ext)
+{
+   (void)Context;
+   SimBusSetFilter(SIM_NODE,Filter,Mask,ID,Ext);
+}
+
+static void SimCanSetMode(void *Context, CAN_OP_MODE Mode)
+{
+   (void)Context;
+
+   if(Mode == CAN_OP_CONFIG)
+      SimBusConfigMode(SIM_NODE);
+}
+
+static void SimCanSetBaud(void *Context, CAN_BAUD_RATE Baud)
+{
+   const uint32_t Rates[5] = {1000000, 500000, 250000, 200000, 125000};
+
+   (void)Context;
+   g_SimNodes[SIM_NODE].Baud = Rates[Baud];
+}
+
+static int1 SimCanRxInvalid(void *Context)
+{
+   (void)Context;
+
+   if(!g_SimNodes[SIM_NODE].RxInvalid)
+      return(FALSE);
+
+   g_SimNodes[SIM_NODE].RxInvalid = 0;
+   return(TRUE);
+}
+
+static const can_host_ops SimCanOps = {
+   SimCanInit,
+   SimCanGetd,
+   SimCanPutd,
+   SimCanKbhit,
+   SimCanTbe,
+   SimCanSetFilter,
+   SimCanSetMode,
+   SimCanSetBaud,
+   SimCanRxInvalid
+};
+
+//////////////////////////////////////////////////////////////////////////////// Node API
+
+static void SimNodeInit(void)
+{
+   can_host_set_ops(&SimCanOps,NULL);
+
+   J1939Init();
+}
+
+//one pass of the node's main loop
+static void SimNodePoll(void)
+{
+   SIM_NODE_STRUCT *Node = &g_SimNodes[SIM_NODE];
+   J1939_PDU_STRUCT PDU;
+   uint8_t Data[8];
+   uint8_t Length;
+   uint32_t Stamp;
+
+   J1939ReceiveTask();
+
+   while(J1939Kbhit())
+   {
+      J1939GetMessage(PDU,Data,Length);
+      Node->RxMessages++;
+   }
+
+   if((Node->SendPeriod != 0) && g_J1939Flags.AddressClaimed && (g_SimNow >= Node->NextSend))
+   {
+      Node->NextSend += Node->SendPeriod;
+      if(Node->NextSend <= g_SimNow)
+         Node->NextSend = g_SimNow + Node->SendPeriod;   //don't burst to catch up after the claim
+
+      PDU.Priority = J1939_PROPRIETARY_B_PRIORITY;
+      PDU.ExtendedDataPage = 0;
+      PDU.DataPage = 0;
+      PDU.PDUFormat = J1939_PF_PROPRIETARY_B;
+      PDU.DestinationAddress = (uint8_t)SIM_NODE;      //PDU Specific is group extension
+      PDU.SourceAddress = g_MyJ1939Address;
+
+      Stamp = (uint32_t)(g_SimNow / 1000);            //time queued in us, for latency
+      memcpy(Data,&Stamp,4);
+      memset(&Data[4],0xFF,4);
+
+      if(J1939PutMessage(PDU,Data,8))
+         Node->Sent++;
+      else
+         Node->PutFailed++;
+   }
+
+   J1939XmitTask();
+}
+
+static void SimNodeStatus(SIM_NODE_STATUS *Status)
+{
+   Status->Address = g_MyJ1939Address;
+   Status->Claimed = g_J1939Flags.AddressClaimed;
+   Status->CannotClaim = g_J1939Flags.AddressCannotClaim;
+   Status->ReceiveDropped = g_J1939ReceiveDropped;
+   Status->ReceiveOverflows = g_J1939ReceiveOverflows;
+  #if J1939_USE_AUTO_BAUD == TRUE
+   Status->AutoBaudRate = g_J1939AutoBaudRate;
+   Status->AutoBaudTicks = g_J1939AutoBaudTicks;
+  #else
+   Status->AutoBaudRate = 0xFF;
+   Status->AutoBaudTicks = 0;
+  #endif
+}
+
+static int SimNodeRegistered = SimRegisterNode(SIM_NODE,SimNodeInit,SimNodePoll,SimNodeStatus);
+
+}
+
+#endif
+
+#undef SIM_NODE
+#undef SIM_NODE_AUTO_BAUD
@@ -0,0 +1,1186 @@
+////////////////////////////////////////////////////////////////////////////////
+////                             j1939-sim.cpp                              ////
+////                                                                        ////
+//// Discrete event CAN bus simulator for tuning the J1939 driver on a PC.  ////
+//// Runs up to SIM_MAX_NODES copies of j1939.c, each with its own tick     ////
+//// clock (offset and drift), main loop rate and CAN receive and transmit  ////
+//// buffers, on one simulated bus.                                         ////
+////                                                                        ////
+//// The bus does bitwise arbitration on the identifier, counts stuff bits  ////
+//// of each frame, and can inject errors.  An error sends an error frame,  ////
+//// the transmitter retries, and error counters can take a node bus off.   ////
+//// Two transmitters sending the same identifier with different data       ////
+//// collide after arbitration like on a real bus.  Everything random       ////
+//// comes from -seed, so a run can be repeated exactly.                    ////
+////                                                                        ////
+//// Scenarios:                                                             ////
+////    claim - nodes power up within -powerup ms, many wanting the same    ////
+////            address, reports how long each took to claim                ////
+////    load  - nodes claim unique addresses then each sends an 8 byte      ////
+////            message at a rate giving -load percent bus load, reports    ////
+////            latency and lost messages                                   ////
+////    baud  - one more node, built with J1939_USE_AUTO_BAUD, powers up    ////
+////            listening to the load scenario's bus at 250K, 500K, 125K    ////
+////            and 1000K, at 100K which isn't in its list, and with no     ////
+////            traffic.  Checks the baud rate it found and that the ticks  ////
+////            it took are within the bound for each, exits 1 if not       ////
+////                                                                        ////
+//// Build, J1939 settings like J1939_RECEIVE_BUFFERS can be set with -D:   ////
+////    g++ -x c++ -O2 j1939-sim.cpp -o j1939-sim                           ////
+////                                                                        ////
+//// Run:                                                                   ////
+////    ./j1939-sim -scenario claim -nodes 40 -seed 1                       ////
+////    ./j1939-sim -scenario load -nodes 40 -load 90 -errors 100 -csv      ////
+////    ./j1939-sim -scenario baud -nodes 10 -load 30                       ////
+////                                                                        ////
+//// Options:                                                               ////
+////    -scenario claim|load|baud  -nodes N  -seed N  -baud N               ////
+////    -load percent  -errors frames with an error per million             ////
+////    -rxbuffers N                                                        ////
+////    -txbuffers N  -poll us  -powerup ms  -time seconds  -csv            ////
+////    -config us, time the CAN module doesn't receive after each switch   ////
+////    to Config mode, to compare frames lost moving the address filter    ////
+////    with J1939_HITLESS_FILTER TRUE and FALSE (rx config lost)           ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+//Most nodes that can be simulated, each one is a copy of the J1939 driver
+#ifndef SIM_MAX_NODES
+#define SIM_MAX_NODES         64
+#endif
+
+#define SIM_BUFFERS_MAX       16       //most CAN receive or transmit buffers per node
+#define SIM_LATENCY_BIN_NS    100000   //latency histogram, 100us bins up to 100ms
+#define SIM_LATENCY_BINS      1000
+
+#define SIM_ERROR_FRAME_BITS  17       //error flag, error delimiter and intermission
+#define SIM_FRAME_END_BITS    13       //CRC delimiter, ACK, EOF and intermission
+#define SIM_BUS_OFF_BITS      (128 * 11)
+#define SIM_SUSPEND_BITS      8        //suspend transmission of an error passive node
+
+#define SIM_SCENARIO_CLAIM    0
+#define SIM_SCENARIO_LOAD     1
+#define SIM_SCENARIO_BAUD     2
+
+//node built with J1939_USE_AUTO_BAUD, after the others and only run by the baud scenario
+#define SIM_AUTO_BAUD_NODE    SIM_MAX_NODES
+#define SIM_AUTO_BAUD_POLL    100000      //time round J1939AutoBaud()'s loop, ns
+#define SIM_AUTO_BAUD_SETTLE  1000000000  //bus runs this long before the node powers up, ns
+#define SIM_AUTO_BAUD_FRAME_BITS 160      //longest frame with stuff bits, EOF and intermission
+
+//////////////////////////////////////////////////////////////////////////////// Simulator types
+
+typedef uint64_t SIM_TIME;    //nanoseconds
+
+typedef struct _SIM_FRAME {
+   uint32_t ID;
+   uint8_t Data[8];
+   uint8_t Length;
+   uint8_t Ext;
+   uint8_t Rtr;
+} SIM_FRAME;
+
+typedef struct _SIM_FILTER {
+   uint32_t ID;
+   uint32_t Mask;
+   uint8_t Ext;
+} SIM_FILTER;
+
+typedef struct _SIM_NODE_STATUS {
+   uint8_t Address;
+   uint8_t Claimed;
+   uint8_t CannotClaim;
+   uint16_t ReceiveDropped;
+   uint16_t ReceiveOverflows;
+   uint8_t AutoBaudRate;
+   uint32_t AutoBaudTicks;
+} SIM_NODE_STATUS;
+
+typedef struct _SIM_NODE_STRUCT {
+   //settings
+   uint8_t PreferredAddress;
+   uint32_t IdentityNumber;
+   SIM_TIME PowerUp;
+   SIM_TIME ClockOffset;
+   int32_t DriftPpm;
+   SIM_TIME SendPeriod;
+
+   //state
+   uint8_t Powered;
+   SIM_TIME NextPoll;
+   SIM_TIME NextSend;
+   SIM_FRAME Tx[SIM_BUFFERS_MAX];      //CAN transmit buffers, sent in order
+   uint8_t TxCount;
+   SIM_FRAME Rx[SIM_BUFFERS_MAX];      //CAN receive buffers
+   uint8_t RxNextIn, RxNextOut, RxCount;
+   SIM_FILTER Filter[6];
+   uint16_t TEC, REC;
+   uint8_t BusOff;
+   SIM_TIME RecoverAt;
+   SIM_TIME SuspendUntil;              //error passive, waits 8 bits after sending
+   SIM_TIME ConfigUntil;               //CAN module in Config mode, not receiving
+   uint32_t Baud;                      //CAN module's baud rate if set_baud changed it, else 0
+   uint8_t RxInvalid;                  //frame seen at the wrong baud rate, cleared by rx_invalid
+
+   //metrics
+   uint8_t Claimed;
+   SIM_TIME ClaimTime;
+   uint32_t Sent, PutFailed, TxFrames, RxFrames, RxMessages, RxOverflows, RxConfigLost, RxInvalidFrames;
+   uint32_t TxErrors, BusOffs;
+   uint32_t LatencyCount;
+   uint64_t LatencySum;
+   SIM_TIME LatencyMax;
+   uint32_t LatencyBins[SIM_LATENCY_BINS];
+} SIM_NODE_STRUCT;
+
+typedef struct _SIM_CONFIG {
+   int Scenario;
+   int Nodes;
+   uint64_t Seed;
+   uint32_t Baud;
+   uint32_t LoadPercent;
+   uint32_t ErrorPpm;
+   uint8_t RxBuffers;
+   uint8_t TxBuffers;
+   SIM_TIME Poll;
+   SIM_TIME PowerUpWindow;
+   SIM_TIME ConfigWindow;              //time each CAN Config mode switch stops receiving
+   SIM_TIME Duration;
+   int Csv;
+} SIM_CONFIG;
+
+typedef struct _SIM_NODE_API {
+   void (*Init)(void);
+   void (*Poll)(void);
+   void (*Status)(SIM_NODE_STATUS *Status);
+} SIM_NODE_API;
+
+//////////////////////////////////////////////////////////////////////////////// Global variables
+
+SIM_CONFIG g_SimConfig;
+SIM_NODE_STRUCT g_SimNodes[SIM_MAX_NODES + 1];   //last is SIM_AUTO_BAUD_NODE
+SIM_NODE_API g_SimNodeApi[SIM_MAX_NODES + 1];
+SIM_TIME g_SimNow;
+SIM_TIME g_SimBitTime;
+uint64_t g_SimRandom;
+
+//bus, frame being sent and what happens when it ends
+struct {
+   uint8_t Busy;
+   SIM_TIME FreeAt;
+   SIM_TIME BusyTime;
+   SIM_FRAME Frame;
+   uint8_t Transmitter[SIM_MAX_NODES];
+   uint8_t TransmitterCount;
+   uint8_t Error;
+   uint32_t Frames;
+   uint32_t ErrorFrames;
+   uint32_t Collisions;
+} g_SimBus;
+
+//////////////////////////////////////////////////////////////////////////////// Prototypes
+
+uint32_t SimTick(int Node);
+uint8_t SimBusGetd(int Node, SIM_FRAME *Frame);
+uint8_t SimBusPutd(int Node, SIM_FRAME *Frame);
+void SimBusSetFilter(int Node, uint8_t Filter, uint32_t Mask, uint32_t ID, uint8_t Ext);
+void SimBusConfigMode(int Node);
+void SimAutoBaudWait(void);
+int SimRegisterNode(int Node, void (*Init)(void), void (*Poll)(void), void (*Status)(SIM_NODE_STATUS *Status));
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Settings
+
+//Following Macros used to initialize unit's J1939 Address and Name - Required
+#define J1939InitAddress()    InitJ1939Address()
+#define J1939InitName()       InitJ1939Name()
+
+//Following define selects the host CAN driver, can-host.c
+#define USE_HOST_CAN   TRUE
+
+//Following defines/macros used to associate the node's tick to J1939 tick
+#define J1939GetTick()                 SimNodeTick()
+#define J1939GetTickDifference(a,b)    ((uint32_t)((a) - (b)))
+#define J1939_TICKS_PER_SECOND         1000
+#define J1939_TICK_TYPE                uint32_t
+
+//Following defines connect the J1939 error supervisor to the node's simulated
+//error counters, SIM_NODE is the node being compiled
+#define J1939_USE_ERROR_SUPERVISOR     TRUE
+#define J1939CanBusOff()               (g_SimNodes[SIM_NODE].BusOff)
+#define J1939CanErrorPassive()         ((g_SimNodes[SIM_NODE].TEC >= 128) || (g_SimNodes[SIM_NODE].REC >= 128))
+#define J1939CanErrorWarning()         ((g_SimNodes[SIM_NODE].TEC >= 96) || (g_SimNodes[SIM_NODE].REC >= 96))
+
+//////////////////////////////////////////////////////////////////////////////// Nodes
+
+#define SIM_CAT(a,b)          a##b
+#define SIM_NAMESPACE(n)      SIM_CAT(sim_node_,n)
+
+#define SIM_NODE 0
+#include "j1939-sim-node.h"
+#define SIM_NODE 1
+#include "j1939-sim-node.h"
+#define SIM_NODE 2
+#include "j1939-sim-node.h"
+#define SIM_NODE 3
+#include "j1939-sim-node.h"
+#define SIM_NODE 4
+#include "j1939-sim-node.h"
+#define SIM_NODE 5
+#include "j1939-sim-node.h"
+#define SIM_NODE 6
+#include "j1939-sim-node.h"
+#define SIM_NODE 7
+#include "j1939-sim-node.h"
+#define SIM_NODE 8
+#include "j1939-sim-node.h"
+#define SIM_NODE 9
+#include "j1939-sim-node.h"
+#define SIM_NODE 10
+#include "j1939-sim-node.h"
+#define SIM_NODE 11
+#include "j1939-sim-node.h"
+#define SIM_NODE 12
+#include "j1939-sim-node.h"
+#define SIM_NODE 13
+#include "j1939-sim-node.h"
+#define SIM_NODE 14
+#include "j1939-sim-node.h"
+#define SIM_NODE 15
+#include "j1939-sim-node.h"
+#define SIM_NODE 16
+#include "j1939-sim-node.h"
+#define SIM_NODE 17
+#include "j1939-sim-node.h"
+#define SIM_NODE 18
+#include "j1939-sim-node.h"
+#define SIM_NODE 19
+#include "j1939-sim-node.h"
+#define SIM_NODE 20
+#include "j1939-sim-node.h"
+#define SIM_NODE 21
+#include "j1939-sim-node.h"
+#define SIM_NODE 22
+#include "j1939-sim-node.h"
+#define SIM_NODE 23
+#include "j1939-sim-node.h"
+#define SIM_NODE 24
+#include "j1939-sim-node.h"
+#define SIM_NODE 25
+#include "j1939-sim-node.h"
+#define SIM_NODE 26
+#include "j1939-sim-node.h"
+#define SIM_NODE 27
+#include "j1939-sim-node.h"
+#define SIM_NODE 28
+#include "j1939-sim-node.h"
+#define SIM_NODE 29
+#include "j1939-sim-node.h"
+#define SIM_NODE 30
+#include "j1939-sim-node.h"
+#define SIM_NODE 31
+#include "j1939-sim-node.h"
+#define SIM_NODE 32
+#include "j1939-sim-node.h"
+#define SIM_NODE 33
+#include "j1939-sim-node.h"
+#define SIM_NODE 34
+#include "j1939-sim-node.h"
+#define SIM_NODE 35
+#include "j1939-sim-node.h"
+#define SIM_NODE 36
+#include "j1939-sim-node.h"
+#define SIM_NODE 37
+#include "j1939-sim-node.h"
+#define SIM_NODE 38
+#include "j1939-sim-node.h"
+#define SIM_NODE 39
+#include "j1939-sim-node.h"
+#define SIM_NODE 40
+#include "j1939-sim-node.h"
+#define SIM_NODE 41
+#include "j1939-sim-node.h"
+#define SIM_NODE 42
+#include "j1939-sim-node.h"
+#define SIM_NODE 43
+#include "j1939-sim-node.h"
+#define SIM_NODE 44
+#include "j1939-sim-node.h"
+#define SIM_NODE 45
+#include "j1939-sim-node.h"
+#define SIM_NODE 46
+#include "j1939-sim-node.h"
+#define SIM_NODE 47
+#include "j1939-sim-node.h"
+#define SIM_NODE 48
+#include "j1939-sim-node.h"
+#define SIM_NODE 49
+#include "j1939-sim-node.h"
+#define SIM_NODE 50
+#include "j1939-sim-node.h"
+#define SIM_NODE 51
+#include "j1939-sim-node.h"
+#define SIM_NODE 52
+#include "j1939-sim-node.h"
+#define SIM_NODE 53
+#include "j1939-sim-node.h"
+#define SIM_NODE 54
+#include "j1939-sim-node.h"
+#define SIM_NODE 55
+#include "j1939-sim-node.h"
+#define SIM_NODE 56
+#include "j1939-sim-node.h"
+#define SIM_NODE 57
+#include "j1939-sim-node.h"
+#define SIM_NODE 58
+#include "j1939-sim-node.h"
+#define SIM_NODE 59
+#include "j1939-sim-node.h"
+#define SIM_NODE 60
+#include "j1939-sim-node.h"
+#define SIM_NODE 61
+#include "j1939-sim-node.h"
+#define SIM_NODE 62
+#include "j1939-sim-node.h"
+#define SIM_NODE 63
+#include "j1939-sim-node.h"
+#define SIM_NODE SIM_AUTO_BAUD_NODE
+#define SIM_NODE_AUTO_BAUD
+#include "j1939-sim-node.h"
+
+//////////////////////////////////////////////////////////////////////////////// Random
+
+//xorshift64*, the only source of randomness so runs repeat from -seed
+uint32_t SimRandom(void)
+{
+   g_SimRandom ^= g_SimRandom >> 12;
+   g_SimRandom ^= g_SimRandom << 25;
+   g_SimRandom ^= g_SimRandom >> 27;
+
+   return((uint32_t)((g_SimRandom * 0x2545F4914F6CDD1DULL) >> 32));
+}
+
+//////////////////////////////////////////////////////////////////////////////// Node clock
+
+////////////////////////////////////////////////////////////////////////////////
+//SimTick()
+// Node's J1939 tick in ms, its clock starts at a random offset when it powers
+// up and runs fast or slow by its drift.
+//  Parameters: Node - node number
+//  Returns:    uint32_t - node's tick
+////////////////////////////////////////////////////////////////////////////////
+uint32_t SimTick(int Node)
+{
+   SIM_NODE_STRUCT *p = &g_SimNodes[Node];
+   SIM_TIME Elapsed;
+
+   Elapsed = g_SimNow - p->PowerUp;
+   Elapsed = Elapsed + (SIM_TIME)((int64_t)Elapsed / 1000000 * p->DriftPpm);
+
+   return((uint32_t)((Elapsed + p->ClockOffset) / 1000000));
+}
+
+int SimRegisterNode(int Node, void (*Init)(void), void (*Poll)(void), void (*Status)(SIM_NODE_STATUS *Status))
+{
+   g_SimNodeApi[Node].Init = Init;
+   g_SimNodeApi[Node].Poll = Poll;
+   g_SimNodeApi[Node].Status = Status;
+
+   return(Node);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Frame bits
+
+////////////////////////////////////////////////////////////////////////////////
+//SimFrameBits()
+// Builds a frame's bits from Start Of Frame to the end of the CRC, before bit
+// stuffing.
+//  Parameters: Frame - frame to build
+//              Bits - filled with one bit per byte, at least 118 bytes
+//              Arbitration - set to number of bits through the arbitration
+//                            field
+//  Returns:    int - number of bits
+////////////////////////////////////////////////////////////////////////////////
+int SimFrameBits(SIM_FRAME *Frame, uint8_t *Bits, int *Arbitration)
+{
+   int n = 0, i, j;
+   uint16_t Crc = 0;
+   uint8_t Length;
+
+   #define SIM_PUT_BITS(Value,Count)   for(i=(Count)-1;i>=0;i--) Bits[n++] = ((Value) >> i) & 1
+
+   Length = (Frame->Length > 8) ? 8 : Frame->Length;
+
+   Bits[n++] = 0;                                  //SOF
+   if(Frame->Ext)
+   {
+      SIM_PUT_BITS(Frame->ID >> 18, 11);
+      Bits[n++] = 1;                               //SRR
+      Bits[n++] = 1;                               //IDE
+      SIM_PUT_BITS(Frame->ID & 0x3FFFF, 18);
+      Bits[n++] = Frame->Rtr;
+      *Arbitration = n;
+      Bits[n++] = 0;                               //r1
+      Bits[n++] = 0;                               //r0
+   }
+   else
+   {
+      SIM_PUT_BITS(Frame->ID, 11);
+      Bits[n++] = Frame->Rtr;
+      *Arbitration = n;
+      Bits[n++] = 0;                               //IDE
+      Bits[n++] = 0;                               //r0
+   }
+   SIM_PUT_BITS(Length, 4);
+   if(!Frame->Rtr)
+      for(j=0;j<Length;j++)
+         SIM_PUT_BITS(Frame->Data[j], 8);
+
+   for(j=0;j<n;j++)                                //CRC-15, polynomial 0x4599
+   {
+      if(((Crc >> 14) & 1) ^ Bits[j])
+         Crc = (Crc << 1) ^ 0x4599;
+      else
+         Crc <<= 1;
+   }
+   SIM_PUT_BITS(Crc & 0x7FFF, 15);
+
+   #undef SIM_PUT_BITS
+
+   return(n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//SimStuffedBits()
+// Counts the bits sent for the first Count bits of a frame, a stuff bit is
+// added after 5 bits the same.
+//  Parameters: Bits - frame's bits from SimFrameBits()
+//              Count - number of bits
+//  Returns:    int - bits sent including stuff bits
+////////////////////////////////////////////////////////////////////////////////
+int SimStuffedBits(uint8_t *Bits, int Count)
+{
+   int i, Run = 0, Stuffed = 0;
+   uint8_t Last = 2;
+
+   for(i=0;i<Count;i++)
+   {
+      if(Bits[i] == Last)
+         Run++;
+      else
+      {
+         Last = Bits[i];
+         Run = 1;
+      }
+
+      if(Run == 5)
+      {
+         Stuffed++;
+         Last = !Last;                             //stuff bit starts the next run
+         Run = 1;
+      }
+   }
+
+   return(Count + Stuffed);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Node CAN hardware
+
+uint8_t SimBusGetd(int Node, SIM_FRAME *Frame)
+{
+   SIM_NODE_STRUCT *p = &g_SimNodes[Node];
+
+   if(p->RxCount == 0)
+      return(0);
+
+   *Frame = p->Rx[p->RxNextOut];
+   if(++p->RxNextOut >= g_SimConfig.RxBuffers)
+      p->RxNextOut = 0;
+   p->RxCount--;
+
+   return(1);
+}
+
+uint8_t SimBusPutd(int Node, SIM_FRAME *Frame)
+{
+   SIM_NODE_STRUCT *p = &g_SimNodes[Node];
+
+   if(p->TxCount >= g_SimConfig.TxBuffers)
+      return(0);
+
+   p->Tx[p->TxCount++] = *Frame;
+
+   return(1);
+}
+
+void SimBusSetFilter(int Node, uint8_t Filter, uint32_t Mask, uint32_t ID, uint8_t Ext)
+{
+   if(Filter >= 6)
+      return;
+
+   g_SimNodes[Node].Filter[Filter].ID = ID;
+   g_SimNodes[Node].Filter[Filter].Mask = Mask;
+   g_SimNodes[Node].Filter[Filter].Ext = Ext;
+}
+
+//node's CAN module went to Config mode, it misses frames for -config us
+void SimBusConfigMode(int Node)
+{
+   g_SimNodes[Node].ConfigUntil = g_SimNow + g_SimConfig.ConfigWindow;
+}
+
+//frame goes into node's receive buffers if it passes one of its filters
+void SimBusReceive(int Node, SIM_FRAME *Frame)
+{
+   SIM_NODE_STRUCT *p = &g_SimNodes[Node];
+   int i;
+
+   if(p->REC > 0)
+      p->REC--;
+
+   for(i=0;i<6;i++)
+      if((p->Filter[i].Ext == Frame->Ext) && (((Frame->ID ^ p->Filter[i].ID) & p->Filter[i].Mask) == 0))
+         break;
+
+   if(i == 6)
+      return;
+
+   if(g_SimNow < p->ConfigUntil)
+   {
+      p->RxConfigLost++;
+      return;
+   }
+
+   p->RxFrames++;
+
+   if(p->RxCount >= g_SimConfig.RxBuffers)
+   {
+      p->RxOverflows++;
+      return;
+   }
+
+   p->Rx[p->RxNextIn] = *Frame;
+   if(++p->RxNextIn >= g_SimConfig.RxBuffers)
+      p->RxNextIn = 0;
+   p->RxCount++;
+}
+
+//////////////////////////////////////////////////////////////////////////////// Bus
+
+////////////////////////////////////////////////////////////////////////////////
+//SimBusStart()
+// Starts a frame if any node has one waiting.  The bits of the waiting frames
+// are compared one at a time, a node sending recessive (1) while another
+// sends dominant (0) stops.  In the arbitration field it has lost
+// arbitration and tries again later, after it (same ID, different data) it's
+// a bit error and everyone sending gets an error frame.  A frame may also get
+// an injected error at a random bit.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void SimBusStart(void)
+{
+   static uint8_t Bits[SIM_MAX_NODES][128];
+   static int Count[SIM_MAX_NODES], Arbitration[SIM_MAX_NODES];
+   uint8_t Sending[SIM_MAX_NODES];
+   int Node, Sent = 0, Left, Bit, i, ErrorBit = -1, Winner = -1;
+   uint8_t Bus;
+   SIM_TIME Bits_;
+
+   for(Node=0;Node<g_SimConfig.Nodes;Node++)
+   {
+      Sending[Node] = g_SimNodes[Node].Powered && !g_SimNodes[Node].BusOff && (g_SimNodes[Node].TxCount > 0) &&
+                      (g_SimNow >= g_SimNodes[Node].SuspendUntil);
+      if(Sending[Node])
+      {
+         Count[Node] = SimFrameBits(&g_SimNodes[Node].Tx[0],Bits[Node],&Arbitration[Node]);
+         Sent++;
+      }
+   }
+
+   if(Sent == 0)
+      return;
+
+   Left = Sent;
+   for(Bit=0;(Left > 0) && (ErrorBit < 0);Bit++)
+   {
+      Bus = 1;
+      for(Node=0;Node<g_SimConfig.Nodes;Node++)
+         if(Sending[Node] && (Bit < Count[Node]) && (Bits[Node][Bit] == 0))
+            Bus = 0;
+
+      for(Node=0;Node<g_SimConfig.Nodes;Node++)
+      {
+         if(!Sending[Node])
+            continue;
+
+         if(Bit >= Count[Node])
+            Left--;                                //sent all its bits
+         else if((Bits[Node][Bit] == 1) && (Bus == 0))
+         {
+            if(Bit < Arbitration[Node])
+            {
+               Sending[Node] = 0;                  //lost arbitration
+               Left--;
+            }
+            else
+               ErrorBit = Bit;                     //same ID, different data
+         }
+      }
+
+      if(Left <= 0)
+         break;
+      Left = 0;
+      for(Node=0;Node<g_SimConfig.Nodes;Node++)
+         if(Sending[Node] && (Bit + 1 < Count[Node]))
+            Left++;
+   }
+
+   g_SimBus.TransmitterCount = 0;
+   for(Node=0;Node<g_SimConfig.Nodes;Node++)
+   {
+      if(Sending[Node])
+      {
+         g_SimBus.Transmitter[g_SimBus.TransmitterCount++] = Node;
+         if(Winner < 0)
+            Winner = Node;
+      }
+   }
+
+   g_SimBus.Frame = g_SimNodes[Winner].Tx[0];
+
+   if(ErrorBit >= 0)
+   {
+      g_SimBus.Collisions++;
+      Bits_ = SimStuffedBits(Bits[Winner],ErrorBit + 1) + SIM_ERROR_FRAME_BITS;
+      g_SimBus.Error = 1;
+   }
+   else if((g_SimConfig.ErrorPpm != 0) && ((SimRandom() % 1000000) < g_SimConfig.ErrorPpm))
+   {
+      i = SimStuffedBits(Bits[Winner],Count[Winner]) + SIM_FRAME_END_BITS - 3;   //error can hit any bit up to the end of EOF
+      Bits_ = (SimRandom() % i) + 1 + SIM_ERROR_FRAME_BITS;
+      g_SimBus.Error = 1;
+   }
+   else
+   {
+      Bits_ = SimStuffedBits(Bits[Winner],Count[Winner]) + SIM_FRAME_END_BITS;
+      g_SimBus.Error = 0;
+   }
+
+   g_SimBus.Busy = 1;
+   g_SimBus.FreeAt = g_SimNow + Bits_ * g_SimBitTime;
+   g_SimBus.BusyTime += Bits_ * g_SimBitTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//SimBusEnd()
+// Ends the frame on the bus.  Without an error it's taken out of the
+// transmitters' buffers and given to every other node, with an error the
+// transmitters keep it to try again and error counters go up.  A node at
+// another baud rate sees every frame as invalid.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void SimBusEnd(void)
+{
+   SIM_NODE_STRUCT *p;
+   int i, Node;
+   uint8_t Transmitting[SIM_MAX_NODES + 1];
+   uint32_t Stamp;
+   SIM_TIME Latency;
+
+   g_SimBus.Busy = 0;
+   memset(Transmitting,0,sizeof(Transmitting));
+
+   for(i=0;i<g_SimBus.TransmitterCount;i++)
+   {
+      Node = g_SimBus.Transmitter[i];
+      p = &g_SimNodes[Node];
+      Transmitting[Node] = 1;
+
+      if(g_SimBus.Error)
+      {
+         p->TxErrors++;
+         p->TEC += 8;
+         if(p->TEC > 255)
+         {
+            p->BusOff = 1;
+            p->BusOffs++;
+            p->RecoverAt = g_SimNow + SIM_BUS_OFF_BITS * g_SimBitTime;
+            p->TxCount = 0;      //J1939ErrorTask() aborts them, can_abort() does nothing in can-host.c
+         }
+      }
+      else if(p->TEC > 0)
+         p->TEC--;
+
+      if(p->TEC >= 128)
+         p->SuspendUntil = g_SimNow + SIM_SUSPEND_BITS * g_SimBitTime;
+
+      if(g_SimBus.Error)
+         continue;
+
+      p->TxFrames++;
+
+      //this node's periodic message, PDU Specific is the node number
+      if((((p->Tx[0].ID >> 16) & 0xFF) == 0xFF) && (((p->Tx[0].ID >> 8) & 0xFF) == (uint32_t)Node))
+      {
+         memcpy(&Stamp,p->Tx[0].Data,4);
+         Latency = (SIM_TIME)(uint32_t)((uint32_t)(g_SimNow / 1000) - Stamp) * 1000;
+
+         p->LatencyCount++;
+         p->LatencySum += Latency;
+         if(Latency > p->LatencyMax)
+            p->LatencyMax = Latency;
+         if(Latency / SIM_LATENCY_BIN_NS < SIM_LATENCY_BINS)
+            p->LatencyBins[Latency / SIM_LATENCY_BIN_NS]++;
+         else
+            p->LatencyBins[SIM_LATENCY_BINS - 1]++;
+      }
+
+      memmove(&p->Tx[0],&p->Tx[1],(p->TxCount - 1) * sizeof(SIM_FRAME));
+      p->TxCount--;
+   }
+
+   if(g_SimBus.Error)
+      g_SimBus.ErrorFrames++;
+   else
+      g_SimBus.Frames++;
+
+   for(Node=0;Node<=SIM_AUTO_BAUD_NODE;Node++)
+   {
+      if(Node == g_SimConfig.Nodes)
+         Node = SIM_AUTO_BAUD_NODE;                //only powered in the baud scenario
+
+      p = &g_SimNodes[Node];
+
+      if(Transmitting[Node] || !p->Powered || p->BusOff)
+         continue;
+
+      if((p->Baud != 0) && (p->Baud != g_SimConfig.Baud))
+      {
+         p->RxInvalid = 1;
+         p->RxInvalidFrames++;
+      }
+      else if(g_SimBus.Error)
+      {
+         if(p->REC < 128)
+            p->REC++;
+      }
+      else
+         SimBusReceive(Node,&g_SimBus.Frame);
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////// Run
+
+//time between passes of a node's main loop, Poll +-10%
+SIM_TIME SimPollInterval(void)
+{
+   SIM_TIME Jitter = g_SimConfig.Poll / 10;
+
+   if(Jitter == 0)
+      return(g_SimConfig.Poll);
+
+   return(g_SimConfig.Poll - Jitter + (SimRandom() % (2 * Jitter + 1)));
+}
+
+//runs the bus and the nodes until time Until
+void SimRun(SIM_TIME Until)
+{
+   SIM_NODE_STRUCT *p;
+   SIM_NODE_STATUS Status;
+   SIM_TIME Next;
+   int Node;
+
+   while(g_SimNow < Until)
+   {
+      if(g_SimBus.Busy && (g_SimNow >= g_SimBus.FreeAt))
+         SimBusEnd();
+
+      for(Node=0;Node<g_SimConfig.Nodes;Node++)
+      {
+         p = &g_SimNodes[Node];
+
+         if(!p->Powered)
+         {
+            if(g_SimNow < p->PowerUp)
+               continue;
+
+            p->Powered = 1;
+            p->NextPoll = g_SimNow;
+            g_SimNodeApi[Node].Init();
+         }
+
+         if(p->BusOff && (g_SimNow >= p->RecoverAt))
+         {
+            p->BusOff = 0;
+            p->TEC = 0;
+            p->REC = 0;
+         }
+
+         if(g_SimNow >= p->NextPoll)
+         {
+            g_SimNodeApi[Node].Poll();
+            p->NextPoll = g_SimNow + SimPollInterval();
+
+            if(!p->Claimed)
+            {
+               g_SimNodeApi[Node].Status(&Status);
+               if(Status.Claimed)
+               {
+                  p->Claimed = 1;
+                  p->ClaimTime = g_SimNow - p->PowerUp;
+               }
+            }
+         }
+      }
+
+      if(!g_SimBus.Busy)
+         SimBusStart();
+
+      Next = Until;
+      if(g_SimBus.Busy && (g_SimBus.FreeAt < Next))
+         Next = g_SimBus.FreeAt;
+      for(Node=0;Node<g_SimConfig.Nodes;Node++)
+      {
+         p = &g_SimNodes[Node];
+
+         if(!p->Powered)
+         {
+            if(p->PowerUp < Next)
+               Next = p->PowerUp;
+            continue;
+         }
+         if(p->NextPoll < Next)
+            Next = p->NextPoll;
+         if(p->BusOff && (p->RecoverAt < Next))
+            Next = p->RecoverAt;
+         if((p->TxCount > 0) && (p->SuspendUntil > g_SimNow) && (p->SuspendUntil < Next))
+            Next = p->SuspendUntil;
+      }
+
+      g_SimNow = Next;
+   }
+}
+
+//called each time the auto baud node reads its tick, the rest of the bus
+//runs for one pass of J1939AutoBaud()'s loop
+void SimAutoBaudWait(void)
+{
+   SimRun(g_SimNow + SIM_AUTO_BAUD_POLL);
+}
+
+//////////////////////////////////////////////////////////////////////////////// Scenarios
+
+void SimSetup(void)
+{
+   SIM_NODE_STRUCT *p;
+   SIM_FRAME Frame;
+   uint8_t Bits[128];
+   int Node, Arbitration, FrameBits;
+   int Addresses;
+
+   g_SimRandom = g_SimConfig.Seed * 0x9E3779B97F4A7C15ULL + 1;
+   g_SimBitTime = 1000000000ULL / g_SimConfig.Baud;
+
+   //bits in a periodic message, stamp and 0xFF data make about the average stuffing
+   memset(&Frame,0,sizeof(Frame));
+   Frame.ID = 0x18FF0080;
+   Frame.Ext = 1;
+   Frame.Length = 8;
+   memset(&Frame.Data[4],0xFF,4);
+   FrameBits = SimStuffedBits(Bits,SimFrameBits(&Frame,Bits,&Arbitration)) + SIM_FRAME_END_BITS;
+
+   Addresses = g_SimConfig.Nodes / 2;
+   if(Addresses < 1)
+      Addresses = 1;
+
+   for(Node=0;Node<g_SimConfig.Nodes;Node++)
+   {
+      p = &g_SimNodes[Node];
+
+      p->IdentityNumber = (Node + 1) | ((SimRandom() & 0x1FFF) << 8);
+      p->ClockOffset = (SIM_TIME)(SimRandom() % 1000) * 1000000;
+      p->DriftPpm = (int32_t)(SimRandom() % 201) - 100;
+      p->PowerUp = (SIM_TIME)SimRandom() % (g_SimConfig.PowerUpWindow + 1);
+
+      if(g_SimConfig.Scenario == SIM_SCENARIO_CLAIM)
+      {
+         p->PreferredAddress = 128 + (SimRandom() % Addresses);   //about two nodes for each address
+         p->SendPeriod = 0;
+      }
+      else
+      {
+         p->PreferredAddress = 128 + Node;
+         p->SendPeriod = (SIM_TIME)g_SimConfig.Nodes * FrameBits * g_SimBitTime * 100 / g_SimConfig.LoadPercent;
+         p->NextSend = p->PowerUp + (SimRandom() % p->SendPeriod);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//SimLatencyPercentile()
+// Latency under which Percent of a node's messages were sent.
+//  Parameters: p - node
+//              Percent - 0 to 100
+//  Returns:    SIM_TIME - latency in ns, top of the histogram bin or the
+//                         largest latency if less
+////////////////////////////////////////////////////////////////////////////////
+SIM_TIME SimLatencyPercentile(SIM_NODE_STRUCT *p, uint32_t Percent)
+{
+   uint64_t Target, Sum = 0;
+   int i;
+
+   if(p->LatencyCount == 0)
+      return(0);
+
+   Target = ((uint64_t)p->LatencyCount * Percent + 99) / 100;
+   for(i=0;i<SIM_LATENCY_BINS;i++)
+   {
+      Sum += p->LatencyBins[i];
+      if(Sum >= Target)
+         break;
+   }
+
+   if((SIM_TIME)(i + 1) * SIM_LATENCY_BIN_NS < p->LatencyMax)
+      return((SIM_TIME)(i + 1) * SIM_LATENCY_BIN_NS);
+
+   return(p->LatencyMax);
+}
+
+//prints the metrics, returns the number of addresses claimed by more than one node
+int SimReport(void)
+{
+   SIM_NODE_STRUCT *p;
+   SIM_NODE_STATUS Status[SIM_MAX_NODES];
+   int Node, Other, Claimed = 0, CannotClaim = 0, Conflicts = 0;
+   uint32_t Overflows = 0, Dropped = 0, PutFailed = 0, ConfigLost = 0;
+   const char *Format;
+
+   for(Node=0;Node<g_SimConfig.Nodes;Node++)
+   {
+      g_SimNodeApi[Node].Status(&Status[Node]);
+
+      if(Status[Node].Claimed)
+      {
+         Claimed++;
+         for(Other=0;Other<Node;Other++)
+            if(Status[Other].Claimed && (Status[Other].Address == Status[Node].Address))
+               Conflicts++;
+      }
+      if(Status[Node].CannotClaim)
+         CannotClaim++;
+   }
+
+   if(g_SimConfig.Csv)
+   {
+      printf("node,address,claimed,claim_ms,sent,put_failed,tx_frames,rx_frames,rx_messages,rx_overflows,j1939_dropped,tx_errors,bus_offs,latency_avg_us,latency_p99_us,latency_max_us\n");
+      Format = "%d,%u,%u,%.3f,%u,%u,%u,%u,%u,%u,%u,%u,%u,%.1f,%.1f,%.1f\n";
+   }
+   else
+   {
+      printf("scenario %s  nodes %d  seed %llu  baud %u  load %u%%  errors %uppm  rx buffers %u  tx buffers %u  poll %lluus  time %.3fs\n",
+             g_SimConfig.Scenario == SIM_SCENARIO_CLAIM ? "claim" : "load",g_SimConfig.Nodes,(unsigned long long)g_SimConfig.Seed,g_SimConfig.Baud,
+             g_SimConfig.Scenario == SIM_SCENARIO_CLAIM ? 0 : g_SimConfig.LoadPercent,g_SimConfig.ErrorPpm,g_SimConfig.RxBuffers,g_SimConfig.TxBuffers,
+             (unsigned long long)(g_SimConfig.Poll / 1000),g_SimConfig.Duration / 1e9);
+      printf("node addr claim claim_ms     sent put_fail tx_frame rx_frame   rx_msg rx_ovfl j1939_drop tx_err busoff lat_avg_us lat_p99_us lat_max_us\n");
+      Format = "%4d %4u %5u %8.3f %8u %8u %8u %8u %8u %7u %10u %6u %6u %10.1f %10.1f %10.1f\n";
+   }
+
+   for(Node=0;Node<g_SimConfig.Nodes;Node++)
+   {
+      p = &g_SimNodes[Node];
+
+      printf(Format,Node,Status[Node].Address,Status[Node].Claimed,p->Claimed ? p->ClaimTime / 1e6 : -1.0,
+             p->Sent,p->PutFailed,p->TxFrames,p->RxFrames,p->RxMessages,p->RxOverflows,Status[Node].ReceiveDropped,
+             p->TxErrors,p->BusOffs,p->LatencyCount ? (double)p->LatencySum / p->LatencyCount / 1000 : 0.0,
+             SimLatencyPercentile(p,99) / 1000.0,p->LatencyMax / 1000.0);
+
+      Overflows += p->RxOverflows;
+      ConfigLost += p->RxConfigLost;
+      Dropped += Status[Node].ReceiveDropped;
+      PutFailed += p->PutFailed;
+   }
+
+   if(g_SimConfig.Csv)
+      printf("\nframes,error_frames,collisions,load_percent,claimed,cannot_claim,address_conflicts,put_failed,rx_overflows,j1939_dropped,rx_config_lost\n%u,%u,%u,%.2f,%d,%d,%d,%u,%u,%u,%u\n",
+             g_SimBus.Frames,g_SimBus.ErrorFrames,g_SimBus.Collisions,100.0 * g_SimBus.BusyTime / g_SimConfig.Duration,Claimed,CannotClaim,Conflicts,PutFailed,Overflows,Dropped,ConfigLost);
+   else
+      printf("bus frames %u  error frames %u  collisions %u  load %.2f%%  claimed %d/%d  cannot claim %d  address conflicts %d  put failed %u  rx overflows %u  j1939 dropped %u  rx config lost %u\n",
+             g_SimBus.Frames,g_SimBus.ErrorFrames,g_SimBus.Collisions,100.0 * g_SimBus.BusyTime / g_SimConfig.Duration,Claimed,g_SimConfig.Nodes,CannotClaim,Conflicts,PutFailed,Overflows,Dropped,ConfigLost);
+
+   return(Conflicts);
+}
+
+namespace SimAutoBaudNode = SIM_NAMESPACE(SIM_AUTO_BAUD_NODE);
+
+////////////////////////////////////////////////////////////////////////////////
+//SimAutoBaud()
+// Baud scenario.  For each bus the load scenario's nodes run for
+// SIM_AUTO_BAUD_SETTLE, then the auto baud node powers up and J1939Init()
+// looks for the baud rate.  Each wrong rate must end on an invalid frame, the
+// next frame on the bus, which starts within a node's send period and two
+// polls and is under SIM_AUTO_BAUD_FRAME_BITS long, and the right rate must
+// end after as many frames as J1939_AUTO_BAUD_FRAMES.  On a quiet bus every rate takes
+// J1939_AUTO_BAUD_TICKS, J1939_AUTO_BAUD_CYCLES * 4 * J1939_AUTO_BAUD_TICKS
+// in all, the worst case.  One tick more is allowed for each rate tried, the
+// loop only sees the tick change on its next pass.
+//  Parameters: None
+//  Returns:    int - number of buses that failed
+////////////////////////////////////////////////////////////////////////////////
+int SimAutoBaud(void)
+{
+   //bus baud rate, no nodes sending, rate that should be found and how many rates are tried
+   const struct {
+      uint32_t Baud;
+      uint8_t Quiet;
+      uint8_t Rate;
+      uint8_t Tries;
+   } Buses[6] = {{250000, 0, SimAutoBaudNode::CAN_BAUD_250K, 1},
+                 {500000, 0, SimAutoBaudNode::CAN_BAUD_500K, 2},
+                 {125000, 0, SimAutoBaudNode::CAN_BAUD_125K, 3},
+                 {1000000, 0, SimAutoBaudNode::CAN_BAUD_1000K, 4},
+                 {100000, 0, 0xFF, 4 * J1939_AUTO_BAUD_CYCLES},     //not a rate it tries, every one is wrong
+                 {250000, 1, 0xFF, 4 * J1939_AUTO_BAUD_CYCLES}};
+   SIM_NODE_STRUCT *p;
+   SIM_NODE_STATUS Status;
+   uint32_t Bound, Wrong, WrongTries;
+   int Nodes, Failed = 0, Pass, i;
+
+   Nodes = g_SimConfig.Nodes;
+
+   printf("scenario baud  nodes %d  seed %llu  load %u%%  ticks per rate %u  cycles %u\n",Nodes,(unsigned long long)g_SimConfig.Seed,
+          g_SimConfig.LoadPercent,(uint32_t)J1939_AUTO_BAUD_TICKS,(uint32_t)J1939_AUTO_BAUD_CYCLES);
+   printf("bus_baud nodes found expect  ticks  bound invalid result\n");
+
+   for(i=0;i<6;i++)
+   {
+      memset(g_SimNodes,0,sizeof(g_SimNodes));
+      memset(&g_SimBus,0,sizeof(g_SimBus));
+      g_SimNow = 0;
+
+      g_SimConfig.Baud = Buses[i].Baud;
+      g_SimConfig.Nodes = Buses[i].Quiet ? 0 : Nodes;
+
+      SimSetup();
+      SimRun(SIM_AUTO_BAUD_SETTLE);
+
+      p = &g_SimNodes[SIM_AUTO_BAUD_NODE];
+      p->PowerUp = g_SimNow;
+      p->Powered = 1;
+      g_SimNodeApi[SIM_AUTO_BAUD_NODE].Init();
+      g_SimNodeApi[SIM_AUTO_BAUD_NODE].Status(&Status);
+
+      Wrong = (uint32_t)J1939_AUTO_BAUD_TICKS + 1;     //ticks a wrong rate can take
+      if(!Buses[i].Quiet)
+      {
+         Bound = (uint32_t)((g_SimNodes[0].SendPeriod + 2 * g_SimConfig.Poll + SIM_AUTO_BAUD_FRAME_BITS * g_SimBitTime) / 1000000) + 2;
+         if(Bound < Wrong)
+            Wrong = Bound;
+      }
+
+      WrongTries = (Buses[i].Rate == 0xFF) ? Buses[i].Tries : Buses[i].Tries - 1u;
+      Bound = WrongTries * Wrong;
+      if(Buses[i].Rate != 0xFF)
+         Bound += J1939_AUTO_BAUD_FRAMES * Wrong;
+
+      Pass = (Status.AutoBaudRate == Buses[i].Rate) && (Status.AutoBaudTicks <= Bound);
+      if(Buses[i].Quiet)
+         Pass = Pass && (Status.AutoBaudTicks >= Buses[i].Tries * (uint32_t)J1939_AUTO_BAUD_TICKS);
+      else
+         Pass = Pass && (p->RxInvalidFrames >= WrongTries);
+
+      printf("%8u %5d %5u %6u %6u %6u %7u %s\n",Buses[i].Baud,g_SimConfig.Nodes,Status.AutoBaudRate,Buses[i].Rate,
+             Status.AutoBaudTicks,Bound,p->RxInvalidFrames,Pass ? "ok" : "FAIL");
+
+      if(!Pass)
+         Failed++;
+   }
+
+   g_SimConfig.Nodes = Nodes;
+
+   return(Failed);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+
+   g_SimConfig.Scenario = SIM_SCENARIO_CLAIM;
+   g_SimConfig.Nodes = 40;
+   g_SimConfig.Seed = 1;
+   g_SimConfig.Baud = 250000;
+   g_SimConfig.LoadPercent = 90;
+   g_SimConfig.ErrorPpm = 0;
+   g_SimConfig.RxBuffers = 2;
+   g_SimConfig.TxBuffers = 3;
+   g_SimConfig.Poll = 1000000;
+   g_SimConfig.PowerUpWindow = 100000000;
+   g_SimConfig.Duration = 0;
+
+   for(i=1;i<argc;i++)
+   {
+      if((i + 1 < argc) && !strcmp(argv[i],"-scenario"))
+      {
+         i++;
+         if(!strcmp(argv[i],"load"))
+            g_SimConfig.Scenario = SIM_SCENARIO_LOAD;
+         else if(!strcmp(argv[i],"baud"))
+            g_SimConfig.Scenario = SIM_SCENARIO_BAUD;
+         else
+            g_SimConfig.Scenario = SIM_SCENARIO_CLAIM;
+      }
+      else if((i + 1 < argc) && !strcmp(argv[i],"-nodes"))
+         g_SimConfig.Nodes = atoi(argv[++i]);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-seed"))
+         g_SimConfig.Seed = strtoull(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-baud"))
+         g_SimConfig.Baud = strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-load"))
+         g_SimConfig.LoadPercent = strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-errors"))
+         g_SimConfig.ErrorPpm = strtoul(argv[++i],NULL,0);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-rxbuffers"))
+         g_SimConfig.RxBuffers = atoi(argv[++i]);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-txbuffers"))
+         g_SimConfig.TxBuffers = atoi(argv[++i]);
+      else if((i + 1 < argc) && !strcmp(argv[i],"-poll"))
+         g_SimConfig.Poll = strtoull(argv[++i],NULL,0) * 1000;
+      else if((i + 1 < argc) && !strcmp(argv[i],"-powerup"))
+         g_SimConfig.PowerUpWindow = strtoull(argv[++i],NULL,0) * 1000000;
+      else if((i + 1 < argc) && !strcmp(argv[i],"-config"))
+         g_SimConfig.ConfigWindow = strtoull(argv[++i],NULL,0) * 1000;
+      else if((i + 1 < argc) && !strcmp(argv[i],"-time"))
+         g_SimConfig.Duration = (SIM_TIME)(atof(argv[++i]) * 1e9);
+      else if(!strcmp(argv[i],"-csv"))
+         g_SimConfig.Csv = 1;
+      else
+      {
+         fprintf(stderr,"unknown option %s\n",argv[i]);
+         return(2);
+      }
+   }
+
+   if((g_SimConfig.Nodes < 1) || (g_SimConfig.Nodes > SIM_MAX_NODES) || (g_SimConfig.Baud == 0) ||
+      (g_SimConfig.LoadPercent == 0) || (g_SimConfig.RxBuffers < 1) || (g_SimConfig.RxBuffers > SIM_BUFFERS_MAX) ||
+      (g_SimConfig.TxBuffers < 1) || (g_SimConfig.TxBuffers > SIM_BUFFERS_MAX) || (g_SimConfig.Poll == 0))
+   {
+      fprintf(stderr,"setting out of range, nodes 1 to %d and buffers 1 to %d\n",SIM_MAX_NODES,SIM_BUFFERS_MAX);
+      return(2);
+   }
+
+   if(g_SimConfig.Scenario == SIM_SCENARIO_BAUD)
+      return(SimAutoBaud() ? 1 : 0);
+
+   if(g_SimConfig.Duration == 0)
+      g_SimConfig.Duration = (g_SimConfig.Scenario == SIM_SCENARIO_CLAIM) ? 5000000000ULL : 10000000000ULL;
+
+   SimSetup();
+   SimRun(g_SimConfig.Duration);
+
+   return(SimReport() ? 1 : 0);
+}
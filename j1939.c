@@ -25,6 +25,71 @@
 ////                         been claimed.  Use address global address 255  ////
 ////                         to receive a list of all claimed address.      ////
 ////                                                                        ////
+//// J1939SetClaimPolicy() - Sets how long to wait for contending Address   ////
+////                         Claims and when an address can be used         ////
+////                         without waiting.                               ////
+////                                                                        ////
+//// J1939ChangeAddress() - Claims a new address for unit, also done when  ////
+////                        a Commanded Address message is received for     ////
+////                        unit's J1939 Name.  g_J1939FilterChanges counts ////
+////                        the filter moves, with J1939_USE_PROFILER the   ////
+////                        J1939_PROFILE_FILTER_CONFIG probe records how   ////
+////                        long the CAN module wasn't receiving in Config  ////
+////                        mode while the filter was moved.                ////
+////                                                                        ////
+//// g_J1939ReceiveOverflows and g_J1939ReceiveDropped count messages lost ////
+//// by the CAN module and by the J1939 Receive buffer.                     ////
+////                                                                        ////
+//// J1939GetTimestamp() - With J1939_USE_RX_TIMESTAMP returns the time in ////
+////                       microseconds of the Start Of Frame of the last   ////
+////                       message returned by J1939GetMessage().           ////
+////                                                                        ////
+//// J1939GetMicroseconds() - With J1939_USE_RX_TIMESTAMP returns the       ////
+////                          current time in microseconds, on the same     ////
+////                          clock as J1939GetTimestamp().                 ////
+////                                                                        ////
+//// J1939ErrorTask() - Watches the CAN error state, holds transmissions   ////
+////                    after a bus off for a back off time that doubles    ////
+////                    with each bus off, then announces unit's address    ////
+////                    again.  Called by J1939XmitTask().                  ////
+////                    g_J1939ErrorStateCount[] counts the times each      ////
+////                    error state was entered.                            ////
+////                                                                        ////
+//// J1939ErrorISR() - Call from the CAN error interrupt when               ////
+////                   J1939_USE_ERROR_INTERRUPT is TRUE.                   ////
+////                                                                        ////
+//// J1939AutoBaud() - With J1939_USE_AUTO_BAUD, called by J1939Init() to   ////
+////                   find the bus baud rate in listen only mode before    ////
+////                   unit goes on the bus.                                ////
+////                                                                        ////
+//// J1939ProfileReset() - With J1939_USE_PROFILER, clears the profile      ////
+////                       table g_J1939Profile[].  J1939ReceiveTask(),     ////
+////                       J1939XmitTask(), can_getd() and can_putd() are   ////
+////                       profiled, J1939ProfileStart(probe) and           ////
+////                       J1939ProfileStop(probe) add more.                ////
+////                                                                        ////
+//// J1939CheckBuffers() - With J1939_USE_CHECKS, checks the receive,       ////
+////                       transmit and staged buffer indexes and counts,   ////
+////                       called at the end of J1939ReceiveTask() and      ////
+////                       J1939XmitTask().                                 ////
+////                                                                        ////
+//// J1939BuildName() - Builds an 8 byte J1939 Name from its fields, can be ////
+////                    used by J1939InitName to set g_J1939Name.           ////
+////                                                                        ////
+//// J1939GetAddressOfName() - Returns the address currently claimed by a   ////
+////                           J1939 Name from the address map.             ////
+////                                                                        ////
+//// J1939GetNameOfAddress() - Returns the J1939 Name that has claimed an   ////
+////                           address from the address map.                ////
+////                                                                        ////
+//// J1939GetAddressOfFunction() - Returns the address currently claimed    ////
+////                               by a unit with the specified Function,   ////
+////                               for example 0 for the engine.            ////
+////                                                                        ////
+////   The address map is kept from received Address Claimed and Cannot     ////
+////   Claim Address messages, its size is set by J1939_ADDRESS_MAP_ENTRIES ////
+////   (set to 0 to remove the address map).                                ////
+////                                                                        ////
 ////  Requires:                                                             ////
 ////     J1939InitAddress - Macro to initialize the g_MyJ1939Adddress       ////
 ////                        variable, which is the preferred J1939 address  ////
@@ -72,6 +137,8 @@
  #else
   #error Device does not have CAN/ECAN peripheral.
  #endif
+#elif USE_HOST_CAN == TRUE
+ #include "can-host.c"        //GCC or Clang on a PC
 #else
  #include <can-mcp251x.c>     //External CAN Controller
 #endif
@@ -92,10 +159,46 @@ void J1939Init(void)
    J1939InitAddress();  //Initialize unit's J1939 Preferred Address
    J1939InitName();     //Initialize unit's J1939 Name
    
-   rand_seed = 128;  //Initialize random generator seed number
+   J1939PackName(g_J1939Name,&g_J1939PackedName);  //Pack unit's J1939 Name for arbitration
+   
+   J1939SeedRandom();   //Initialize random generator from unit's J1939 Name and tick
+   
+  #ifdef J1939_PREFERRED_ADDRESSES
+   g_J1939PreferredIndex = 0;
+  #endif
+   
+   g_J1939ClaimContentionTicks = J1939_CLAIM_CONTENTION_TICKS;
+   g_J1939ImmediateClaim = J1939_IMMEDIATE_CLAIM_FIXED;
+   
+  #if J1939_USE_COMMANDED_ADDRESS == TRUE
+   g_J1939CommandedAddress.NextPacket = 0;
+  #endif
+   
+  #if J1939_USE_ERROR_SUPERVISOR == TRUE
+   g_J1939ErrorState = J1939_ERROR_ACTIVE;
+   g_J1939BusOffBackoff = J1939_BUS_OFF_BACKOFF_TICKS;
+   g_J1939ErrorActiveTick = J1939GetTick();
+  #endif
+   
+  #if J1939_ADDRESS_MAP_ENTRIES > 0
+   J1939ClearAddressMap();    //Clear list of J1939 Names to J1939 Addresses
+  #endif
+   
+  #if J1939_HITLESS_FILTER == TRUE
+   g_J1939FilterAddress = J1939_GLOBAL_ADDRESS;    //like filter 1, only global address until unit claims one
+  #endif
+
+  #if J1939_USE_PROFILER == TRUE
+   J1939ProfileTimerSetup();
+   J1939ProfileReset();
+  #endif
 
    can_init();    //Initialize the CAN, sets up Baud Rate and puts it in normal mode
    
+  #if J1939_USE_AUTO_BAUD == TRUE
+   J1939AutoBaud();     //can_init() left CAN in listen only mode, find the bus baud rate before going on the bus
+  #endif
+   
    #if (USE_INTERNAL_CAN == TRUE)
     #if defined(__PCD__)  //dsPIC30
      #if (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
@@ -104,7 +207,7 @@ void J1939Init(void)
       
       can_set_mode(CAN_OP_CONFIG);  //put CAN in Config mode
       
-      can_set_id(&C1RXM0, 0x0000FF00, CAN_MASK_ACCEPT_ALL);    //Set Mask 0 to look at Destination Address of PDU
+      can_set_id(&C1RXM0, J1939_ADDRESS_MASK, CAN_MASK_ACCEPT_ALL);  //Set Mask 0 to look at Destination Address of PDU
       can_set_id(&C1RXM1, 0x00F00000, CAN_MASK_ACCEPT_ALL);    //Set Mask 1 to look at upper nibble of PDU Format
       
       can_set_id(&C1RXF0, 0x0000FF00, CAN_USE_EXTENDED_ID);    //Filter 0 set to look for messages to the Global Address 255
@@ -118,7 +221,7 @@ void J1939Init(void)
      #else //PIC24 and dsPIC33
       //Initialize the CAN filters, each function puts CAN in config mode
       //makes changes and puts back in normal mode
-      can_set_id(&C1RXM0, 0x0000FF00, CAN_USE_EXTENDED_ID);    //Set Mask 0 to look at Destination Address of PDU
+      can_set_id(&C1RXM0, J1939_ADDRESS_MASK, CAN_USE_EXTENDED_ID);  //Set Mask 0 to look at Destination Address of PDU
       can_set_id(&C1RXM1, 0x00F00000, CAN_USE_EXTENDED_ID);    //Set Mask 1 to look at upper nibble of PDU Format
       
       can_set_id(&C1RXF0, 0x0000FF00, CAN_USE_EXTENDED_ID);    //Filter 0 set to look for messages to the Global Address 255
@@ -143,7 +246,7 @@ void J1939Init(void)
     #else //PIC18
       can_set_mode(CAN_OP_CONFIG);  //put CAN in Config mode
     
-      can_set_id(RX0MASK, 0x0000FF00, CAN_USE_EXTENDED_ID);       //Set Mask 0 to look at Destination Address of PDU
+      can_set_id(RX0MASK, J1939_ADDRESS_MASK, CAN_USE_EXTENDED_ID); //Set Mask 0 to look at Destination Address of PDU
       can_set_id(RX1MASK, 0x00F00000, CAN_USE_EXTENDED_ID);       //Set Mask 1 to look at upper nibble of PDU Format
       
       can_set_id(RXFILTER0, 0x0000FF00, CAN_USE_EXTENDED_ID);     //Filter 0 set to look for messages to the Global Address 255
@@ -164,11 +267,32 @@ void J1939Init(void)
       can_set_id(RXFILTER15, 0x00F00000, CAN_USE_EXTENDED_ID);    //Filter 15 set to look for Broadcast messages PDU 240 to 255
       
       can_set_mode(CAN_OP_NORMAL);  //put CAN in Normal mode
+      
+     #if J1939_USE_RX_TIMESTAMP == TRUE
+      g_J1939BufferStamped = 0;
+      
+      setup_timer_1(T1_INTERNAL | J1939_TIMESTAMP_T1_DIV);    //1us per count
+      setup_ccp1(CCP_CAPTURE_RE);                              //captures Timer1 on CAN Start Of Frame
+      
+      bie0.rxb0ie = 1;     //mode 1 & 2 receive buffer interrupt enables, every buffer that
+      bie0.rxb1ie = 1;     //receives so B0-B5 get stamped too, they all come in as INT_CANRX1.
+      bie0.b0ie = bit_test(can_rx_buffers,2);     //Set them again if the application changes
+      bie0.b1ie = bit_test(can_rx_buffers,3);     //the functional mode or BSEL0 after J1939Init()
+      bie0.b2ie = bit_test(can_rx_buffers,4);
+      bie0.b3ie = bit_test(can_rx_buffers,5);
+      bie0.b4ie = bit_test(can_rx_buffers,6);
+      bie0.b5ie = bit_test(can_rx_buffers,7);
+      
+      enable_interrupts(INT_TIMER1);
+      enable_interrupts(INT_CCP1);
+      enable_interrupts(INT_CANRX0);
+      enable_interrupts(INT_CANRX1);
+     #endif
     #endif
    #else //External CAN Controller
       can_set_mode(CAN_OP_CONFIG);     //put CAN in Config mode
       
-      can_set_id(RX0MASK, 0x0000FF00, CAN_USE_EXTENDED_ID);       //Set Mask 0 to look at Destination Address of PDU
+      can_set_id(RX0MASK, J1939_ADDRESS_MASK, CAN_USE_EXTENDED_ID); //Set Mask 0 to look at Destination Address of PDU
       can_set_id(RX1MASK, 0x00F00000, CAN_USE_EXTENDED_ID);       //Set Mask 1 to look at upper nibble of PDU Format
       
       can_set_id(RX0FILTER0, 0x0000FF00, CAN_USE_EXTENDED_ID);    //Filter 0 set to look for messages to the Global Address 255
@@ -204,18 +328,55 @@ void J1939ReceiveTask(void)
    uint8_t Data[8];
    uint8_t length;
    struct rx_stat Status;
+  #if J1939_USE_ID_REGISTERS == TRUE
+   uint8_t Registers[4];
+  #else
+   uint32_t ID;
+  #endif
+   
+   J1939ProfileStart(J1939_PROFILE_RECEIVE_TASK);
    
    rand_seed++;
    
-   while(can_kbhit())
+  #if J1939_USE_ID_REGISTERS == TRUE
+   while(can_getd_raw(Registers,Data,length,Status))   //can_getd_raw() returns FALSE once CAN receive buffers are empty
+   {
+      J1939ProfileStart(J1939_PROFILE_ID);
+      J1939RegistersToPDU(Registers,&ReceivedPDU);
+      J1939ProfileStop(J1939_PROFILE_ID);
+  #else
+   while(can_getd(ID,Data,length,Status))    //can_getd() returns FALSE once CAN receive buffers are empty
    {
-      can_getd(ReceivedPDU,Data,length,Status);
+      J1939ProfileStart(J1939_PROFILE_ID);
+      J1939IDToPDU(ID,&ReceivedPDU);
+      J1939ProfileStop(J1939_PROFILE_ID);
+  #endif
+  
+     #if J1939_USE_RX_TIMESTAMP == TRUE
+      J1939TakeTimestamp(Status.buffer);
+     #endif
+      
+      if(length > 8)
+         length = 8;    //CAN drivers can pass on a DLC of 9 to 15, still only 8 data bytes
+      
+      if(Status.err_ovfl)
+         g_J1939ReceiveOverflows++;
       
-      if(g_J1939Flags.ReceiveBufferCount < J1939_RECEIVE_BUFFERS)
+     #if J1939_HITLESS_FILTER == TRUE
+      if((ReceivedPDU.PDUFormat < J1939_PF_PDU2) && (ReceivedPDU.DestinationAddress != J1939_GLOBAL_ADDRESS) && (ReceivedPDU.DestinationAddress != g_J1939FilterAddress))
+         continue;      //filter 1 in software, message to another address
+     #endif
+      
+      if(g_J1939Flags.ReceiveBufferCount >= J1939_RECEIVE_BUFFERS)
+         g_J1939ReceiveDropped++;
+      else
       {
          switch(ReceivedPDU.PDUFormat)
          {
             case J1939_PF_ADDR_CLAIMED:
+               if(length < 8)
+                  break;      //not a whole J1939 Name, ignore it
+                  
                J1939HandleAddressClaim(ReceivedPDU,Data);
                
                if((ReceivedPDU.SourceAddress != g_MyJ1939Address) && (ReceivedPDU.SourceAddress != J1939_NULL_ADDRESS))
@@ -224,11 +385,19 @@ void J1939ReceiveTask(void)
                }
                break;
             case J1939_PF_REQUEST:
-               if((Data[0] == 0x00) && (Data[1] == 0xEE) && (Data[2] == 0x00))
-               {
-                  J1939HandleAddressRequest(ReceivedPDU);
-                  break;
-               }
+               if((length >= 3) && (Data[0] == 0x00) && (Data[1] == 0xEE) && (Data[2] == 0x00))
+                  J1939HandleAddressRequest();
+               else
+                  J1939LoadReceiveBuffer(ReceivedPDU,Data,length);
+               break;
+           #if J1939_USE_COMMANDED_ADDRESS == TRUE
+            case J1939_PF_PT_CM:
+            case J1939_PF_PT_DT:
+               if(ReceivedPDU.DestinationAddress == J1939_GLOBAL_ADDRESS)
+                  J1939HandleCommandedAddress(ReceivedPDU,Data,length);
+               J1939LoadReceiveBuffer(ReceivedPDU,Data,length);      //application still gets the transport messages
+               break;
+           #endif
             default:
                J1939LoadReceiveBuffer(ReceivedPDU,Data,length);
                break;
@@ -240,13 +409,15 @@ void J1939ReceiveTask(void)
    {
       g_J1939CurrentClaimTick = J1939GetTick();
       
-      if(J1939GetTickDifference(g_J1939CurrentClaimTick, g_J1939PreviousClaimTick) >= (J1939_TICK_TYPE)J1939_TICKS_PER_SECOND/4)
-      {
-         g_J1939Flags.AddressClaimed = TRUE;
-         J1939SetCANFilter(g_MyJ1939Address);      //unit claimed address so setup filter to start looking for 
-                                                   //J1939 Messages sent to unit's address 
-      }
+      if(J1939GetTickDifference(g_J1939CurrentClaimTick, g_J1939PreviousClaimTick) >= g_J1939ClaimContentionTicks)
+         J1939AddressClaimComplete();
    }
+   
+  #if J1939_USE_CHECKS == TRUE
+   J1939CheckBuffers();
+  #endif
+   
+   J1939ProfileStop(J1939_PROFILE_RECEIVE_TASK);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -258,14 +429,34 @@ void J1939ReceiveTask(void)
 void J1939XmitTask(void)
 {
    J1939_TICK_TYPE CurrentTick;
+  #if J1939_USE_ID_REGISTERS == TRUE
+   uint8_t Registers[4];
+  #else
+   uint32_t ID;
+  #endif
+
+   J1939ProfileStart(J1939_PROFILE_XMIT_TASK);
+
+  #if J1939_USE_ERROR_SUPERVISOR == TRUE
+   J1939ErrorTask();
+   
+   if(g_J1939Flags.BusOffRecovery)
+   {
+      J1939ProfileStop(J1939_PROFILE_XMIT_TASK);
+      return;
+   }
+  #endif
+
+  #if J1939_STAGED_BUFFERS > 0
+   if((g_J1939Flags.AddressClaimed == TRUE) && (g_J1939Flags.StagedBufferCount > 0))
+      J1939ReleaseStagedMessages();    //finish releasing messages that didn't fit when address was claimed
+  #endif
 
    while((g_J1939Flags.XmitBufferCount > 0) && can_tbe())
    {
-      if((g_J1939Flags.AddressClaimed == TRUE) || (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.PDUFormat == J1939_PF_ADDR_CLAIMED) || 
-         ((g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.PDUFormat == J1939_PF_REQUEST) && (g_J1939XmitBuffer[g_J1939XmitNextOut].Data[0] == 0x00) &&
-          (g_J1939XmitBuffer[g_J1939XmitNextOut].Data[1] == 0xEE) && (g_J1939XmitBuffer[g_J1939XmitNextOut].Data[2] == 0x00)))
+      if((g_J1939Flags.AddressClaimed == TRUE) || J1939IsAddressClaimMessage(g_J1939XmitBuffer[g_J1939XmitNextOut].PDU,g_J1939XmitBuffer[g_J1939XmitNextOut].Data,g_J1939XmitBuffer[g_J1939XmitNextOut].Length))
       {
-         if((g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.PDUFormat == J1939_PF_ADDR_CLAIMED) && (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.DestinationAddress == J1939_NULL_ADDRESS))
+         if((g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.PDUFormat == J1939_PF_ADDR_CLAIMED) && (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.SourceAddress == J1939_NULL_ADDRESS))
          {
             CurrentTick = J1939GetTick();
             
@@ -273,26 +464,26 @@ void J1939XmitTask(void)
                break;
          }
                
-         can_putd(g_J1939XmitBuffer[g_J1939XmitNextOut].PDU,g_J1939XmitBuffer[g_J1939XmitNextOut].Data,g_J1939XmitBuffer[g_J1939XmitNextOut].Length,3,TRUE,FALSE);
+        #if J1939_USE_ID_REGISTERS == TRUE
+         J1939ProfileStart(J1939_PROFILE_ID);
+         J1939PDUToRegisters(&g_J1939XmitBuffer[g_J1939XmitNextOut].PDU,Registers);
+         J1939ProfileStop(J1939_PROFILE_ID);
+         can_putd_raw(Registers,g_J1939XmitBuffer[g_J1939XmitNextOut].Data,g_J1939XmitBuffer[g_J1939XmitNextOut].Length,3);
+        #else
+         J1939ProfileStart(J1939_PROFILE_ID);
+         ID = J1939PDUToID(&g_J1939XmitBuffer[g_J1939XmitNextOut].PDU);
+         J1939ProfileStop(J1939_PROFILE_ID);
+         can_putd(ID,g_J1939XmitBuffer[g_J1939XmitNextOut].Data,g_J1939XmitBuffer[g_J1939XmitNextOut].Length,3,TRUE,FALSE);
+        #endif
          
-         if((g_J1939Flags.AddressClaimed == FALSE) && (g_J1939Flags.AddressNewClaim == TRUE) && (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.PDUFormat == J1939_PF_ADDR_CLAIMED) && (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.DestinationAddress != J1939_NULL_ADDRESS))
+         if((g_J1939Flags.AddressClaimed == FALSE) && (g_J1939Flags.AddressNewClaim == TRUE) && (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.PDUFormat == J1939_PF_ADDR_CLAIMED) && (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.SourceAddress != J1939_NULL_ADDRESS))
          {
-            if((bit_test(g_J1939Name[7],7) == FALSE) && ((g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.DestinationAddress <= 128) || 
-               ((g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.DestinationAddress >= 248) && (g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.DestinationAddress <=253))))
-            {
-               g_J1939Flags.AddressClaimed = TRUE;
-               g_J1939Flags.AddressClaimSent = TRUE;
-               g_J1939Flags.AddressNewClaim = FALSE;
-               
-               J1939SetCANFilter(g_MyJ1939Address);   //unit claimed address so setup filter to start looking for 
-                                                      //J1939 Messages sent to unit's address
-            }
-            else
-            {
-               g_J1939PreviousClaimTick = J1939GetTick();
-               g_J1939Flags.AddressClaimSent = TRUE;
-               g_J1939Flags.AddressNewClaim = FALSE;
-            }
+            g_J1939PreviousClaimTick = J1939GetTick();
+            g_J1939Flags.AddressClaimSent = TRUE;
+            g_J1939Flags.AddressNewClaim = FALSE;
+            
+            if(J1939CheckImmediateClaim(g_J1939XmitBuffer[g_J1939XmitNextOut].PDU.SourceAddress))
+               J1939AddressClaimComplete();     //address can be used without waiting for contending claims
          }            
       }
                
@@ -301,6 +492,12 @@ void J1939XmitTask(void)
          
        g_J1939Flags.XmitBufferCount--;
    }
+   
+  #if J1939_USE_CHECKS == TRUE
+   J1939CheckBuffers();
+  #endif
+   
+   J1939ProfileStop(J1939_PROFILE_XMIT_TASK);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -339,6 +536,10 @@ int1 J1939GetMessage(J1939_PDU_STRUCT &PDU, uint8_t *Data, uint8_t &Length)
       for(i=0;i<Length;i++)
          Data[i] = g_J1939ReceiveBuffer[g_J1939ReceiveNextOut].Data[i];
          
+     #if J1939_USE_RX_TIMESTAMP == TRUE
+      g_J1939MessageTimestamp = g_J1939ReceiveTimestamp[g_J1939ReceiveNextOut];
+     #endif
+         
       if(++g_J1939ReceiveNextOut >= J1939_RECEIVE_BUFFERS)
          g_J1939ReceiveNextOut = 0;
          
@@ -352,10 +553,12 @@ int1 J1939GetMessage(J1939_PDU_STRUCT &PDU, uint8_t *Data, uint8_t &Length)
 
 ////////////////////////////////////////////////////////////////////////////////
 //J1939PutMessage()
-// Load message into transmit buffer
+// Load message into transmit buffer.  Until the unit has claimed its address
+// application messages are held in the staged buffer instead, and sent with
+// the claimed address as Source Address once it's claimed.
 //  Parameters: PDU - PDU to send with message
 //              Data - pointer to data to send
-//              Bytes - number of bytes to send
+//              Bytes - number of bytes to send, more than 8 is sent as 8
 //  Returns:    True - if message was successfully loaded into an empty xmit buffer
 //              False - if xmit buffer was full
 ////////////////////////////////////////////////////////////////////////////////
@@ -363,6 +566,14 @@ int1 J1939PutMessage(J1939_PDU_STRUCT PDU, uint8_t *Data, uint8_t Bytes)
 {
    uint8_t i;
 
+   if(Bytes > 8)
+      Bytes = 8;
+
+  #if J1939_STAGED_BUFFERS > 0
+   if((g_J1939Flags.AddressClaimed == FALSE) && (J1939IsAddressClaimMessage(PDU,Data,Bytes) == FALSE))
+      return(J1939StageMessage(PDU,Data,Bytes));   //hold message until address is claimed
+  #endif
+
    if(g_J1939Flags.XmitBufferCount < J1939_TRANSMIT_BUFFERS)
    {
       memcpy(&g_J1939XmitBuffer[g_J1939XmitNextIn].PDU,&PDU,sizeof(J1939_PDU_STRUCT));
@@ -404,208 +615,1353 @@ void J1939RequestAddress(uint8_t address)
    J1939PutMessage(PDU,data,3);
 }
 
-////////////////////////////////////////////////////////////////////////////////  Internal Functions
-
 ////////////////////////////////////////////////////////////////////////////////
-//J1939ClaimAddress()
-// Sends an Address Claimed message to claim address in g_MyJ1939Address.
-//  Parameters: None
+//J1939SetClaimPolicy()
+// Sets how long unit waits for contending Address Claims before using its
+// address, and when it can use its address without waiting.
+//  Parameters: ContentionTicks - ticks to wait after sending Address Claimed,
+//                                J1939_CLAIM_CONTENTION_TICKS by default
+//              ImmediateClaim - J1939_IMMEDIATE_CLAIM_NEVER, 
+//                               J1939_IMMEDIATE_CLAIM_FIXED (default) or
+//                               J1939_IMMEDIATE_CLAIM_ALWAYS
 //  Returns:    Nothing
 ////////////////////////////////////////////////////////////////////////////////
-void J1939ClaimAddress(void)
+void J1939SetClaimPolicy(J1939_TICK_TYPE ContentionTicks, uint8_t ImmediateClaim)
 {
-   J1939_PDU_STRUCT RequestPDU;
-
-   RequestPDU.SourceAddress = g_MyJ1939Address;
-   RequestPDU.DestinationAddress = J1939_GLOBAL_ADDRESS;
-   RequestPDU.PDUFormat = J1939_PF_ADDR_CLAIMED;
-   RequestPDU.DataPage = 0;
-   RequestPDU.ExtendedDataPage = 0;
-   RequestPDU.Priority = J1939_REQUEST_PRIORITY;
-   
-   g_J1939Flags.AddressNewClaim = TRUE;
-   
-   J1939PutMessage(RequestPDU,g_J1939Name,8);
+   g_J1939ClaimContentionTicks = ContentionTicks;
+   g_J1939ImmediateClaim = ImmediateClaim;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-//J1939CompareName()
-// Compares our name with received name to determine which has priority
-//  Parameters: data - pointer to received name
-//  Returns:    True - if our name is high priority
-//              False - if our name is lower priority
+//J1939ChangeAddress()
+// Claims a new address for unit.  Filter 1 keeps receiving messages sent to
+// the old address until the new address is claimed, then it's moved to the new
+// address.
+//  Parameters: address - new address to claim, 0 to 253
+//  Returns:    Nothing
 ////////////////////////////////////////////////////////////////////////////////
-int1 J1939CompareName(uint8_t *data)
+void J1939ChangeAddress(uint8_t address)
 {
-   uint8_t i;
+   if((address >= J1939_NULL_ADDRESS) || ((address == g_MyJ1939Address) && (g_J1939Flags.AddressClaimed == TRUE)))
+      return;
+      
+   g_MyJ1939Address = address;
    
-   for(i=0;i<8;i++)
-   {
-      if(g_J1939Name[i] > data[i])
-         return(FALSE);
-   }
+   g_J1939Flags.AddressClaimed = FALSE;
+   g_J1939Flags.AddressClaimSent = FALSE;
+   g_J1939Flags.AddressCannotClaim = FALSE;
    
-   return(TRUE);
+   J1939ClaimAddress();
 }
 
+#if J1939_USE_AUTO_BAUD == TRUE
 ////////////////////////////////////////////////////////////////////////////////
-//J1939HandleAddressRequest()
-// Generates response to J1939 Address Requests
+//J1939AutoBaud()
+// Finds the bus baud rate with the CAN in listen only mode, so nothing is put
+// on the bus while trying the wrong rate.  Each rate is tried until
+// J1939_AUTO_BAUD_FRAMES valid frames are received, an invalid frame is seen or
+// J1939_AUTO_BAUD_TICKS go by.  If no rate is found after J1939_AUTO_BAUD_CYCLES
+// times through the list the baud rate set by can_set_baud() is used.  Leaves
+// the CAN in normal mode.  The rate found is saved in g_J1939AutoBaudRate and
+// the ticks it took in g_J1939AutoBaudTicks.
 //  Parameters: None
-//  Returns:    Nothing
+//  Returns:    int1 - TRUE if the baud rate was found, FALSE if not
 ////////////////////////////////////////////////////////////////////////////////
-void J1939HandleAddressRequest(J1939_PDU_STRUCT PDU)
+int1 J1939AutoBaud(void)
 {
-   J1939_PDU_STRUCT RequestPDU;
+   const CAN_BAUD_RATE Rates[4] = {CAN_BAUD_250K, CAN_BAUD_500K, CAN_BAUD_125K, CAN_BAUD_1000K};
+   uint8_t Cycle, Rate, Frames;
+   uint8_t Data[8], Length;
+   uint32_t ID;
+   struct rx_stat Status;
+   J1939_TICK_TYPE StartTick, RateTick;
    
-   if(g_J1939Flags.AddressClaimed != TRUE)
-      RequestPDU.SourceAddress = J1939_NULL_ADDRESS;
-   else
-      RequestPDU.SourceAddress = g_MyJ1939Address;
+   StartTick = J1939GetTick();
    
-   RequestPDU.DestinationAddress = J1939_GLOBAL_ADDRESS;
-   RequestPDU.PDUFormat = J1939_PF_ADDR_CLAIMED;            //value is the same for both Address Claimed and Cannot Claim Address
-   RequestPDU.DataPage = 0;
-   RequestPDU.ExtendedDataPage = 0;
-   RequestPDU.Priority = J1939_REQUEST_PRIORITY;
+   for(Cycle=0;Cycle<J1939_AUTO_BAUD_CYCLES;Cycle++)
+   {
+      for(Rate=0;Rate<4;Rate++)
+      {
+         can_set_baud_rate(Rates[Rate]);  //stays in listen only mode
+         
+         while(can_getd(ID,Data,Length,Status));   //throw away frames received at the last rate
+         CAN_INT_IRXIF = 0;
+         
+         Frames = 0;
+         RateTick = J1939GetTick();
+         
+         while(J1939GetTickDifference(J1939GetTick(), RateTick) < J1939_AUTO_BAUD_TICKS)
+         {
+            if(CAN_INT_IRXIF)
+               break;      //invalid frame, wrong baud rate
+               
+            if(can_getd(ID,Data,Length,Status))
+            {
+               if(Status.inv)
+                  break;
+                  
+               if(++Frames >= J1939_AUTO_BAUD_FRAMES)
+               {
+                  g_J1939AutoBaudRate = Rates[Rate];
+                  g_J1939AutoBaudTicks = J1939GetTickDifference(J1939GetTick(), StartTick);
+                  
+                  can_set_mode(CAN_OP_NORMAL);
+                  
+                  return(TRUE);
+               }
+            }
+         }
+      }
+   }
    
-   if((g_J1939Flags.AddressClaimed == TRUE) || (g_J1939Flags.AddressClaimSent == TRUE))  //don't respond to request if an address claim hasn't been sent
-      J1939PutMessage(RequestPDU,g_J1939Name,8);
+   g_J1939AutoBaudRate = 0xFF;
+   g_J1939AutoBaudTicks = J1939GetTickDifference(J1939GetTick(), StartTick);
+   
+   can_set_mode(CAN_OP_CONFIG);
+   can_set_baud();
+   can_set_mode(CAN_OP_NORMAL);
+   
+   return(FALSE);
 }
+#endif
 
+#if J1939_USE_RX_TIMESTAMP == TRUE
 ////////////////////////////////////////////////////////////////////////////////
-//J1939LoadReceiveBuffer()
-// Loads g_J1939ReceiveBuffer with passed data and updates global indexes.
-//  Parameters: ReceivedPDU - the PDU of the received CAN message
-//              Data - pointer to the received CAN data
-//              length - number of bytes received in CAN message
-//  Returns:    Nothing
+//J1939GetMicroseconds()
+// Returns the current time in microseconds, Timer1 extended to 32 bits.
+//  Parameters: None
+//  Returns:    uint32_t - current time in microseconds
 ////////////////////////////////////////////////////////////////////////////////
-void J1939LoadReceiveBuffer(J1939_PDU_STRUCT ReceivedPDU,uint8_t *Data,uint8_t length)
+uint32_t J1939GetMicroseconds(void)
 {
-   uint8_t i;
+   uint16_t High, Low;
    
-   memcpy(&g_J1939ReceiveBuffer[g_J1939ReceiveNextIn].PDU,&ReceivedPDU,sizeof(J1939_PDU_STRUCT));
-   g_J1939ReceiveBuffer[g_J1939ReceiveNextIn].Length = length;
-   for(i=0;i<length;i++)
-      g_J1939ReceiveBuffer[g_J1939ReceiveNextIn].Data[i] = Data[i];
+   do
+   {
+      High = g_J1939TimestampHigh;
+      Low = get_timer1();
+   } while(High != g_J1939TimestampHigh);    //Timer1 interrupt ran while reading
    
-   if(++g_J1939ReceiveNextIn >= J1939_RECEIVE_BUFFERS)
-      g_J1939ReceiveNextIn = 0;
+   if(interrupt_active(INT_TIMER1) && (Low < 0x8000))
+      High++;     //Timer1 overflowed but its interrupt hasn't run yet
       
-   g_J1939Flags.ReceiveBufferCount++;
+   return(make32(High,Low));
 }
+#endif
 
+#if J1939_USE_ERROR_SUPERVISOR == TRUE
 ////////////////////////////////////////////////////////////////////////////////
-//J1939HandleAddressClaim()
-// Responses to a J1939 Address Claim message.  Compares unit's Address and Name
-// to the Source Address and Name of the received J1939 Address Claim message,
-// and either response with Address Claimed, Cannot Claim Address or if unit is
-// Arbitrary Address Capable and if received Name is higher priority then unit's
-// name it sends a new Address Request with a randomly generated address from
-// 128 to 247.
-//  Parameters: ReceivedPDU - the PDU of received Address Claim message
-//              Name - pointer to the J1939 Name of Address Claimer
+//J1939ErrorTask()
+// Checks the CAN error state and counts each change of state.  On bus off any
+// pending CAN transmissions are aborted, the Transmit buffer is flushed or held
+// depending on J1939_BUS_OFF_POLICY, and transmitting is held off for
+// g_J1939BusOffBackoff ticks and until the CAN module has left bus off.  Unit
+// then sends Address Claimed again, so other units know it's back.
+//  Parameters: None
 //  Returns:    Nothing
 ////////////////////////////////////////////////////////////////////////////////
-void J1939HandleAddressClaim(J1939_PDU_STRUCT ReceivedPDU, uint8_t *Name)
+void J1939ErrorTask(void)
 {
-   J1939_PDU_STRUCT RequestPDU;
+   uint8_t State;
+   J1939_TICK_TYPE CurrentTick;
+   
+  #if J1939_USE_ERROR_INTERRUPT == TRUE
+   if((g_J1939ErrorEvent == FALSE) && (g_J1939Flags.BusOffRecovery == FALSE) && (g_J1939BusOffBackoff == J1939_BUS_OFF_BACKOFF_TICKS))
+      return;     //nothing changed since last error interrupt
+      
+   g_J1939ErrorEvent = FALSE;
+  #endif
+  
+   CurrentTick = J1939GetTick();
    
-   if((ReceivedPDU.SourceAddress != J1939_NULL_ADDRESS) && (g_J1939Flags.AddressClaimSent))
+   if(J1939CanBusOff())
+      State = J1939_ERROR_BUS_OFF;
+   else if(J1939CanErrorPassive())
+      State = J1939_ERROR_PASSIVE;
+   else if(J1939CanErrorWarning())
+      State = J1939_ERROR_WARNING;
+   else
+      State = J1939_ERROR_ACTIVE;
+      
+   if(State != g_J1939ErrorState)
    {
-      RequestPDU.DestinationAddress = J1939_GLOBAL_ADDRESS;
-      RequestPDU.PDUFormat = J1939_PF_ADDR_CLAIMED;            //value is the same for both Address Claimed and Cannot Claim Address
-      RequestPDU.DataPage = 0;
-      RequestPDU.ExtendedDataPage = 0;
-      RequestPDU.Priority = J1939_REQUEST_PRIORITY;
-
-      if((ReceivedPDU.SourceAddress == g_MyJ1939Address) && (g_J1939Flags.AddressCannotClaim == FALSE))
+      g_J1939ErrorState = State;
+      g_J1939ErrorStateCount[State]++;
+      
+      if(State == J1939_ERROR_BUS_OFF)
       {
-         if(J1939CompareName(Name))
-         {
-            RequestPDU.SourceAddress = g_MyJ1939Address;
-         }
+         g_J1939BusOffTick = CurrentTick;
+         g_J1939Flags.BusOffRecovery = TRUE;
+         
+         can_abort();      //abort frames stuck in the CAN transmit buffers
+         
+        #if J1939_BUS_OFF_POLICY == J1939_BUS_OFF_FLUSH
+         g_J1939XmitNextOut = 0;
+         g_J1939XmitNextIn = 0;
+         g_J1939Flags.XmitBufferCount = 0;
+        #endif
+      }
+      else if(State == J1939_ERROR_ACTIVE)
+         g_J1939ErrorActiveTick = CurrentTick;
+   }
+   else if((State == J1939_ERROR_ACTIVE) && (g_J1939BusOffBackoff != J1939_BUS_OFF_BACKOFF_TICKS))
+   {
+      if(J1939GetTickDifference(CurrentTick, g_J1939ErrorActiveTick) >= J1939_BUS_OFF_BACKOFF_MAX_TICKS)
+         g_J1939BusOffBackoff = J1939_BUS_OFF_BACKOFF_TICKS;      //bus has been good long enough, start back off over
+   }
+   
+   if((g_J1939Flags.BusOffRecovery == TRUE) && (State != J1939_ERROR_BUS_OFF))
+   {
+      if(J1939GetTickDifference(CurrentTick, g_J1939BusOffTick) >= g_J1939BusOffBackoff)
+      {
+         g_J1939Flags.BusOffRecovery = FALSE;
+         
+         if(g_J1939BusOffBackoff < (J1939_BUS_OFF_BACKOFF_MAX_TICKS / 2))
+            g_J1939BusOffBackoff *= 2;
          else
-         {
-            if(g_J1939Flags.AddressClaimed)
-               J1939SetCANFilter(J1939_GLOBAL_ADDRESS);  //Only do this if unit already claimed address,
-                                                         //because this switches CAN to CONFIG mode.
-            //Clear Address Claim Flags
-            g_J1939Flags.AddressClaimed = FALSE;
+            g_J1939BusOffBackoff = J1939_BUS_OFF_BACKOFF_MAX_TICKS;
             
-            //Clear Transmit Buffer
-            g_J1939XmitNextOut = 0;
-            g_J1939XmitNextIn = 0;
-            g_J1939Flags.XmitBufferCount = 0;
+         g_J1939ErrorActiveTick = CurrentTick;
             
-            if(bit_test(g_J1939Name[7],7) == FALSE)   //If not Arbitrary Address Capable send Cannot Claim Address
-            {
-               RequestPDU.SourceAddress = J1939_NULL_ADDRESS;
-               g_J1939Flags.AddressCannotClaim = TRUE;
-            }
-            else  //If Arbitrary Address Capable Generate Random address from 128 to 247 and request
-            {
-               g_MyJ1939Address = (((uint32_t)xor8() * 46875) / 100000) + 128;
-               RequestPDU.SourceAddress = g_MyJ1939Address;
-               g_J1939Flags.AddressNewClaim = TRUE;
-            }
-         }
-      }
-      else
-         RequestPDU.SourceAddress = J1939_NULL_ADDRESS;
-      
-      if(RequestPDU.SourceAddress == J1939_NULL_ADDRESS)
-      {
-         g_J1939PreviousCannotClaimTick = J1939GetTick();
-         g_J1939CannotClaimDelay = ((uint32_t)xor8() * 53125) / 100000;    //Generate Random delay from 0 to 135ms
+         if((g_J1939Flags.AddressClaimSent == TRUE) && (g_J1939Flags.AddressCannotClaim == FALSE))
+            J1939ClaimAddress();    //let other units know unit is back on the bus
       }
-         
-      J1939PutMessage(RequestPDU,g_J1939Name,8);
    }
 }
-      
+
+#if J1939_USE_ERROR_INTERRUPT == TRUE
 ////////////////////////////////////////////////////////////////////////////////
-//J1939SetCANFilter()
-// Sets filter 1 of CAN module to receive unit's address after unit it has
-// successfully claimed an address.
-//  Parameters: address - address to set filter to
+//J1939ErrorISR()
+// Tells J1939ErrorTask() the CAN error state changed, call from the CAN error
+// interrupt (#INT_CANERR on PIC18).
+//  Parameters: None
 //  Returns:    Nothing
 ////////////////////////////////////////////////////////////////////////////////
-void J1939SetCANFilter(uint8_t address)
+void J1939ErrorISR(void)
 {
-   can_set_mode(CAN_OP_CONFIG);  //put CAN in Config mode
+   g_J1939ErrorEvent = TRUE;
+}
+#endif
+#endif
 
-   #if (USE_INTERNAL_CAN == TRUE)
-    #if defined(__PCD__)   //PIC24, dsPIC33 and dsPIC30
-      can_set_id(&C1RXF1, (uint32_t)address << 8, CAN_USE_EXTENDED_ID);       //Set Filter 1
-    #else
-      can_set_id(RXFILTER1, (uint32_t)address << 8, CAN_USE_EXTENDED_ID);     //Set Filter 1
-    #endif
-   #else
-      can_set_id(RX0FILTER1, (uint32_t)address << 8, CAN_USE_EXTENDED_ID);    //Set Filter 1
-   #endif
+#if J1939_USE_PROFILER == TRUE
+////////////////////////////////////////////////////////////////////////////////
+//J1939ProfileReset()
+// Clears the profile table and measures the timer counts an empty
+// J1939ProfileStart()/J1939ProfileStop() pair takes, which J1939ProfileUpdate()
+// takes off each measurement.  Called by J1939Init().
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939ProfileReset(void)
+{
+   uint8_t i;
    
-   can_set_mode(CAN_OP_NORMAL);  //put CAN in Normal mode
+   for(i=0;i<J1939_PROFILE_PROBES;i++)
+   {
+      g_J1939Profile[i].Min = 0xFFFF;
+      g_J1939Profile[i].Max = 0;
+      g_J1939Profile[i].Sum = 0;
+      g_J1939Profile[i].Count = 0;
+   }
+   
+   g_J1939ProfileOverhead = 0;
+   
+   J1939ProfileStart(0);
+   J1939ProfileStop(0);
+   
+   g_J1939ProfileOverhead = g_J1939Profile[0].Max;
+   
+   g_J1939Profile[0].Min = 0xFFFF;
+   g_J1939Profile[0].Max = 0;
+   g_J1939Profile[0].Sum = 0;
+   g_J1939Profile[0].Count = 0;
 }
+#endif
 
+#if J1939_USE_CHECKS == TRUE
 ////////////////////////////////////////////////////////////////////////////////
-//xor8()
-// Generates a pseudo-random 8-bit number.  rand_seed is used as a seed
-//   for the algorithm.
+//J1939CheckBuffers()
+// Checks each circular buffer's count isn't more than the buffer holds, its
+// indexes are inside the buffer and the distance from NextOut to NextIn
+// matches the count.  A full buffer has NextIn equal to NextOut.
 //  Parameters: None
-//  Returns:    uint8_t - Pseudo-random value
+//  Returns:    Nothing, failed checks call J1939CheckFailed()
 ////////////////////////////////////////////////////////////////////////////////
-uint8_t xor8(void)
+void J1939CheckBuffers(void)
 {
-   static uint8_t y = 69;
-   static uint8_t z = 29;
-   static uint8_t w = 23;
-   uint8_t t;
+   J1939Check(g_J1939Flags.ReceiveBufferCount <= J1939_RECEIVE_BUFFERS);
+   J1939Check(g_J1939ReceiveNextIn < J1939_RECEIVE_BUFFERS);
+   J1939Check(g_J1939ReceiveNextOut < J1939_RECEIVE_BUFFERS);
+   J1939Check(((g_J1939ReceiveNextIn + J1939_RECEIVE_BUFFERS - g_J1939ReceiveNextOut) % J1939_RECEIVE_BUFFERS) == (g_J1939Flags.ReceiveBufferCount % J1939_RECEIVE_BUFFERS));
+   
+   J1939Check(g_J1939Flags.XmitBufferCount <= J1939_TRANSMIT_BUFFERS);
+   J1939Check(g_J1939XmitNextIn < J1939_TRANSMIT_BUFFERS);
+   J1939Check(g_J1939XmitNextOut < J1939_TRANSMIT_BUFFERS);
+   J1939Check(((g_J1939XmitNextIn + J1939_TRANSMIT_BUFFERS - g_J1939XmitNextOut) % J1939_TRANSMIT_BUFFERS) == (g_J1939Flags.XmitBufferCount % J1939_TRANSMIT_BUFFERS));
+   
+  #if J1939_STAGED_BUFFERS > 0
+   J1939Check(g_J1939Flags.StagedBufferCount <= J1939_STAGED_BUFFERS);
+   J1939Check(g_J1939StagedNextIn < J1939_STAGED_BUFFERS);
+   J1939Check(g_J1939StagedNextOut < J1939_STAGED_BUFFERS);
+   J1939Check(((g_J1939StagedNextIn + J1939_STAGED_BUFFERS - g_J1939StagedNextOut) % J1939_STAGED_BUFFERS) == (g_J1939Flags.StagedBufferCount % J1939_STAGED_BUFFERS));
+  #endif
+}
+#endif
 
-   t = rand_seed ^ (rand_seed << 3);
-   rand_seed = y; y = z; z = w;
-   w = w ^ (w >> 5) ^ (t ^ (t >> 2));
-   return (w);
+////////////////////////////////////////////////////////////////////////////////  Internal Functions
+
+#if J1939_USE_PROFILER == TRUE
+////////////////////////////////////////////////////////////////////////////////
+//J1939ProfileUpdate()
+// Adds the time since J1939ProfileStart() to a probe, used by
+// J1939ProfileStop().  The timer is read by the caller so the call isn't
+// counted.
+//  Parameters: Probe - probe to update
+//              Now - J1939ProfileTimer() at the end of the measurement
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939ProfileUpdate(uint8_t Probe, uint16_t Now)
+{
+   uint16_t Counts;
+   
+   Counts = Now - g_J1939Profile[Probe].Start;
+   
+   if(Counts > g_J1939ProfileOverhead)
+      Counts -= g_J1939ProfileOverhead;
+   else
+      Counts = 0;
+   
+   if(Counts < g_J1939Profile[Probe].Min)
+      g_J1939Profile[Probe].Min = Counts;
+   if(Counts > g_J1939Profile[Probe].Max)
+      g_J1939Profile[Probe].Max = Counts;
+   
+   g_J1939Profile[Probe].Sum += Counts;
+   g_J1939Profile[Probe].Count++;
 }
-     
+#endif
+
+#if J1939_USE_RX_TIMESTAMP == TRUE
+#INT_TIMER1
+void J1939TimerOverflowISR(void)
+{
+   g_J1939TimestampHigh++;
+}
+
+#INT_CCP1
+void J1939CaptureISR(void)
+{
+   uint16_t High;
+   
+   High = g_J1939TimestampHigh;
+   
+   if(interrupt_active(INT_TIMER1) && (CCP_1 < 0x8000))
+      High++;     //Timer1 overflowed before the capture but its interrupt hasn't run yet
+      
+   g_J1939LastSOF = make32(High,CCP_1);
+}
+
+#INT_CANRX0
+void J1939Receive0ISR(void)
+{
+   J1939StampReceiveBuffers();
+}
+
+#INT_CANRX1
+void J1939Receive1ISR(void)
+{
+   J1939StampReceiveBuffers();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939StampReceiveBuffers()
+// Called from the CAN receive interrupts, gives each CAN receive buffer that
+// filled since it was last read the time of the last captured Start Of Frame.
+// The receive interrupt runs at the end of the frame, so the stamp is only
+// wrong if the interrupt is held off until the next frame on the bus starts.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939StampReceiveBuffers(void)
+{
+   uint8_t New, i;
+   
+   New = can_rx_pending() & ~g_J1939BufferStamped;
+   
+   for(i=0;i<8;i++)
+   {
+      if(bit_test(New,i))
+         g_J1939BufferTimestamp[i] = g_J1939LastSOF;
+   }
+   
+   g_J1939BufferStamped |= New;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939TakeTimestamp()
+// Takes the timestamp of the CAN receive buffer just read for the message
+// being received.  If another message already filled the buffer after it was
+// read, that message is stamped now.  Interrupts are held off while the stamps
+// are changed and then put back as they were, so it can be called with them
+// already disabled.
+//  Parameters: Buffer - CAN receive buffer the message was read from
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+#bit J1939_GIE = getenv("BIT:GIE")
+
+void J1939TakeTimestamp(uint8_t Buffer)
+{
+   int1 InterruptsOn;
+   
+   InterruptsOn = J1939_GIE;
+   disable_interrupts(GLOBAL);
+   
+   g_J1939ReceivedTimestamp = g_J1939BufferTimestamp[Buffer];
+   bit_clear(g_J1939BufferStamped,Buffer);
+   
+   if(bit_test(can_rx_pending(),Buffer))
+   {
+      g_J1939BufferTimestamp[Buffer] = g_J1939LastSOF;
+      bit_set(g_J1939BufferStamped,Buffer);
+   }
+   
+   if(InterruptsOn)
+      enable_interrupts(GLOBAL);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939IsAddressClaimMessage()
+// Checks if a message is part of the address claim procedure, an Address
+// Claimed, Cannot Claim Address or Request for Address Claimed, which are
+// sent before the unit has claimed its address.
+//  Parameters: PDU - PDU of message
+//              Data - pointer to message data
+//              Bytes - number of data bytes, a Request needs 3
+//  Returns:    True - if message is part of the address claim procedure
+//              False - if message is an application message
+////////////////////////////////////////////////////////////////////////////////
+int1 J1939IsAddressClaimMessage(J1939_PDU_STRUCT PDU, uint8_t *Data, uint8_t Bytes)
+{
+   if(PDU.PDUFormat == J1939_PF_ADDR_CLAIMED)
+      return(TRUE);
+      
+   if((PDU.PDUFormat == J1939_PF_REQUEST) && (Bytes >= 3) && (Data[0] == 0x00) && (Data[1] == 0xEE) && (Data[2] == 0x00))
+      return(TRUE);
+      
+   return(FALSE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939CheckImmediateClaim()
+// Checks the Address Claim policy to see if unit can use an address as soon
+// as its Address Claimed message is sent.
+//  Parameters: address - address being claimed
+//  Returns:    True - if address can be used without waiting
+//              False - if unit must wait for contending claims
+////////////////////////////////////////////////////////////////////////////////
+int1 J1939CheckImmediateClaim(uint8_t address)
+{
+   switch(g_J1939ImmediateClaim)
+   {
+      case J1939_IMMEDIATE_CLAIM_ALWAYS:
+         return(TRUE);
+      case J1939_IMMEDIATE_CLAIM_FIXED:
+         if(J1939NameArbitraryAddressCapable(g_J1939Name) == FALSE)
+            return((address <= 127) || ((address >= 248) && (address <= 253)));
+         return(FALSE);
+      default:
+         return(FALSE);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939AddressClaimComplete()
+// Marks unit's address as claimed, sets up the CAN filter for messages sent
+// to it and releases the application messages held while claiming.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939AddressClaimComplete(void)
+{
+   g_J1939Flags.AddressClaimed = TRUE;
+   J1939SetCANFilter(g_MyJ1939Address);      //unit claimed address so setup filter to start looking for 
+                                             //J1939 Messages sent to unit's address
+  #if J1939_STAGED_BUFFERS > 0
+   J1939ReleaseStagedMessages();
+  #endif
+}
+
+#if J1939_STAGED_BUFFERS > 0
+////////////////////////////////////////////////////////////////////////////////
+//J1939StageMessage()
+// Loads an application message into the staged buffer while unit is claiming
+// its address.
+//  Parameters: PDU - PDU to send with message
+//              Data - pointer to data to send
+//              Bytes - number of bytes to send, more than 8 is sent as 8
+//  Returns:    True - if message was loaded into the staged buffer
+//              False - if staged buffer was full or unit can't claim an address
+////////////////////////////////////////////////////////////////////////////////
+int1 J1939StageMessage(J1939_PDU_STRUCT PDU, uint8_t *Data, uint8_t Bytes)
+{
+   uint8_t i;
+   
+   if((g_J1939Flags.AddressCannotClaim == TRUE) || (g_J1939Flags.StagedBufferCount >= J1939_STAGED_BUFFERS))
+      return(FALSE);
+      
+   if(Bytes > 8)
+      Bytes = 8;
+      
+   memcpy(&g_J1939StagedBuffer[g_J1939StagedNextIn].PDU,&PDU,sizeof(J1939_PDU_STRUCT));
+   g_J1939StagedBuffer[g_J1939StagedNextIn].Length = Bytes;
+   for(i=0;i<Bytes;i++)
+      g_J1939StagedBuffer[g_J1939StagedNextIn].Data[i] = Data[i];
+      
+   if(++g_J1939StagedNextIn >= J1939_STAGED_BUFFERS)
+      g_J1939StagedNextIn = 0;
+      
+   g_J1939Flags.StagedBufferCount++;
+   
+   return(TRUE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939ReleaseStagedMessages()
+// Moves messages from the staged buffer to the transmit buffer, with the
+// claimed address as Source Address.  Messages that don't fit stay in the
+// staged buffer until J1939XmitTask() has room for them.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939ReleaseStagedMessages(void)
+{
+   while((g_J1939Flags.StagedBufferCount > 0) && (g_J1939Flags.XmitBufferCount < J1939_TRANSMIT_BUFFERS))
+   {
+      g_J1939StagedBuffer[g_J1939StagedNextOut].PDU.SourceAddress = g_MyJ1939Address;
+      memcpy(&g_J1939XmitBuffer[g_J1939XmitNextIn],&g_J1939StagedBuffer[g_J1939StagedNextOut],sizeof(J1939_MESSAGE_STRUCT));
+      
+      if(++g_J1939XmitNextIn >= J1939_TRANSMIT_BUFFERS)
+         g_J1939XmitNextIn = 0;
+         
+      g_J1939Flags.XmitBufferCount++;
+      
+      if(++g_J1939StagedNextOut >= J1939_STAGED_BUFFERS)
+         g_J1939StagedNextOut = 0;
+         
+      g_J1939Flags.StagedBufferCount--;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939FlushStagedMessages()
+// Discards the messages in the staged buffer and resets its indexes, so
+// messages staged later are released in the order they were staged.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939FlushStagedMessages(void)
+{
+   g_J1939StagedNextIn = 0;
+   g_J1939StagedNextOut = 0;
+   g_J1939Flags.StagedBufferCount = 0;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939ClaimAddress()
+// Sends an Address Claimed message to claim address in g_MyJ1939Address.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939ClaimAddress(void)
+{
+   J1939_PDU_STRUCT RequestPDU;
+
+   RequestPDU.SourceAddress = g_MyJ1939Address;
+   RequestPDU.DestinationAddress = J1939_GLOBAL_ADDRESS;
+   RequestPDU.PDUFormat = J1939_PF_ADDR_CLAIMED;
+   RequestPDU.DataPage = 0;
+   RequestPDU.ExtendedDataPage = 0;
+   RequestPDU.Priority = J1939_REQUEST_PRIORITY;
+   
+   g_J1939Flags.AddressNewClaim = TRUE;
+   
+   J1939PutMessage(RequestPDU,g_J1939Name,8);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939CompareName()
+// Compares our name with received name to determine which has priority.  The
+// Names are compared as 64-bit numbers, most significant word first, the
+// lower number has priority.
+//  Parameters: data - pointer to received name
+//  Returns:    True - if our name is high priority
+//              False - if our name is lower priority
+////////////////////////////////////////////////////////////////////////////////
+int1 J1939CompareName(uint8_t *data)
+{
+   J1939_NAME Name;
+   
+   J1939PackName(data,&Name);
+   
+   if(g_J1939PackedName.High != Name.High)
+      return(g_J1939PackedName.High < Name.High);
+      
+   return(g_J1939PackedName.Low <= Name.Low);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939PackName()
+// Packs an 8 byte J1939 Name, in the byte order it's transmitted, into two
+// 32-bit words.
+//  Parameters: Name - pointer to 8 byte J1939 Name
+//              Packed - pointer to return packed Name to
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939PackName(uint8_t *Name, J1939_NAME *Packed)
+{
+   Packed->Low = ((uint32_t)Name[3] << 24) | ((uint32_t)Name[2] << 16) | ((uint16_t)Name[1] << 8) | Name[0];
+   Packed->High = ((uint32_t)Name[7] << 24) | ((uint32_t)Name[6] << 16) | ((uint16_t)Name[5] << 8) | Name[4];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939UnpackName()
+// Unpacks a packed J1939 Name into 8 bytes in the order it's transmitted.
+//  Parameters: Packed - pointer to packed Name
+//              Name - pointer to return 8 byte J1939 Name to
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939UnpackName(J1939_NAME *Packed, uint8_t *Name)
+{
+   Name[0] = (uint8_t)Packed->Low;
+   Name[1] = (uint8_t)(Packed->Low >> 8);
+   Name[2] = (uint8_t)(Packed->Low >> 16);
+   Name[3] = (uint8_t)(Packed->Low >> 24);
+   Name[4] = (uint8_t)Packed->High;
+   Name[5] = (uint8_t)(Packed->High >> 8);
+   Name[6] = (uint8_t)(Packed->High >> 16);
+   Name[7] = (uint8_t)(Packed->High >> 24);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939BuildName()
+// Builds an 8 byte J1939 Name from its fields, fields that are too large are
+// truncated to the number of bits they have in the Name.
+//  Parameters: Fields - pointer to Name fields
+//              Name - pointer to return 8 byte J1939 Name to
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939BuildName(J1939_NAME_FIELDS *Fields, uint8_t *Name)
+{
+   J1939_NAME Packed;
+   
+   Packed.Low = (Fields->IdentityNumber & 0x001FFFFF) | ((uint32_t)(Fields->ManufacturerCode & 0x07FF) << 21);
+   
+   Packed.High = (Fields->EcuInstance & 0x07) | ((Fields->FunctionInstance & 0x1F) << 3);
+   Packed.High |= (uint16_t)Fields->Function << 8;
+   Packed.High |= (uint32_t)(Fields->VehicleSystem & 0x7F) << 17;         //bit 16 (Name bit 48) is reserved
+   Packed.High |= (uint32_t)(Fields->VehicleSystemInstance & 0x0F) << 24;
+   Packed.High |= (uint32_t)(Fields->IndustryGroup & 0x07) << 28;
+   
+   if(Fields->ArbitraryAddressCapable)
+      Packed.High |= 0x80000000;
+   
+   J1939UnpackName(&Packed,Name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939HandleAddressRequest()
+// Generates response to J1939 Address Requests
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939HandleAddressRequest(void)
+{
+   J1939_PDU_STRUCT RequestPDU;
+   
+   if(g_J1939Flags.AddressClaimed != TRUE)
+      RequestPDU.SourceAddress = J1939_NULL_ADDRESS;
+   else
+      RequestPDU.SourceAddress = g_MyJ1939Address;
+   
+   RequestPDU.DestinationAddress = J1939_GLOBAL_ADDRESS;
+   RequestPDU.PDUFormat = J1939_PF_ADDR_CLAIMED;            //value is the same for both Address Claimed and Cannot Claim Address
+   RequestPDU.DataPage = 0;
+   RequestPDU.ExtendedDataPage = 0;
+   RequestPDU.Priority = J1939_REQUEST_PRIORITY;
+   
+   if((g_J1939Flags.AddressClaimed == TRUE) || (g_J1939Flags.AddressClaimSent == TRUE))  //don't respond to request if an address claim hasn't been sent
+      J1939PutMessage(RequestPDU,g_J1939Name,8);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939LoadReceiveBuffer()
+// Loads g_J1939ReceiveBuffer with passed data and updates global indexes.
+//  Parameters: ReceivedPDU - the PDU of the received CAN message
+//              Data - pointer to the received CAN data
+//              length - number of bytes received in CAN message
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939LoadReceiveBuffer(J1939_PDU_STRUCT ReceivedPDU,uint8_t *Data,uint8_t length)
+{
+   uint8_t i;
+   
+   memcpy(&g_J1939ReceiveBuffer[g_J1939ReceiveNextIn].PDU,&ReceivedPDU,sizeof(J1939_PDU_STRUCT));
+   g_J1939ReceiveBuffer[g_J1939ReceiveNextIn].Length = length;
+   for(i=0;i<length;i++)
+      g_J1939ReceiveBuffer[g_J1939ReceiveNextIn].Data[i] = Data[i];
+   
+  #if J1939_USE_RX_TIMESTAMP == TRUE
+   g_J1939ReceiveTimestamp[g_J1939ReceiveNextIn] = g_J1939ReceivedTimestamp;
+  #endif
+   
+   if(++g_J1939ReceiveNextIn >= J1939_RECEIVE_BUFFERS)
+      g_J1939ReceiveNextIn = 0;
+      
+   g_J1939Flags.ReceiveBufferCount++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939HandleAddressClaim()
+// Responses to a J1939 Address Claim message.  Compares unit's Address and Name
+// to the Source Address and Name of the received J1939 Address Claim message,
+// and either response with Address Claimed, Cannot Claim Address or if unit is
+// Arbitrary Address Capable and if received Name is higher priority then unit's
+// name it sends a new Address Request with an address from 128 to 247 selected
+// by J1939SelectAddress().  Claims for other addresses are only recorded in the
+// address map.  A claim for unit's address that loses to unit's Name isn't
+// recorded, the loser has to move, so its Name is removed from the map instead.
+//  Parameters: ReceivedPDU - the PDU of received Address Claim message
+//              Name - pointer to the J1939 Name of Address Claimer
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939HandleAddressClaim(J1939_PDU_STRUCT ReceivedPDU, uint8_t *Name)
+{
+   J1939_PDU_STRUCT RequestPDU;
+   int1 Contending;
+   int1 UnitWins = FALSE;
+   
+   //claim is for the address unit has claimed or is claiming
+   Contending = (ReceivedPDU.SourceAddress != J1939_NULL_ADDRESS) && (g_J1939Flags.AddressClaimSent) &&
+                (ReceivedPDU.SourceAddress == g_MyJ1939Address) && (g_J1939Flags.AddressCannotClaim == FALSE);
+   
+   if(Contending)
+      UnitWins = J1939CompareName(Name);
+   
+  #if J1939_ADDRESS_MAP_ENTRIES > 0
+   if(UnitWins)
+      J1939UpdateAddressMap(J1939_NULL_ADDRESS,Name);    //claimer lost and has to move, it doesn't hold this address or its old one
+   else
+      J1939UpdateAddressMap(ReceivedPDU.SourceAddress,Name);
+  #endif
+   
+   if(Contending)
+   {
+      RequestPDU.DestinationAddress = J1939_GLOBAL_ADDRESS;
+      RequestPDU.PDUFormat = J1939_PF_ADDR_CLAIMED;            //value is the same for both Address Claimed and Cannot Claim Address
+      RequestPDU.DataPage = 0;
+      RequestPDU.ExtendedDataPage = 0;
+      RequestPDU.Priority = J1939_REQUEST_PRIORITY;
+
+      if(UnitWins)
+      {
+         RequestPDU.SourceAddress = g_MyJ1939Address;
+      }
+      else
+      {
+         if(g_J1939Flags.AddressClaimed)
+            J1939SetCANFilter(J1939_GLOBAL_ADDRESS);  //Only do this if unit already claimed address,
+                                                      //because this can switch CAN to CONFIG mode.
+         //Clear Address Claim Flags
+         g_J1939Flags.AddressClaimed = FALSE;
+         
+         //Clear Transmit Buffer
+         g_J1939XmitNextOut = 0;
+         g_J1939XmitNextIn = 0;
+         g_J1939Flags.XmitBufferCount = 0;
+         
+         if(J1939NameArbitraryAddressCapable(g_J1939Name) == FALSE)   //If not Arbitrary Address Capable send Cannot Claim Address
+         {
+            RequestPDU.SourceAddress = J1939_NULL_ADDRESS;
+            g_J1939Flags.AddressCannotClaim = TRUE;
+           #if J1939_STAGED_BUFFERS > 0
+            J1939FlushStagedMessages();   //unit will never claim an address, discard held messages
+           #endif
+         }
+         else  //If Arbitrary Address Capable select a new address from 128 to 247 and request
+         {
+            RequestPDU.SourceAddress = J1939SelectAddress(g_MyJ1939Address);
+            
+            if(RequestPDU.SourceAddress == J1939_NULL_ADDRESS)    //no free address, send Cannot Claim Address
+            {
+               g_J1939Flags.AddressCannotClaim = TRUE;
+              #if J1939_STAGED_BUFFERS > 0
+               J1939FlushStagedMessages();
+              #endif
+            }
+            else
+            {
+               g_MyJ1939Address = RequestPDU.SourceAddress;
+               g_J1939Flags.AddressNewClaim = TRUE;
+            }
+         }
+      }
+      
+      if(RequestPDU.SourceAddress == J1939_NULL_ADDRESS)
+      {
+         g_J1939PreviousCannotClaimTick = J1939GetTick();
+         g_J1939CannotClaimDelay = ((uint32_t)xor8() * 53125) / 100000;    //Generate Random delay from 0 to 135ms
+      }
+         
+      J1939PutMessage(RequestPDU,g_J1939Name,8);
+   }
+}
+      
+////////////////////////////////////////////////////////////////////////////////
+//J1939SetCANFilter()
+// Sets filter 1 of CAN module to receive unit's address after unit it has
+// successfully claimed an address.  The CAN module doesn't receive while it's
+// in Config mode, so the filter value is worked out before switching modes.
+// With J1939_USE_PROFILER the Config mode window is measured in timer counts
+// by the J1939_PROFILE_FILTER_CONFIG probe, a tick is too coarse for it.
+//
+// With J1939_HITLESS_FILTER the CAN filters aren't written at all, the address
+// is kept in g_J1939FilterAddress for J1939ReceiveTask() to check, so the CAN
+// module never leaves Normal mode.
+//  Parameters: address - address to set filter to
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939SetCANFilter(uint8_t address)
+{
+   uint32_t Filter;
+   
+   Filter = (uint32_t)address << 8;
+   
+   g_J1939FilterChanges++;
+   
+  #if J1939_HITLESS_FILTER == TRUE
+   g_J1939FilterAddress = address;     //mask 0 is open, J1939ReceiveTask() filters destination in software
+  #else
+   J1939ProfileStart(J1939_PROFILE_FILTER_CONFIG);
+   
+   can_set_mode(CAN_OP_CONFIG);  //put CAN in Config mode
+
+   #if (USE_INTERNAL_CAN == TRUE)
+    #if defined(__PCD__)   //PIC24, dsPIC33 and dsPIC30
+      can_set_id(&C1RXF1, Filter, CAN_USE_EXTENDED_ID);       //Set Filter 1
+    #else
+      can_set_id(RXFILTER1, Filter, CAN_USE_EXTENDED_ID);     //Set Filter 1
+    #endif
+   #else
+      can_set_id(RX0FILTER1, Filter, CAN_USE_EXTENDED_ID);    //Set Filter 1
+   #endif
+   
+   can_set_mode(CAN_OP_NORMAL);  //put CAN in Normal mode
+   
+   J1939ProfileStop(J1939_PROFILE_FILTER_CONFIG);
+  #endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939IDToPDU()
+// Splits a 29-bit CAN ID into the fields of a J1939 PDU.  Uses shifts only, so
+// it doesn't depend on how the compiler lays out J1939_PDU_STRUCT.
+//  Parameters: ID - 29-bit CAN ID
+//              PDU - pointer to PDU to fill in
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939IDToPDU(uint32_t ID, J1939_PDU_STRUCT *PDU)
+{
+   PDU->SourceAddress = (uint8_t)ID;
+   PDU->DestinationAddress = (uint8_t)(ID >> 8);
+   PDU->PDUFormat = (uint8_t)(ID >> 16);
+   PDU->DataPage = ((ID >> 24) & 1);
+   PDU->ExtendedDataPage = ((ID >> 25) & 1);
+   PDU->Priority = ((ID >> 26) & 7);
+   PDU->unused7_5 = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939PDUToID()
+// Builds a 29-bit CAN ID from the fields of a J1939 PDU, the reverse of
+// J1939IDToPDU().
+//  Parameters: PDU - pointer to PDU
+//  Returns:    uint32_t - 29-bit CAN ID
+////////////////////////////////////////////////////////////////////////////////
+uint32_t J1939PDUToID(J1939_PDU_STRUCT *PDU)
+{
+   uint32_t ID;
+   
+   ID = ((uint32_t)PDU->Priority << 26) | ((uint32_t)PDU->ExtendedDataPage << 25) | ((uint32_t)PDU->DataPage << 24);
+   ID |= ((uint32_t)PDU->PDUFormat << 16) | ((uint16_t)PDU->DestinationAddress << 8) | PDU->SourceAddress;
+   
+   return(ID);
+}
+
+#if J1939_USE_ID_REGISTERS == TRUE
+////////////////////////////////////////////////////////////////////////////////
+//J1939RegistersToPDU()
+// Fills in a J1939 PDU straight from the ECAN ID registers, SIDH holds
+// priority, EDP, DP and the top 3 bits of PDU Format, SIDL the rest of PDU
+// Format around the extended ID bit, EIDH is PDU Specific and EIDL is Source
+// Address.
+//  Parameters: Registers - pointer to SIDH, SIDL, EIDH and EIDL
+//              PDU - pointer to PDU to fill in
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939RegistersToPDU(uint8_t *Registers, J1939_PDU_STRUCT *PDU)
+{
+   PDU->Priority = Registers[0] >> 5;
+   PDU->ExtendedDataPage = ((Registers[0] & 0x10) != 0);
+   PDU->DataPage = ((Registers[0] & 0x08) != 0);
+   PDU->PDUFormat = (Registers[0] << 5) | ((Registers[1] >> 3) & 0x1C) | (Registers[1] & 0x03);
+   PDU->DestinationAddress = Registers[2];
+   PDU->SourceAddress = Registers[3];
+   PDU->unused7_5 = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939PDUToRegisters()
+// Builds the ECAN ID registers for an extended ID from a J1939 PDU, the
+// reverse of J1939RegistersToPDU().
+//  Parameters: PDU - pointer to PDU
+//              Registers - pointer to SIDH, SIDL, EIDH and EIDL to fill in
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939PDUToRegisters(J1939_PDU_STRUCT *PDU, uint8_t *Registers)
+{
+   Registers[0] = (PDU->Priority << 5) | (PDU->PDUFormat >> 5);
+   if(PDU->ExtendedDataPage)
+      Registers[0] |= 0x10;
+   if(PDU->DataPage)
+      Registers[0] |= 0x08;
+   Registers[1] = ((PDU->PDUFormat << 3) & 0xE0) | 0x08 | (PDU->PDUFormat & 0x03);    //0x08 is extended ID bit
+   Registers[2] = PDU->DestinationAddress;
+   Registers[3] = PDU->SourceAddress;
+}
+#endif
+
+#if J1939_USE_COMMANDED_ADDRESS == TRUE
+////////////////////////////////////////////////////////////////////////////////
+//J1939HandleCommandedAddress()
+// Receives the BAM carrying a Commanded Address message, and if the J1939 Name
+// in it matches unit's name claims the commanded address.  Other BAM sessions
+// and RTS/CTS sessions are left to the application.
+//  Parameters: ReceivedPDU - the PDU of received TP.CM or TP.DT message
+//              Data - pointer to received data
+//              length - number of bytes received
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939HandleCommandedAddress(J1939_PDU_STRUCT ReceivedPDU, uint8_t *Data, uint8_t length)
+{
+   uint8_t i, j;
+   J1939_TICK_TYPE CurrentTick;
+   
+   if(length < 8)
+      return;
+   
+   if(ReceivedPDU.PDUFormat == J1939_PF_PT_CM)
+   {
+      if((Data[0] == J1939_TP_CM_BAM) && (Data[1] == J1939_COMMANDED_ADDRESS_SIZE) && (Data[2] == 0) && (Data[3] == J1939_COMMANDED_ADDRESS_PACKETS) &&
+         (Data[5] == J1939_PS_COMMANDED_ADDRESS) && (Data[6] == J1939_PF_BROADCAST) && (Data[7] == 0))
+      {
+         g_J1939CommandedAddress.SourceAddress = ReceivedPDU.SourceAddress;
+         g_J1939CommandedAddress.NextPacket = 1;
+         g_J1939CommandedAddress.Tick = J1939GetTick();
+      }
+      else if(ReceivedPDU.SourceAddress == g_J1939CommandedAddress.SourceAddress)
+         g_J1939CommandedAddress.NextPacket = 0;   //new BAM from same unit ends the session
+         
+      return;
+   }
+   
+   if((g_J1939CommandedAddress.NextPacket == 0) || (ReceivedPDU.SourceAddress != g_J1939CommandedAddress.SourceAddress))
+      return;
+      
+   CurrentTick = J1939GetTick();
+   
+   if((Data[0] != g_J1939CommandedAddress.NextPacket) || (J1939GetTickDifference(CurrentTick, g_J1939CommandedAddress.Tick) > J1939_TP_TIMEOUT_T1))
+   {
+      g_J1939CommandedAddress.NextPacket = 0;   //packet missed, discard session
+      return;
+   }
+   
+   j = (Data[0] - 1) * 7;
+   for(i=1;i<8;i++)
+      g_J1939CommandedAddress.Data[j++] = Data[i];
+      
+   g_J1939CommandedAddress.Tick = CurrentTick;
+   
+   if(++g_J1939CommandedAddress.NextPacket <= J1939_COMMANDED_ADDRESS_PACKETS)
+      return;
+      
+   g_J1939CommandedAddress.NextPacket = 0;
+   
+   if(memcmp(g_J1939CommandedAddress.Data,g_J1939Name,8) == 0)
+      J1939ChangeAddress(g_J1939CommandedAddress.Data[8]);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//xor8()
+// Generates a pseudo-random 8-bit number.  rand_seed, rand_y, rand_z and rand_w
+//   hold the state of the algorithm.
+//  Parameters: None
+//  Returns:    uint8_t - Pseudo-random value
+////////////////////////////////////////////////////////////////////////////////
+uint8_t xor8(void)
+{
+   uint8_t t;
+
+   t = rand_seed ^ (rand_seed << 3);
+   rand_seed = rand_y; rand_y = rand_z; rand_z = rand_w;
+   rand_w = rand_w ^ (rand_w >> 5) ^ (t ^ (t >> 2));
+   return (rand_w);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939SeedRandom()
+// Seeds the pseudo-random generator from the Identity Number of the unit's
+// J1939 Name and the current tick, so that units built with the same firmware
+// select different addresses and delays.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939SeedRandom(void)
+{
+   J1939_TICK_TYPE Tick;
+   
+   Tick = J1939GetTick();
+   
+   rand_seed = g_J1939Name[0] ^ (uint8_t)Tick;
+   rand_y = g_J1939Name[1] ^ 69;
+   rand_z = (g_J1939Name[2] & 0x1F) ^ 29;
+   rand_w = (uint8_t)(Tick >> 8) ^ 23;
+   
+   if((rand_seed | rand_y | rand_z | rand_w) == 0)    //generator would stay at 0
+      rand_w = 23;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939AddressInUse()
+// Checks the address map to see if another unit has claimed an address.
+//  Parameters: address - address to check
+//  Returns:    True - if another unit is known to have claimed address
+//              False - if address isn't known to be claimed
+////////////////////////////////////////////////////////////////////////////////
+int1 J1939AddressInUse(uint8_t address)
+{
+  #if J1939_ADDRESS_MAP_ENTRIES > 0
+   if(address < J1939_NULL_ADDRESS)
+      return(g_J1939AddressIndex[address] != J1939_ADDRESS_MAP_NONE);
+  #endif
+  
+   return(FALSE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939SelectAddress()
+// Selects a new address after unit lost its address.  First walks the
+// J1939_PREFERRED_ADDRESSES list, if defined, then starts at a random address
+// from 128 to 247 and looks for one that isn't in the address map.
+//  Parameters: LostAddress - address unit just lost, never selected
+//  Returns:    uint8_t - new address, or J1939_NULL_ADDRESS if all addresses
+//                        from 128 to 247 are in use
+////////////////////////////////////////////////////////////////////////////////
+uint8_t J1939SelectAddress(uint8_t LostAddress)
+{
+   uint8_t address;
+   uint8_t i;
+   
+  #ifdef J1939_PREFERRED_ADDRESSES
+   while(g_J1939PreferredIndex < sizeof(g_J1939PreferredAddresses))
+   {
+      address = g_J1939PreferredAddresses[g_J1939PreferredIndex++];
+      
+      if((address != LostAddress) && (address < J1939_NULL_ADDRESS) && (J1939AddressInUse(address) == FALSE))
+         return(address);
+   }
+  #endif
+  
+   address = (((uint16_t)xor8() * (J1939_ARBITRARY_ADDRESS_LAST - J1939_ARBITRARY_ADDRESS_FIRST + 1)) >> 8) + J1939_ARBITRARY_ADDRESS_FIRST;
+   
+   for(i=0;i<(J1939_ARBITRARY_ADDRESS_LAST - J1939_ARBITRARY_ADDRESS_FIRST + 1);i++)
+   {
+      if((address != LostAddress) && (J1939AddressInUse(address) == FALSE))
+         return(address);
+         
+      if(++address > J1939_ARBITRARY_ADDRESS_LAST)
+         address = J1939_ARBITRARY_ADDRESS_FIRST;
+   }
+   
+   return(J1939_NULL_ADDRESS);
+}
+
+#if J1939_ADDRESS_MAP_ENTRIES > 0
+////////////////////////////////////////////////////////////////////////////////  Address Map Functions
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939HashName()
+// Generates the address map hash bucket of a J1939 Name.
+//  Parameters: Name - pointer to packed J1939 Name
+//  Returns:    uint8_t - hash bucket, 0 to J1939_ADDRESS_MAP_HASH_SIZE-1
+////////////////////////////////////////////////////////////////////////////////
+uint8_t J1939HashName(J1939_NAME *Name)
+{
+   uint32_t hash;
+   
+   hash = Name->Low ^ Name->High;
+   hash ^= hash >> 16;
+   
+   return(((uint8_t)hash ^ (uint8_t)(hash >> 8)) & (J1939_ADDRESS_MAP_HASH_SIZE - 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939FindName()
+// Finds the address map entry of a J1939 Name.
+//  Parameters: Name - pointer to packed J1939 Name
+//  Returns:    uint8_t - index into g_J1939AddressMap, or J1939_ADDRESS_MAP_NONE
+//                        if Name isn't in address map
+////////////////////////////////////////////////////////////////////////////////
+uint8_t J1939FindName(J1939_NAME *Name)
+{
+   uint8_t entry;
+   
+   entry = g_J1939NameHash[J1939HashName(Name)];
+   
+   while(entry != J1939_ADDRESS_MAP_NONE)
+   {
+      if((g_J1939AddressMap[entry].Name.Low == Name->Low) && (g_J1939AddressMap[entry].Name.High == Name->High))
+         break;
+         
+      entry = g_J1939AddressMap[entry].NextHash;
+   }
+   
+   return(entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939RemoveMapEntry()
+// Removes an entry from the address map and from its Name and Function hash
+// buckets.
+//  Parameters: entry - index into g_J1939AddressMap of entry to remove
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939RemoveMapEntry(uint8_t entry)
+{
+   uint8_t bucket;
+   uint8_t i;
+   
+   if(g_J1939AddressMap[entry].Address < J1939_NULL_ADDRESS)
+   {
+      if(g_J1939AddressIndex[g_J1939AddressMap[entry].Address] == entry)
+         g_J1939AddressIndex[g_J1939AddressMap[entry].Address] = J1939_ADDRESS_MAP_NONE;
+   }
+   
+   bucket = J1939HashName(&g_J1939AddressMap[entry].Name);
+   
+   if(g_J1939NameHash[bucket] == entry)
+      g_J1939NameHash[bucket] = g_J1939AddressMap[entry].NextHash;
+   else
+   {
+      i = g_J1939NameHash[bucket];
+      
+      while(i != J1939_ADDRESS_MAP_NONE)
+      {
+         if(g_J1939AddressMap[i].NextHash == entry)
+         {
+            g_J1939AddressMap[i].NextHash = g_J1939AddressMap[entry].NextHash;
+            break;
+         }
+         
+         i = g_J1939AddressMap[i].NextHash;
+      }
+   }
+   
+   bucket = J1939_FUNCTION_HASH(g_J1939AddressMap[entry].Name);
+   
+   if(g_J1939FunctionHash[bucket] == entry)
+      g_J1939FunctionHash[bucket] = g_J1939AddressMap[entry].NextFunction;
+   else
+   {
+      i = g_J1939FunctionHash[bucket];
+      
+      while(i != J1939_ADDRESS_MAP_NONE)
+      {
+         if(g_J1939AddressMap[i].NextFunction == entry)
+         {
+            g_J1939AddressMap[i].NextFunction = g_J1939AddressMap[entry].NextFunction;
+            break;
+         }
+         
+         i = g_J1939AddressMap[i].NextFunction;
+      }
+   }
+   
+   g_J1939AddressMap[entry].Address = J1939_NULL_ADDRESS;
+   g_J1939AddressMap[entry].NextHash = J1939_ADDRESS_MAP_NONE;
+   g_J1939AddressMap[entry].NextFunction = J1939_ADDRESS_MAP_NONE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939ClearAddressMap()
+// Removes all entries from the address map.
+//  Parameters: None
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939ClearAddressMap(void)
+{
+   uint8_t i;
+   
+   for(i=0;i<J1939_ADDRESS_MAP_ENTRIES;i++)
+   {
+      g_J1939AddressMap[i].Address = J1939_NULL_ADDRESS;
+      g_J1939AddressMap[i].NextHash = J1939_ADDRESS_MAP_NONE;
+      g_J1939AddressMap[i].NextFunction = J1939_ADDRESS_MAP_NONE;
+   }
+   
+   memset(g_J1939AddressIndex,J1939_ADDRESS_MAP_NONE,sizeof(g_J1939AddressIndex));
+   memset(g_J1939NameHash,J1939_ADDRESS_MAP_NONE,sizeof(g_J1939NameHash));
+   memset(g_J1939FunctionHash,J1939_ADDRESS_MAP_NONE,sizeof(g_J1939FunctionHash));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939UpdateAddressMap()
+// Updates the address map from a received Address Claimed or Cannot Claim
+// Address message.  A Cannot Claim Address removes the Name from the map, an
+// Address Claimed moves the Name to the claimed address and removes any other
+// Name that had that address.  If the map is full new Names are not added.
+//  Parameters: Address - Source Address of received message
+//              Name - pointer to the J1939 Name in received message
+//  Returns:    Nothing
+////////////////////////////////////////////////////////////////////////////////
+void J1939UpdateAddressMap(uint8_t Address, uint8_t *Name)
+{
+   J1939_NAME Packed;
+   uint8_t entry;
+   uint8_t other;
+   uint8_t bucket;
+   
+   J1939PackName(Name,&Packed);
+   
+   entry = J1939FindName(&Packed);
+   
+   if(Address >= J1939_NULL_ADDRESS)   //Cannot Claim Address, age Name out of the map
+   {
+      if(entry != J1939_ADDRESS_MAP_NONE)
+         J1939RemoveMapEntry(entry);
+      return;
+   }
+   
+   other = g_J1939AddressIndex[Address];
+   
+   if((other != J1939_ADDRESS_MAP_NONE) && (other != entry))   //address now belongs to a different Name
+      J1939RemoveMapEntry(other);
+   
+   if(entry == J1939_ADDRESS_MAP_NONE)
+   {
+      for(entry=0;entry<J1939_ADDRESS_MAP_ENTRIES;entry++)
+      {
+         if(g_J1939AddressMap[entry].Address == J1939_NULL_ADDRESS)
+            break;
+      }
+      
+      if(entry >= J1939_ADDRESS_MAP_ENTRIES)    //address map is full
+         return;
+      
+      g_J1939AddressMap[entry].Name = Packed;
+      
+      bucket = J1939HashName(&Packed);
+      g_J1939AddressMap[entry].NextHash = g_J1939NameHash[bucket];
+      g_J1939NameHash[bucket] = entry;
+      
+      bucket = J1939_FUNCTION_HASH(Packed);
+      g_J1939AddressMap[entry].NextFunction = g_J1939FunctionHash[bucket];
+      g_J1939FunctionHash[bucket] = entry;
+   }
+   else if(g_J1939AddressMap[entry].Address != Address)
+   {
+      if(g_J1939AddressIndex[g_J1939AddressMap[entry].Address] == entry)
+         g_J1939AddressIndex[g_J1939AddressMap[entry].Address] = J1939_ADDRESS_MAP_NONE;
+   }
+   
+   g_J1939AddressMap[entry].Address = Address;
+   g_J1939AddressIndex[Address] = entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939GetAddressOfName()
+// Looks up the address currently claimed by a J1939 Name.
+//  Parameters: Name - pointer to J1939 Name to look up
+//  Returns:    uint8_t - claimed address, or J1939_NULL_ADDRESS if Name isn't
+//                        known to have claimed an address
+////////////////////////////////////////////////////////////////////////////////
+uint8_t J1939GetAddressOfName(uint8_t *Name)
+{
+   J1939_NAME Packed;
+   uint8_t entry;
+   
+   J1939PackName(Name,&Packed);
+   
+   entry = J1939FindName(&Packed);
+   
+   if(entry == J1939_ADDRESS_MAP_NONE)
+      return(J1939_NULL_ADDRESS);
+   else
+      return(g_J1939AddressMap[entry].Address);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939GetNameOfAddress()
+// Looks up the J1939 Name that has claimed an address.
+//  Parameters: Address - address to look up
+//              Name - pointer to return the 8 byte J1939 Name to
+//  Returns:    True - if address has been claimed and Name was returned
+//              False - if address isn't known to be claimed
+////////////////////////////////////////////////////////////////////////////////
+int1 J1939GetNameOfAddress(uint8_t Address, uint8_t *Name)
+{
+   uint8_t entry;
+   
+   if(Address >= J1939_NULL_ADDRESS)
+      return(FALSE);
+      
+   entry = g_J1939AddressIndex[Address];
+   
+   if(entry == J1939_ADDRESS_MAP_NONE)
+      return(FALSE);
+   
+   J1939UnpackName(&g_J1939AddressMap[entry].Name,Name);
+   
+   return(TRUE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//J1939GetAddressOfFunction()
+// Looks up the address currently claimed by a unit in the address map with the
+// specified Function (byte 5 of J1939 Name), for example 0 for the engine.  Only
+// the units in the Function's hash bucket are compared, the most recently added
+// first.
+//  Parameters: Function - J1939 Function to look up
+//  Returns:    uint8_t - claimed address, or J1939_NULL_ADDRESS if no unit
+//                        with Function has claimed an address
+////////////////////////////////////////////////////////////////////////////////
+uint8_t J1939GetAddressOfFunction(uint8_t Function)
+{
+   uint8_t entry;
+   
+   entry = g_J1939FunctionHash[Function & (J1939_ADDRESS_MAP_HASH_SIZE - 1)];
+   
+   while(entry != J1939_ADDRESS_MAP_NONE)
+   {
+      if(J1939_NAME_FUNCTION(g_J1939AddressMap[entry].Name) == Function)
+         return(g_J1939AddressMap[entry].Address);
+         
+      entry = g_J1939AddressMap[entry].NextFunction;
+   }
+   
+   return(J1939_NULL_ADDRESS);
+}
+#endif
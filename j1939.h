@@ -1,363 +1,759 @@
-////////////////////////////////////////////////////////////////////////////////
-////                                J1939.h                                 ////
-////                                                                        ////
-//// Prototypes, defines and global variable used with the J1939 Driver.    ////
-////                                                                        ////
-////////////////////////////////////////////////////////////////////////////////
-////        (C) Copyright 1996,2012 Custom Computer Services                ////
-//// This source code may only be used by licensed users of the CCS         ////
-//// C compiler.  This source code may only be distributed to other         ////
-//// licensed users of the CCS C compiler.  No other use,                   ////
-//// reproduction or distribution is permitted without written              ////
-//// permission.  Derivative programs created using this software           ////
-//// in object code form are not restricted in any way.                     ////
-////////////////////////////////////////////////////////////////////////////////
-#ifndef _J1939_H
-#define _J1939_H
-
-#include <stdint.h>
-
-#ifndef USE_INTERNAL_CAN
-#define USE_INTERNAL_CAN TRUE
-#endif
-
-#ifndef J1939_RECEIVE_BUFFERS
-#define J1939_RECEIVE_BUFFERS    16
-#endif
-
-#if J1939_RECEIVE_BUFFERS < 2
-#undef J1939_RECEIVE_BUFFERS
-#define J1939_RECEIVE_BUFFERS    2  //required to be able to receive one RTS/CTS session and one BAM session at same time
-#endif
-
-#ifndef J1939_TRANSMIT_BUFFERS
-#define J1939_TRANSMIT_BUFFERS   2
-#endif
-
-#if J1939_TRANSMIT_BUFFERS == 0
-#undef J1939_TRANSMIT_BUFFERS
-#define J1939_TRANSMIT_BUFFERS   1
-#endif
-
-////////////////////////////////////////////////////////////////////////////////  Global variables
-
-//global variables containing unit's J1939 Address and Name
-uint8_t g_MyJ1939Address;
-uint8_t g_J1939Name[8];
-
-//global J1939 tick variables
-
-J1939_TICK_TYPE g_J1939CurrentClaimTick, g_J1939PreviousClaimTick;
-J1939_TICK_TYPE g_J1939PreviousCannotClaimTick;
-J1939_TICK_TYPE g_J1939CannotClaimDelay;
-
-//J1939 PDU Structure
-typedef struct _J1939_PDU_STRUCT {
-   uint8_t SourceAddress;
-   uint8_t DestinationAddress;   //Also Group Extension for PDU2 messages
-   uint8_t PDUFormat;
-   int1    DataPage;
-   int1    ExtendedDataPage;     //Set to 0 for J1939
-   uint8_t Priority:3;
-   uint8_t unused7_5:3;          //unused bits don't do anything with them
-} J1939_PDU_STRUCT;
-
-//J1939 Message Structure
-typedef struct _J1939_MESSAGE_STRUCT {
-   J1939_PDU_STRUCT PDU;
-   uint8_t Length;
-   uint8_t Data[8];
-} J1939_MESSAGE_STRUCT;
-
-//global J1939 Receive and Transmit buffers
-J1939_MESSAGE_STRUCT g_J1939ReceiveBuffer[J1939_RECEIVE_BUFFERS];
-J1939_MESSAGE_STRUCT g_J1939XmitBuffer[J1939_TRANSMIT_BUFFERS];
-
-//global J1939 variable for indexing J1939 Receive and Transmit buffers
-static uint8_t g_J1939ReceiveNextIn;
-static uint8_t g_J1939ReceiveNextOut;
-static uint8_t g_J1939XmitNextIn;
-static uint8_t g_J1939XmitNextOut;
-
-//J1939 Flag structure
-typedef struct _J1939_FLAGS_STRUCT {
-   int1    AddressClaimed;       //Unit Successfully claimed an address
-   int1    AddressClaimSent;     //Unit has sent a claim request
-   int1    AddressNewClaim;      //Used to specify if claim request is for a new address
-   int1    AddressCannotClaim;   //If not arbitrary address capable, is set if unit can't claim address
-   uint8_t unused4_1:4;
-   uint8_t ReceiveBufferCount;   //Keep track of number of stored messages in receive buffer
-   uint8_t XmitBufferCount;      //Keep track of number of messages that still need transmitted
-} J1939_FLAGS_STRUCT;
-
-//global J1939 Flag structure variable
-J1939_FLAGS_STRUCT g_J1939Flags;
-
-//global variable used in generating pseudo-random 8-bit number
-uint8_t rand_seed;
-
-//////////////////////////////////////////////////////////////////////////////// J1939 Defines
-
-//PDU Format Defines
-#define J1939_PF_BROADCAST          254
-#define J1939_PF_REQUEST            234
-#define J1939_PF_ACK                232
-#define J1939_PF_PROPRIETARY_A      239
-#define J1939_PF_PROPRIETARY_B      255
-#define J1939_PF_REQUEST2           201
-#define J1939_PF_TRANSFER           202
-#define J1939_PF_PT_CM              236
-#define J1939_PF_PT_DT              235
-#define J1939_PF_ADDR_CLAIMED       238
-#define J1939_PF_ADDR_CANNOT_CLAIM  238
-
-//PDU Default Priorities Defines
-#define J1939_CONTROL_PRIORITY         3
-#define J1939_REQUEST_PRIORITY         6
-#define J1939_ACK_PRIORITY             6
-#define J1939_PROPRIETARY_A_PRIORITY   6
-#define J1939_PROPRIETARY_B_PRIORITY   6
-#define J1939_REQUEST2_PRIORITY        6
-#define J1939_TRANSFER_PRIORITY        6
-#define J1939_TP_CM_PRIORITY           7
-#define J1939_TP_DT_PRIORITY           7
-
-//Defines used with Transport Protocol Messages (refer to J1939-21 for spec)
-#define J1939_TP_CM_CTS          16
-#define J1939_TP_CM_DTS          17
-#define J1939_TP_CM_EOF          19
-#define J1939_TP_CM_ABORT        255
-#define J1939_TP_CM_BAM          32
-
-//J1939 Address Defines
-#define J1939_NULL_ADDRESS       254
-#define J1939_GLOBAL_ADDRESS     255
-
-//////////////////////////////////////////////////////////////////////////////// J1939 Baud Rate
-
-#ifndef J1939_BAUD_RATE
-#define J1939_BAUD_RATE 250000
-#endif
-
-#ifndef CAN_BRG_PRESCALAR
- #if USE_INTERNAL_CAN == TRUE
-  #if getenv("CLOCK") == 8000000
-   #if J1939_BAUD_RATE == 250000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   2
-     #define CAN_BRG_PHASE_SEGMENT_2   2
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #elif J1939_BAUD_RATE == 500000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   2
-     #define CAN_BRG_PHASE_SEGMENT_2   2
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #error Increase Clock Speed for 500000 Kb/s
-    #endif
-   #else
-    #error Please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width for J1939 Baud Rate and PIC Clock Speed
-   #endif
-  #elif getenv("CLOCK") == 16000000
-   #if J1939_BAUD_RATE == 250000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         1
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #elif J1939_BAUD_RATE == 500000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   2
-     #define CAN_BRG_PHASE_SEGMENT_2   2
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #else
-    #error Please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width for J1939 Baud Rate and PIC Clock Speed
-   #endif
-  #elif getenv("CLOCK") == 20000000
-   #if J1939_BAUD_RATE == 250000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         3
-     #define CAN_BRG_PHASE_SEGMENT_1   3
-     #define CAN_BRG_PHASE_SEGMENT_2   3
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         1
-     #define CAN_BRG_PHASE_SEGMENT_1   3
-     #define CAN_BRG_PHASE_SEGMENT_2   3
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #elif J1939_BAUD_RATE == 500000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         1
-     #define CAN_BRG_PHASE_SEGMENT_1   3
-     #define CAN_BRG_PHASE_SEGMENT_2   3
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   3
-     #define CAN_BRG_PHASE_SEGMENT_2   3
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #else
-    #error Please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width for J1939 Baud Rate and PIC Clock Speed
-   #endif
-  #elif getenv("CLOCK") == 32000000
-   #if J1939_BAUD_RATE == 250000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         3
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         1
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #elif J1939_BAUD_RATE == 500000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         1
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #else
-    #error Please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width for J1939 Baud Rate and PIC Clock Speed
-   #endif
-  #elif getenv("CLOCK") == 40000000
-   #if J1939_BAUD_RATE == 250000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         4
-     #define CAN_BRG_PHASE_SEGMENT_1   6
-     #define CAN_BRG_PHASE_SEGMENT_2   6
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         3
-     #define CAN_BRG_PHASE_SEGMENT_1   3
-     #define CAN_BRG_PHASE_SEGMENT_2   3
-     #define CAN_BRG_PROPAGATION_TIME  0
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #elif J1939_BAUD_RATE == 500000
-    #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
-        (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
-        (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
-     #define CAN_BRG_PRESCALAR         1
-     #define CAN_BRG_PHASE_SEGMENT_1   7
-     #define CAN_BRG_PHASE_SEGMENT_2   7
-     #define CAN_BRG_PROPAGATION_TIME  2
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #else
-     #define CAN_BRG_PRESCALAR         0
-     #define CAN_BRG_PHASE_SEGMENT_1   7
-     #define CAN_BRG_PHASE_SEGMENT_2   7
-     #define CAN_BRG_PROPAGATION_TIME  2
-     #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-    #endif
-   #else
-    #error Please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width for J1939 Baud Rate and PIC Clock Speed
-   #endif
-  #else
-   #error Please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width for J1939 Baud Rate and PIC Clock Speed
-  #endif
- #else
-  #if J1939_BAUD_RATE == 250000
-   #define CAN_BRG_PRESCALAR         3
-   #define CAN_BRG_PHASE_SEGMENT_1   3
-   #define CAN_BRG_PHASE_SEGMENT_2   3
-   #define CAN_BRG_PROPAGATION_TIME  0
-   #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-   #error/warning This assumes the External CAN chip is clocked with a 20MHz crystal
-  #elif J1939_BAUD_RATE == 500000
-   #define CAN_BRG_PRESCALAR         1
-   #define CAN_BRG_PHASE_SEGMENT_1   3
-   #define CAN_BRG_PHASE_SEGMENT_2   3
-   #define CAN_BRG_PROPAGATION_TIME  0
-   #define CAN_BRG_SYNCH_JUMP_WIDTH  0
-   #error/warning This assumes the External CAN chip is clocked with a 20MHz crystal
-  #else
-   #error Please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width for J1939 Baud Rate and PIC Clock Speed
-  #endif
- #endif
-#endif
-
-//////////////////////////////////////////////////////////////////////////////// Prototypes
-
-void J1939Init(void);
-#separate
-void J1939ReceiveTask(void);
-#separate
-void J1939XmitTask(void);
-int1 J1939Kbhit(void);
-int1 J1939GetMessage(J1939_PDU_STRUCT &PDU, uint8_t *Data, uint8_t &Length);
-int1 J1939PutMessage(J1939_PDU_STRUCT PDU, uint8_t *Data, uint8_t Bytes);
-void J1939RequestAddress(uint8_t address);
-void J1939ClaimAddress(void);
-int1 J1939CheckName(uint8_t *data);
-void J1939HandleAddressRequest(J1939_PDU_STRUCT PDU);
-void J1939LoadReceiveBuffer(J1939_PDU_STRUCT ReceivedPDU,uint8_t *Data,uint8_t length);
-void J1939HandleAddressClaim(J1939_PDU_STRUCT ReceivedPDU, uint8_t *Name);
-void J1939SetCANFilter(uint8_t address);
-uint8_t xor8(void);
-
-#endif
+////////////////////////////////////////////////////////////////////////////////
+////                                J1939.h                                 ////
+////                                                                        ////
+//// Prototypes, defines and global variable used with the J1939 Driver.    ////
+////                                                                        ////
+////////////////////////////////////////////////////////////////////////////////
+////        (C) Copyright 1996,2012 Custom Computer Services                ////
+//// This source code may only be used by licensed users of the CCS         ////
+//// C compiler.  This source code may only be distributed to other         ////
+//// licensed users of the CCS C compiler.  No other use,                   ////
+//// reproduction or distribution is permitted without written              ////
+//// permission.  Derivative programs created using this software           ////
+//// in object code form are not restricted in any way.                     ////
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _J1939_H
+#define _J1939_H
+
+#include <stdint.h>
+
+//Set to TRUE to build with GCC or Clang on a PC using can-host.c, the
+//application must include can-host.h first
+#ifndef USE_HOST_CAN
+#define USE_HOST_CAN FALSE
+#endif
+
+#if USE_HOST_CAN == TRUE
+ #undef USE_INTERNAL_CAN
+ #define USE_INTERNAL_CAN FALSE
+#endif
+
+#ifndef USE_INTERNAL_CAN
+#define USE_INTERNAL_CAN TRUE
+#endif
+
+#ifndef J1939_RECEIVE_BUFFERS
+#define J1939_RECEIVE_BUFFERS    16
+#endif
+
+#if J1939_RECEIVE_BUFFERS < 2
+#undef J1939_RECEIVE_BUFFERS
+#define J1939_RECEIVE_BUFFERS    2  //required to be able to receive one RTS/CTS session and one BAM session at same time
+#endif
+
+#ifndef J1939_TRANSMIT_BUFFERS
+#define J1939_TRANSMIT_BUFFERS   2
+#endif
+
+#if J1939_TRANSMIT_BUFFERS == 0
+#undef J1939_TRANSMIT_BUFFERS
+#define J1939_TRANSMIT_BUFFERS   1
+#endif
+
+//Number of application messages held while unit is claiming its address, they
+//are transmitted as soon as the address is claimed.  Set to 0 to discard
+//application messages loaded before the address is claimed.
+#ifndef J1939_STAGED_BUFFERS
+#define J1939_STAGED_BUFFERS     2
+#endif
+
+//Number of ticks to wait for a contending Address Claim before unit's address
+//is claimed, can be changed at run time with J1939SetClaimPolicy()
+#ifndef J1939_CLAIM_CONTENTION_TICKS
+#define J1939_CLAIM_CONTENTION_TICKS   ((J1939_TICK_TYPE)J1939_TICKS_PER_SECOND/4)
+#endif
+
+//Set to FALSE to ignore Commanded Address messages (PGN 65240) sent by service
+//tools to change unit's address
+#ifndef J1939_USE_COMMANDED_ADDRESS
+#define J1939_USE_COMMANDED_ADDRESS TRUE
+#endif
+
+//When TRUE mask 0 is opened so receive buffer 0 takes messages to every
+//destination, and J1939ReceiveTask() drops destination specific messages that
+//aren't to unit's address or the global address.  Moving to a new address
+//doesn't touch the CAN module, which can only have its filters written in
+//Config mode where it stops receiving.  The cost is that every PDU1 message on
+//the bus, to any address, raises a receive interrupt and is read and dropped
+//in software, which adds CPU load and makes receive buffer 0 more likely to
+//overflow on a busy bus.  Default FALSE rewrites filter 1 in Config mode
+//instead, only set TRUE where losing messages during an address change
+//matters more than the extra load.
+#ifndef J1939_HITLESS_FILTER
+#define J1939_HITLESS_FILTER  FALSE
+#endif
+
+#if J1939_HITLESS_FILTER == TRUE
+ #define J1939_ADDRESS_MASK    0x00000000    //Mask 0 for filters 0 and 1, buffer 0 takes every message
+#else
+ #define J1939_ADDRESS_MASK    0x0000FF00    //Mask 0 for filters 0 and 1, looks at Destination Address
+#endif
+
+//PIC18 internal CAN only, when TRUE received and transmitted messages are
+//moved between the ECAN ID registers and J1939_PDU_STRUCT directly with
+//can_getd_raw() and can_putd_raw(), instead of going through a 32-bit ID.
+#ifndef J1939_USE_ID_REGISTERS
+ #if (USE_INTERNAL_CAN == TRUE) && !defined(__PCD__)
+  #define J1939_USE_ID_REGISTERS   TRUE
+ #else
+  #define J1939_USE_ID_REGISTERS   FALSE
+ #endif
+#endif
+
+//Set to TRUE to watch the CAN error state and recover from bus off, needs
+//J1939CanBusOff(), J1939CanErrorPassive() and J1939CanErrorWarning() defined
+//for the CAN module used (defined below for the PIC18 internal CAN)
+#ifndef J1939_USE_ERROR_SUPERVISOR
+ #if (USE_INTERNAL_CAN == TRUE) && !defined(__PCD__)
+  #define J1939_USE_ERROR_SUPERVISOR  TRUE
+ #else
+  #define J1939_USE_ERROR_SUPERVISOR  FALSE
+ #endif
+#endif
+
+//Set to TRUE if the application calls J1939ErrorISR() from its CAN error
+//interrupt, J1939ErrorTask() then only reads the error state after an error
+//interrupt instead of every time it's called
+#ifndef J1939_USE_ERROR_INTERRUPT
+#define J1939_USE_ERROR_INTERRUPT   FALSE
+#endif
+
+//Ticks to wait after a bus off before transmitting again, doubles with each
+//bus off up to J1939_BUS_OFF_BACKOFF_MAX_TICKS and goes back to the start
+//value once the bus has been error active for J1939_BUS_OFF_BACKOFF_MAX_TICKS
+#ifndef J1939_BUS_OFF_BACKOFF_TICKS
+#define J1939_BUS_OFF_BACKOFF_TICKS       ((J1939_TICK_TYPE)J1939_TICKS_PER_SECOND/10)
+#endif
+
+#ifndef J1939_BUS_OFF_BACKOFF_MAX_TICKS
+#define J1939_BUS_OFF_BACKOFF_MAX_TICKS   ((J1939_TICK_TYPE)J1939_TICKS_PER_SECOND*5)
+#endif
+
+//What is done with the Transmit buffer on bus off, J1939_BUS_OFF_FLUSH
+//discards the messages waiting to be sent, J1939_BUS_OFF_HOLD sends them
+//after recovery
+#define J1939_BUS_OFF_FLUSH   0
+#define J1939_BUS_OFF_HOLD    1
+
+#ifndef J1939_BUS_OFF_POLICY
+#define J1939_BUS_OFF_POLICY  J1939_BUS_OFF_FLUSH
+#endif
+
+#if (J1939_USE_ERROR_SUPERVISOR == TRUE) && (USE_INTERNAL_CAN == TRUE) && !defined(__PCD__)
+ #ifndef J1939CanBusOff
+ #define J1939CanBusOff()          (COMSTAT.txbo)
+ #endif
+ #ifndef J1939CanErrorPassive
+ #define J1939CanErrorPassive()    (COMSTAT.txbp || COMSTAT.rxbp)
+ #endif
+ #ifndef J1939CanErrorWarning
+ #define J1939CanErrorWarning()    (COMSTAT.ewarn)
+ #endif
+#endif
+
+//PIC18 internal CAN only, set to TRUE to stamp each received message with the
+//time of its Start Of Frame, captured by CCP1 from the CAN module, in
+//microseconds counted by Timer1 and extended to 32 bits.  Uses Timer1, CCP1 and
+//the CAN receive interrupts, so global interrupts must be enabled.
+#ifndef J1939_USE_RX_TIMESTAMP
+#define J1939_USE_RX_TIMESTAMP   FALSE
+#endif
+
+#if J1939_USE_RX_TIMESTAMP == TRUE
+ #if (USE_INTERNAL_CAN != TRUE) || defined(__PCD__)
+  #error J1939_USE_RX_TIMESTAMP requires the PIC18 internal CAN
+ #endif
+ 
+ #undef CAN_ENABLE_CAN_CAPTURE
+ #define CAN_ENABLE_CAN_CAPTURE   1     //CAN Start Of Frame triggers CCP1 capture
+ 
+ //Timer1 prescaler giving 1us per count
+ #ifndef J1939_TIMESTAMP_T1_DIV
+  #if getenv("CLOCK") == 4000000
+   #define J1939_TIMESTAMP_T1_DIV   T1_DIV_BY_1
+  #elif getenv("CLOCK") == 8000000
+   #define J1939_TIMESTAMP_T1_DIV   T1_DIV_BY_2
+  #elif getenv("CLOCK") == 16000000
+   #define J1939_TIMESTAMP_T1_DIV   T1_DIV_BY_4
+  #elif getenv("CLOCK") == 32000000
+   #define J1939_TIMESTAMP_T1_DIV   T1_DIV_BY_8
+  #else
+   #error Please define J1939_TIMESTAMP_T1_DIV for a 1us Timer1 count at this Clock Speed
+  #endif
+ #endif
+#endif
+
+//PIC18 internal CAN, or the host CAN driver with a backend that has set_baud
+//and rx_invalid like j1939-sim's, set to TRUE to find the bus baud rate at
+//start up.  J1939Init() tries 250K, 500K, 125K and 1000K in listen only mode
+//and uses the first one that receives J1939_AUTO_BAUD_FRAMES valid frames
+//before an invalid frame or J1939_AUTO_BAUD_TICKS go by.  After
+//J1939_AUTO_BAUD_CYCLES times through the list the baud rate set by
+//can_set_baud() is used.  The BRGCON values for each rate are worked out from
+//the clock like J1939_BAUD_RATE's.  On a quiet bus J1939Init() blocks for
+//J1939_AUTO_BAUD_CYCLES * 4 * J1939_AUTO_BAUD_TICKS before giving up, 8
+//seconds with the defaults, so lower them if the watchdog or the application
+//can't wait that long.
+#ifndef J1939_USE_AUTO_BAUD
+#define J1939_USE_AUTO_BAUD   FALSE
+#endif
+
+#if J1939_USE_AUTO_BAUD == TRUE
+ #if ((USE_INTERNAL_CAN != TRUE) || defined(__PCD__)) && (USE_HOST_CAN != TRUE)
+  #error J1939_USE_AUTO_BAUD requires the PIC18 internal CAN or the host CAN driver
+ #endif
+ 
+ #undef CAN_INIT_OP_MODE
+ #define CAN_INIT_OP_MODE   CAN_OP_LISTEN   //don't go on the bus until the baud rate is known
+ 
+ #ifndef J1939_AUTO_BAUD_TICKS
+ #define J1939_AUTO_BAUD_TICKS    ((J1939_TICK_TYPE)J1939_TICKS_PER_SECOND/2)
+ #endif
+ 
+ #ifndef J1939_AUTO_BAUD_FRAMES
+ #define J1939_AUTO_BAUD_FRAMES   2
+ #endif
+ 
+ #ifndef J1939_AUTO_BAUD_CYCLES
+ #define J1939_AUTO_BAUD_CYCLES   4
+ #endif
+#endif
+
+//Set to TRUE to profile the driver.  Each probe keeps the number of times it
+//ran and the least, most and total counts of J1939ProfileTimer() it took, in
+//g_J1939Profile[].  On the PIC18 and PCD chips the timer is Timer3 counting
+//instruction cycles, so a stage taking more than 65535 cycles wraps.  Probes
+//0 to 6 are used by the driver and EX_J1939, J1939_PROFILE_USER and up are
+//free for the application.
+#ifndef J1939_USE_PROFILER
+#define J1939_USE_PROFILER    FALSE
+#endif
+
+#if J1939_USE_PROFILER == TRUE
+ #ifndef J1939_PROFILE_PROBES
+ #define J1939_PROFILE_PROBES  8
+ #endif
+ 
+ #ifndef J1939ProfileTimer
+  #if defined(__PCD__)
+   #define J1939ProfileTimer()         get_timer3()
+   #define J1939ProfileTimerSetup()    setup_timer3(TMR_INTERNAL | TMR_DIV_BY_1, 0xFFFF)
+  #elif defined(__PCH__)
+   #define J1939ProfileTimer()         get_timer3()
+   #define J1939ProfileTimerSetup()    setup_timer_3(T3_INTERNAL | T3_DIV_BY_1)
+  #else
+   #error Please define J1939ProfileTimer() and J1939ProfileTimerSetup() for a free running 16-bit timer
+  #endif
+ #endif
+ 
+ //CAN driver hooks, run at the start and end of can_getd() and can_putd()
+ #define can_profile_start(probe)   J1939ProfileStart(J1939_PROFILE_CAN_GETD + (probe))
+ #define can_profile_stop(probe)    J1939ProfileStop(J1939_PROFILE_CAN_GETD + (probe))
+#endif
+
+//Set to TRUE to check the receive, transmit and staged buffer indexes and
+//counts at the end of J1939ReceiveTask() and J1939XmitTask().  A failed check
+//calls J1939CheckFailed(line), which by default counts it in
+//g_J1939CheckFailures and keeps the line in g_J1939CheckLine.  Define
+//J1939CheckFailed() before including j1939.c to stop or reset instead.
+#ifndef J1939_USE_CHECKS
+#define J1939_USE_CHECKS      FALSE
+#endif
+
+//Number of other units whose J1939 Name and Address are kept in the address
+//map, set to 0 to remove the address map.  Can be set up to 254.
+#ifndef J1939_ADDRESS_MAP_ENTRIES
+#define J1939_ADDRESS_MAP_ENTRIES   16
+#endif
+
+#if J1939_ADDRESS_MAP_ENTRIES > 254
+#undef J1939_ADDRESS_MAP_ENTRIES
+#define J1939_ADDRESS_MAP_ENTRIES   254
+#endif
+
+//Number of hash buckets used to look up the address map by J1939 Name and by
+//Function, must be a power of 2.
+#ifndef J1939_ADDRESS_MAP_HASH_SIZE
+#define J1939_ADDRESS_MAP_HASH_SIZE 16
+#endif
+
+////////////////////////////////////////////////////////////////////////////////  Global variables
+
+//J1939 Name packed into two 32-bit words so Names can be compared a word at a
+//time, most significant word first.  High holds Name bits 63-32 (bytes 7-4)
+//and Low holds Name bits 31-0 (bytes 3-0), a lower value has higher priority.
+typedef struct _J1939_NAME {
+   uint32_t Low;                 //Manufacturer Code and Identity Number
+   uint32_t High;                //Arbitrary Address Capable, Industry Group, Vehicle System, Function, ECU and Function Instance
+} J1939_NAME;
+
+//J1939 Name fields, used with J1939BuildName() (refer to J1939-81 for spec)
+typedef struct _J1939_NAME_FIELDS {
+   uint32_t IdentityNumber;         //21 bits
+   uint16_t ManufacturerCode;       //11 bits
+   uint8_t  EcuInstance;            //3 bits
+   uint8_t  FunctionInstance;       //5 bits
+   uint8_t  Function;               //8 bits
+   uint8_t  VehicleSystem;          //7 bits
+   uint8_t  VehicleSystemInstance;  //4 bits
+   uint8_t  IndustryGroup;          //3 bits
+   int1     ArbitraryAddressCapable;
+} J1939_NAME_FIELDS;
+
+//global variables containing unit's J1939 Address and Name, g_J1939Name is
+//in the byte order it's transmitted and g_J1939PackedName is the same Name
+//packed for arbitration
+uint8_t g_MyJ1939Address;
+uint8_t g_J1939Name[8];
+J1939_NAME g_J1939PackedName;
+
+//global J1939 tick variables
+
+J1939_TICK_TYPE g_J1939CurrentClaimTick, g_J1939PreviousClaimTick;
+J1939_TICK_TYPE g_J1939PreviousCannotClaimTick;
+J1939_TICK_TYPE g_J1939CannotClaimDelay;
+
+//J1939 PDU Structure
+typedef struct _J1939_PDU_STRUCT {
+   uint8_t SourceAddress;
+   uint8_t DestinationAddress;   //Also Group Extension for PDU2 messages
+   uint8_t PDUFormat;
+   int1    DataPage;
+   int1    ExtendedDataPage;     //Set to 0 for J1939
+   uint8_t Priority:3;
+   uint8_t unused7_5:3;          //unused bits don't do anything with them
+} J1939_PDU_STRUCT;
+
+//J1939 Message Structure
+typedef struct _J1939_MESSAGE_STRUCT {
+   J1939_PDU_STRUCT PDU;
+   uint8_t Length;
+   uint8_t Data[8];
+} J1939_MESSAGE_STRUCT;
+
+//global J1939 Receive and Transmit buffers
+J1939_MESSAGE_STRUCT g_J1939ReceiveBuffer[J1939_RECEIVE_BUFFERS];
+J1939_MESSAGE_STRUCT g_J1939XmitBuffer[J1939_TRANSMIT_BUFFERS];
+
+//global J1939 variable for indexing J1939 Receive and Transmit buffers
+static uint8_t g_J1939ReceiveNextIn;
+static uint8_t g_J1939ReceiveNextOut;
+static uint8_t g_J1939XmitNextIn;
+static uint8_t g_J1939XmitNextOut;
+
+#if J1939_USE_RX_TIMESTAMP == TRUE
+//global J1939 timestamp variables, Timer1 overflow count, time of last captured
+//Start Of Frame, time stamped on each CAN receive buffer when it filled
+//(g_J1939BufferStamped has a bit set for each buffer stamped), time of message
+//being received, Start Of Frame time of each message in the J1939 Receive buffer
+//(kept apart so the Transmit and Staged buffers don't carry it) and time of last
+//message returned by J1939GetMessage()
+uint16_t g_J1939TimestampHigh;
+uint32_t g_J1939LastSOF;
+uint32_t g_J1939BufferTimestamp[8];
+uint8_t g_J1939BufferStamped;
+uint32_t g_J1939ReceivedTimestamp;
+uint32_t g_J1939ReceiveTimestamp[J1939_RECEIVE_BUFFERS];
+uint32_t g_J1939MessageTimestamp;
+
+//Returns Start Of Frame time in microseconds of the last message returned by J1939GetMessage()
+#define J1939GetTimestamp()   (g_J1939MessageTimestamp)
+#endif
+
+#if J1939_STAGED_BUFFERS > 0
+//global J1939 buffer holding application messages until address is claimed
+J1939_MESSAGE_STRUCT g_J1939StagedBuffer[J1939_STAGED_BUFFERS];
+static uint8_t g_J1939StagedNextIn;
+static uint8_t g_J1939StagedNextOut;
+#endif
+
+//Immediate Claim Defines, used with J1939SetClaimPolicy()
+#define J1939_IMMEDIATE_CLAIM_NEVER    0     //always wait the contention window
+#define J1939_IMMEDIATE_CLAIM_FIXED    1     //units that aren't Arbitrary Address Capable don't wait for addresses 0 to 127 and 248 to 253 (J1939-81)
+#define J1939_IMMEDIATE_CLAIM_ALWAYS   2     //never wait, only use on networks where no other unit can contend
+
+//global J1939 Address Claim policy, see J1939SetClaimPolicy()
+J1939_TICK_TYPE g_J1939ClaimContentionTicks;
+uint8_t g_J1939ImmediateClaim;
+
+//global J1939 CAN filter statistics, number of times filter 1 was changed,
+//the time spent in Config mode doing it is the J1939_PROFILE_FILTER_CONFIG probe
+uint16_t g_J1939FilterChanges;
+
+#if J1939_USE_PROFILER == TRUE
+//Profile probes
+#define J1939_PROFILE_RECEIVE_TASK  0     //J1939ReceiveTask()
+#define J1939_PROFILE_XMIT_TASK     1     //J1939XmitTask()
+#define J1939_PROFILE_CAN_GETD      2     //can_getd() and can_getd_raw(), includes calls finding no message
+#define J1939_PROFILE_CAN_PUTD      3     //can_putd() and can_putd_raw()
+#define J1939_PROFILE_DECODE        4     //application decode, SpnDecodePGN() and lecturaDelParametro() in EX_J1939
+#define J1939_PROFILE_FILTER_CONFIG 5     //J1939SetCANFilter() Config mode window, CAN module not receiving
+#define J1939_PROFILE_ID            6     //CAN ID or ID registers to and from J1939_PDU_STRUCT, both directions
+#define J1939_PROFILE_USER          7     //first probe free for the application
+
+typedef struct _J1939_PROFILE_STRUCT {
+   uint16_t Start;               //timer at J1939ProfileStart()
+   uint16_t Min;
+   uint16_t Max;
+   uint32_t Sum;
+   uint32_t Count;
+} J1939_PROFILE_STRUCT;
+
+//global J1939 profile table, and timer counts taken by an empty
+//J1939ProfileStart()/J1939ProfileStop() pair, subtracted from each measurement
+J1939_PROFILE_STRUCT g_J1939Profile[J1939_PROFILE_PROBES];
+uint16_t g_J1939ProfileOverhead;
+
+#define J1939ProfileStart(probe)    g_J1939Profile[probe].Start = J1939ProfileTimer()
+#define J1939ProfileStop(probe)     J1939ProfileUpdate(probe, J1939ProfileTimer())
+#else
+#define J1939ProfileStart(probe)
+#define J1939ProfileStop(probe)
+#endif
+
+#if J1939_USE_CHECKS == TRUE
+//global J1939 check results, number of failed checks and line of the last one
+uint16_t g_J1939CheckFailures;
+uint16_t g_J1939CheckLine;
+
+#ifndef J1939CheckFailed
+#define J1939CheckFailed(line)      {g_J1939CheckFailures++; g_J1939CheckLine = (line);}
+#endif
+
+#define J1939Check(condition)       do{ if(!(condition)) J1939CheckFailed(__LINE__); }while(0)
+#endif
+
+//global J1939 receive statistics, messages lost because the CAN receive
+//buffers overflowed and messages thrown away because the J1939 Receive buffer
+//was full
+uint16_t g_J1939ReceiveOverflows;
+uint16_t g_J1939ReceiveDropped;
+
+#if J1939_HITLESS_FILTER == TRUE
+//address J1939ReceiveTask() passes destination specific messages for, in place
+//of filter 1
+uint8_t g_J1939FilterAddress;
+#endif
+
+#if J1939_USE_ERROR_SUPERVISOR == TRUE
+//CAN Error State Defines, index into g_J1939ErrorStateCount[]
+#define J1939_ERROR_ACTIVE    0
+#define J1939_ERROR_WARNING   1
+#define J1939_ERROR_PASSIVE   2
+#define J1939_ERROR_BUS_OFF   3
+
+//global J1939 CAN error state, number of times each state was entered and
+//bus off back off
+uint8_t g_J1939ErrorState;
+uint16_t g_J1939ErrorStateCount[4];
+J1939_TICK_TYPE g_J1939BusOffTick;
+J1939_TICK_TYPE g_J1939BusOffBackoff;
+J1939_TICK_TYPE g_J1939ErrorActiveTick;
+
+#if J1939_USE_ERROR_INTERRUPT == TRUE
+int1 g_J1939ErrorEvent;             //set by J1939ErrorISR()
+#endif
+#endif
+
+#if J1939_USE_AUTO_BAUD == TRUE
+//baud rate found by J1939AutoBaud(), 0xFF if none was found, and the ticks it
+//took to find it
+uint8_t g_J1939AutoBaudRate;
+J1939_TICK_TYPE g_J1939AutoBaudTicks;
+#endif
+
+//J1939 Flag structure
+typedef struct _J1939_FLAGS_STRUCT {
+   int1    AddressClaimed;       //Unit Successfully claimed an address
+   int1    AddressClaimSent;     //Unit has sent a claim request
+   int1    AddressNewClaim;      //Used to specify if claim request is for a new address
+   int1    AddressCannotClaim;   //If not arbitrary address capable, is set if unit can't claim address
+   int1    BusOffRecovery;       //Unit went bus off and is waiting to transmit again
+   uint8_t unused5_1:3;
+   uint8_t ReceiveBufferCount;   //Keep track of number of stored messages in receive buffer
+   uint8_t XmitBufferCount;      //Keep track of number of messages that still need transmitted
+   uint8_t StagedBufferCount;    //Keep track of number of messages waiting for address to be claimed
+} J1939_FLAGS_STRUCT;
+
+//global J1939 Flag structure variable
+J1939_FLAGS_STRUCT g_J1939Flags;
+
+//global variables used in generating pseudo-random 8-bit number, seeded from
+//unit's J1939 Identity Number and tick so units built the same don't generate
+//the same numbers
+uint8_t rand_seed;
+uint8_t rand_y;
+uint8_t rand_z;
+uint8_t rand_w;
+
+//Optional list of addresses tried, in order, before a random address when
+//unit is Arbitrary Address Capable and loses its address, for example
+//#define J1939_PREFERRED_ADDRESSES 130,131,132
+#ifdef J1939_PREFERRED_ADDRESSES
+const uint8_t g_J1939PreferredAddresses[] = {J1939_PREFERRED_ADDRESSES};
+uint8_t g_J1939PreferredIndex;
+#endif
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Defines
+
+//PDU Format Defines
+#define J1939_PF_BROADCAST          254
+#define J1939_PF_REQUEST            234
+#define J1939_PF_ACK                232
+#define J1939_PF_PROPRIETARY_A      239
+#define J1939_PF_PROPRIETARY_B      255
+#define J1939_PF_REQUEST2           201
+#define J1939_PF_TRANSFER           202
+#define J1939_PF_PT_CM              236
+#define J1939_PF_PT_DT              235
+#define J1939_PF_ADDR_CLAIMED       238
+#define J1939_PF_ADDR_CANNOT_CLAIM  238
+#define J1939_PF_PDU2               240   //PDU Formats 240 to 255 are PDU2, broadcast with Group Extension
+
+//PDU Default Priorities Defines
+#define J1939_CONTROL_PRIORITY         3
+#define J1939_REQUEST_PRIORITY         6
+#define J1939_ACK_PRIORITY             6
+#define J1939_PROPRIETARY_A_PRIORITY   6
+#define J1939_PROPRIETARY_B_PRIORITY   6
+#define J1939_REQUEST2_PRIORITY        6
+#define J1939_TRANSFER_PRIORITY        6
+#define J1939_TP_CM_PRIORITY           7
+#define J1939_TP_DT_PRIORITY           7
+
+//Defines used with Transport Protocol Messages (refer to J1939-21 for spec)
+#define J1939_TP_CM_CTS          16
+#define J1939_TP_CM_DTS          17
+#define J1939_TP_CM_EOF          19
+#define J1939_TP_CM_ABORT        255
+#define J1939_TP_CM_BAM          32
+#define J1939_TP_TIMEOUT_T1      ((J1939_TICK_TYPE)J1939_TICKS_PER_SECOND*3/4)   //max time between BAM data packets
+
+//Defines used with Commanded Address Message (refer to J1939-81 for spec)
+#define J1939_PS_COMMANDED_ADDRESS        216   //PGN 65240, PDU Format is J1939_PF_BROADCAST
+#define J1939_COMMANDED_ADDRESS_SIZE      9     //J1939 Name and new address
+#define J1939_COMMANDED_ADDRESS_PACKETS   2
+
+//J1939 Address Defines
+#define J1939_NULL_ADDRESS       254
+#define J1939_GLOBAL_ADDRESS     255
+#define J1939_ARBITRARY_ADDRESS_FIRST  128   //range of addresses used by Arbitrary Address Capable units
+#define J1939_ARBITRARY_ADDRESS_LAST   247
+
+//J1939 Name Defines, Name is pointer to 8 byte J1939 Name
+#define J1939NameArbitraryAddressCapable(Name)  ((Name[7] & 0x80) != 0)
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Commanded Address
+
+#if J1939_USE_COMMANDED_ADDRESS == TRUE
+
+//Commanded Address BAM session, only one session is tracked at a time
+typedef struct _J1939_COMMANDED_ADDRESS_STRUCT {
+   uint8_t SourceAddress;        //address of unit sending the BAM
+   uint8_t NextPacket;           //sequence number of next data packet, 0 if no session
+   J1939_TICK_TYPE Tick;         //tick last packet was received
+   uint8_t Data[J1939_COMMANDED_ADDRESS_PACKETS * 7];
+} J1939_COMMANDED_ADDRESS_STRUCT;
+
+J1939_COMMANDED_ADDRESS_STRUCT g_J1939CommandedAddress;
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Address Map
+
+#if J1939_ADDRESS_MAP_ENTRIES > 0
+
+#define J1939_ADDRESS_MAP_NONE   255
+
+//J1939 Address Map entry, one for each other unit that has claimed an address
+typedef struct _J1939_ADDRESS_MAP_ENTRY {
+   J1939_NAME Name;              //J1939 Name of unit
+   uint8_t Address;              //Address claimed by unit, J1939_NULL_ADDRESS if entry is free
+   uint8_t NextHash;             //Next entry in same hash bucket, J1939_ADDRESS_MAP_NONE if last
+   uint8_t NextFunction;         //Next entry in same Function hash bucket, J1939_ADDRESS_MAP_NONE if last
+} J1939_ADDRESS_MAP_ENTRY;
+
+//Function (byte 5 of J1939 Name) of a packed Name, and its hash bucket
+#define J1939_NAME_FUNCTION(Name)   ((uint8_t)((Name).High >> 8))
+#define J1939_FUNCTION_HASH(Name)   (J1939_NAME_FUNCTION(Name) & (J1939_ADDRESS_MAP_HASH_SIZE - 1))
+
+//global J1939 Address Map, g_J1939AddressIndex is indexed by Source Address,
+//g_J1939NameHash by hash of J1939 Name and g_J1939FunctionHash by Function, all
+//hold an index into g_J1939AddressMap or J1939_ADDRESS_MAP_NONE
+J1939_ADDRESS_MAP_ENTRY g_J1939AddressMap[J1939_ADDRESS_MAP_ENTRIES];
+uint8_t g_J1939AddressIndex[J1939_NULL_ADDRESS];
+uint8_t g_J1939NameHash[J1939_ADDRESS_MAP_HASH_SIZE];
+uint8_t g_J1939FunctionHash[J1939_ADDRESS_MAP_HASH_SIZE];
+#endif
+
+//////////////////////////////////////////////////////////////////////////////// J1939 Baud Rate
+
+#ifndef J1939_BAUD_RATE
+#define J1939_BAUD_RATE 250000
+#endif
+
+//Clock feeding the CAN baud rate generator, Tq = 2 * (CAN_BRG_PRESCALAR + 1) / J1939_CAN_CLOCK
+#ifndef J1939_CAN_CLOCK
+ #if USE_INTERNAL_CAN == TRUE
+  #if defined(__PCH__) || (getenv("DEVICE") == "DSPIC30F6010A") || (getenv("DEVICE") == "DSPIC30F6011A") || (getenv("DEVICE") == "DSPIC30F6012A") || (getenv("DEVICE") == "DSPIC30F6013A") || (getenv("DEVICE") == "DSPIC30F6014A") || (getenv("DEVICE") == "DSPIC30F6015") || \
+      (getenv("DEVICE") == "DSPIC30F5011") || (getenv("DEVICE") == "DSPIC30F5013") || (getenv("DEVICE") == "DSPIC30F5015") || (getenv("DEVICE") == "DSPIC30F5016") || \
+      (getenv("DEVICE") == "DSPIC30F4011") || (getenv("DEVICE") == "DSPIC30F4012") || (getenv("DEVICE") == "DSPIC30F4013")
+   #define J1939_CAN_CLOCK   getenv("CLOCK")
+  #else //PIC24 and dsPIC33
+   #define J1939_CAN_CLOCK   (getenv("CLOCK")/2)
+  #endif
+ #elif USE_HOST_CAN == TRUE
+  #define J1939_CAN_CLOCK    16000000   //not used, SocketCAN baud rate is set with ip link
+ #else
+  #define J1939_CAN_CLOCK    20000000
+  #error/warning "This assumes the External CAN chip is clocked with a 20MHz crystal, define J1939_CAN_CLOCK if it isn't"
+ #endif
+#endif
+
+//Baud rate error allowed, in 0.01% (J1939-11 allows 0.5%)
+#ifndef J1939_BAUD_TOLERANCE
+#define J1939_BAUD_TOLERANCE  50
+#endif
+
+//Bit timing for a baud rate at J1939_CAN_CLOCK.  The number of Tq in a bit is
+//the first of the list below that divides the clock into the baud rate
+//exactly, the list is in order of how close the sample point comes to the
+//87.5% J1939 recommends (16 Tq is exactly 87.5%).  If none divides exactly
+//16 Tq is used with the nearest prescaler.  Phase Segment 2 is 1/8 of the bit
+//(2 Tq min), the rest after the Sync Segment is split between Propagation
+//Time and Phase Segment 1.  The _FOR() macros work it out for any baud rate,
+//so the PIC18 auto baud table comes from the same place as J1939_BAUD_RATE.
+//J1939_BIT_ACTUAL_BAUD_RATE is the baud rate J1939_BAUD_RATE ends up at and
+//J1939_BIT_BAUD_ERROR its error in 0.01%.
+#define J1939_BIT_DIVIDES(tq, baud)    (((J1939_CAN_CLOCK % (2 * (tq) * (baud))) == 0) && (J1939_CAN_CLOCK / (2 * (tq) * (baud)) >= 1) && (J1939_CAN_CLOCK / (2 * (tq) * (baud)) <= 64))
+
+#define J1939_BIT_TQ_FOR(baud)   (J1939_BIT_DIVIDES(16, baud) ? 16 : J1939_BIT_DIVIDES(17, baud) ? 17 : J1939_BIT_DIVIDES(15, baud) ? 15 : \
+                                  J1939_BIT_DIVIDES(18, baud) ? 18 : J1939_BIT_DIVIDES(14, baud) ? 14 : J1939_BIT_DIVIDES(19, baud) ? 19 : \
+                                  J1939_BIT_DIVIDES(20, baud) ? 20 : J1939_BIT_DIVIDES(13, baud) ? 13 : J1939_BIT_DIVIDES(12, baud) ? 12 : \
+                                  J1939_BIT_DIVIDES(11, baud) ? 11 : J1939_BIT_DIVIDES(10, baud) ? 10 : J1939_BIT_DIVIDES(9, baud) ? 9 : \
+                                  J1939_BIT_DIVIDES(8, baud) ? 8 : 16)
+
+//Tq counts of the bit, Sync Segment is always 1 Tq
+#define J1939_BIT_PRESCALE_FOR(baud)     ((J1939_CAN_CLOCK + J1939_BIT_TQ_FOR(baud) * (baud)) / (2 * J1939_BIT_TQ_FOR(baud) * (baud)))
+#define J1939_BIT_PHASE_2_FOR(baud)      ((J1939_BIT_TQ_FOR(baud) < 12) ? 2 : ((J1939_BIT_TQ_FOR(baud) + 4) / 8))
+#define J1939_BIT_PHASE_1_FOR(baud)      ((J1939_BIT_TQ_FOR(baud) - 1 - J1939_BIT_PHASE_2_FOR(baud) + 1) / 2)
+#define J1939_BIT_PROPAGATION_FOR(baud)  (J1939_BIT_TQ_FOR(baud) - 1 - J1939_BIT_PHASE_2_FOR(baud) - J1939_BIT_PHASE_1_FOR(baud))
+#define J1939_BIT_ACTUAL_FOR(baud)       ((J1939_BIT_PRESCALE_FOR(baud) < 1) ? 0 : J1939_CAN_CLOCK / (2 * J1939_BIT_PRESCALE_FOR(baud) * J1939_BIT_TQ_FOR(baud)))
+
+//baud rate is off by more than J1939_BAUD_TOLERANCE or the prescaler is out of range
+#define J1939_BIT_BAD_FOR(baud)  ((J1939_BIT_PRESCALE_FOR(baud) < 1) || (J1939_BIT_PRESCALE_FOR(baud) > 64) || \
+                                  ((J1939_BIT_ACTUAL_FOR(baud) > (baud)) && ((J1939_BIT_ACTUAL_FOR(baud) - (baud)) * 100 > (baud) / 100 * J1939_BAUD_TOLERANCE)) || \
+                                  ((J1939_BIT_ACTUAL_FOR(baud) < (baud)) && (((baud) - J1939_BIT_ACTUAL_FOR(baud)) * 100 > (baud) / 100 * J1939_BAUD_TOLERANCE)))
+
+#define J1939_BIT_TQ          J1939_BIT_TQ_FOR(J1939_BAUD_RATE)
+#define J1939_BIT_PRESCALE    J1939_BIT_PRESCALE_FOR(J1939_BAUD_RATE)
+#define J1939_BIT_PHASE_2     J1939_BIT_PHASE_2_FOR(J1939_BAUD_RATE)
+#define J1939_BIT_PHASE_1     J1939_BIT_PHASE_1_FOR(J1939_BAUD_RATE)
+#define J1939_BIT_PROPAGATION J1939_BIT_PROPAGATION_FOR(J1939_BAUD_RATE)
+
+#define J1939_BIT_ACTUAL_BAUD_RATE  J1939_BIT_ACTUAL_FOR(J1939_BAUD_RATE)
+#define J1939_BIT_BAUD_ERROR        (((signed int32)J1939_BIT_ACTUAL_BAUD_RATE - (signed int32)J1939_BAUD_RATE) * 10000 / (signed int32)J1939_BAUD_RATE)
+
+#if (J1939_BIT_PRESCALE < 1) || (J1939_BIT_PRESCALE > 64)
+ #error "Clock Speed can't make J1939 Baud Rate, please define BRG Prescalar, Phase Segments, Propagation Time and Synch Jump Width"
+#elif (J1939_BIT_ACTUAL_BAUD_RATE > J1939_BAUD_RATE) && ((J1939_BIT_ACTUAL_BAUD_RATE - J1939_BAUD_RATE) * 100 > J1939_BAUD_RATE / 100 * J1939_BAUD_TOLERANCE)
+ #error J1939 Baud Rate error is over J1939_BAUD_TOLERANCE at this Clock Speed
+#elif (J1939_BIT_ACTUAL_BAUD_RATE < J1939_BAUD_RATE) && ((J1939_BAUD_RATE - J1939_BIT_ACTUAL_BAUD_RATE) * 100 > J1939_BAUD_RATE / 100 * J1939_BAUD_TOLERANCE)
+ #error J1939 Baud Rate error is over J1939_BAUD_TOLERANCE at this Clock Speed
+#endif
+
+#ifndef CAN_BRG_PRESCALAR
+ #define CAN_BRG_PRESCALAR         (J1939_BIT_PRESCALE - 1)
+ #define CAN_BRG_PHASE_SEGMENT_1   (J1939_BIT_PHASE_1 - 1)
+ #define CAN_BRG_PHASE_SEGMENT_2   (J1939_BIT_PHASE_2 - 1)
+ #define CAN_BRG_PROPAGATION_TIME  (J1939_BIT_PROPAGATION - 1)
+ #define CAN_BRG_SYNCH_JUMP_WIDTH  0
+#endif
+
+#if J1939_USE_AUTO_BAUD == TRUE
+ #if J1939_BIT_BAD_FOR(250000) || J1939_BIT_BAD_FOR(500000) || J1939_BIT_BAD_FOR(125000) || J1939_BIT_BAD_FOR(1000000)
+  #error "Clock Speed can't make every J1939_USE_AUTO_BAUD baud rate within J1939_BAUD_TOLERANCE"
+ #endif
+#endif
+
+//PIC18 BRGCON1, BRGCON2 and BRGCON3 for a baud rate, used for can_baud_table
+#define J1939_BRGCON1_FOR(baud)  ((CAN_BRG_SYNCH_JUMP_WIDTH << 6) | (J1939_BIT_PRESCALE_FOR(baud) - 1))
+#define J1939_BRGCON2_FOR(baud)  ((CAN_BRG_SEG_2_PHASE_TS ? 0x80 : 0) | (CAN_BRG_SAM ? 0x40 : 0) | ((J1939_BIT_PHASE_1_FOR(baud) - 1) << 3) | (J1939_BIT_PROPAGATION_FOR(baud) - 1))
+#define J1939_BRGCON3_FOR(baud)  (0x80 | (CAN_BRG_WAKE_FILTER ? 0x40 : 0) | (J1939_BIT_PHASE_2_FOR(baud) - 1))
+
+//////////////////////////////////////////////////////////////////////////////// Prototypes
+
+void J1939Init(void);
+#if USE_HOST_CAN != TRUE
+#separate
+#endif
+void J1939ReceiveTask(void);
+#if USE_HOST_CAN != TRUE
+#separate
+#endif
+void J1939XmitTask(void);
+int1 J1939Kbhit(void);
+int1 J1939GetMessage(J1939_PDU_STRUCT &PDU, uint8_t *Data, uint8_t &Length);
+int1 J1939PutMessage(J1939_PDU_STRUCT PDU, uint8_t *Data, uint8_t Bytes);
+void J1939RequestAddress(uint8_t address);
+void J1939SetClaimPolicy(J1939_TICK_TYPE ContentionTicks, uint8_t ImmediateClaim);
+void J1939ChangeAddress(uint8_t address);
+#if J1939_USE_AUTO_BAUD == TRUE
+int1 J1939AutoBaud(void);
+#endif
+#if J1939_USE_RX_TIMESTAMP == TRUE
+uint32_t J1939GetMicroseconds(void);
+void J1939StampReceiveBuffers(void);
+void J1939TakeTimestamp(uint8_t Buffer);
+#endif
+#if J1939_USE_PROFILER == TRUE
+void J1939ProfileReset(void);
+void J1939ProfileUpdate(uint8_t Probe, uint16_t Now);
+#endif
+#if J1939_USE_CHECKS == TRUE
+void J1939CheckBuffers(void);
+#endif
+#if J1939_USE_ERROR_SUPERVISOR == TRUE
+void J1939ErrorTask(void);
+#if J1939_USE_ERROR_INTERRUPT == TRUE
+void J1939ErrorISR(void);
+#endif
+#endif
+int1 J1939IsAddressClaimMessage(J1939_PDU_STRUCT PDU, uint8_t *Data, uint8_t Bytes);
+int1 J1939CheckImmediateClaim(uint8_t address);
+void J1939AddressClaimComplete(void);
+int1 J1939StageMessage(J1939_PDU_STRUCT PDU, uint8_t *Data, uint8_t Bytes);
+void J1939ReleaseStagedMessages(void);
+void J1939FlushStagedMessages(void);
+void J1939ClaimAddress(void);
+int1 J1939CheckName(uint8_t *data);
+int1 J1939CompareName(uint8_t *data);
+void J1939PackName(uint8_t *Name, J1939_NAME *Packed);
+void J1939UnpackName(J1939_NAME *Packed, uint8_t *Name);
+void J1939BuildName(J1939_NAME_FIELDS *Fields, uint8_t *Name);
+void J1939HandleAddressRequest(void);
+void J1939LoadReceiveBuffer(J1939_PDU_STRUCT ReceivedPDU,uint8_t *Data,uint8_t length);
+void J1939HandleAddressClaim(J1939_PDU_STRUCT ReceivedPDU, uint8_t *Name);
+void J1939SetCANFilter(uint8_t address);
+void J1939IDToPDU(uint32_t ID, J1939_PDU_STRUCT *PDU);
+uint32_t J1939PDUToID(J1939_PDU_STRUCT *PDU);
+#if J1939_USE_ID_REGISTERS == TRUE
+void J1939RegistersToPDU(uint8_t *Registers, J1939_PDU_STRUCT *PDU);
+void J1939PDUToRegisters(J1939_PDU_STRUCT *PDU, uint8_t *Registers);
+#endif
+#if J1939_USE_COMMANDED_ADDRESS == TRUE
+void J1939HandleCommandedAddress(J1939_PDU_STRUCT ReceivedPDU, uint8_t *Data, uint8_t length);
+#endif
+uint8_t xor8(void);
+void J1939SeedRandom(void);
+int1 J1939AddressInUse(uint8_t address);
+uint8_t J1939SelectAddress(uint8_t LostAddress);
+#if J1939_ADDRESS_MAP_ENTRIES > 0
+void J1939ClearAddressMap(void);
+void J1939UpdateAddressMap(uint8_t Address, uint8_t *Name);
+uint8_t J1939GetAddressOfName(uint8_t *Name);
+int1 J1939GetNameOfAddress(uint8_t Address, uint8_t *Name);
+uint8_t J1939GetAddressOfFunction(uint8_t Function);
+#endif
+
+#endif